@@ -3,18 +3,18 @@
 
 #include <ArduinoJson.h>
 
-#define ALTERNATE_WEBSOCKET
-#ifdef ALTERNATE_WEBSOCKET
-#include <WebSocketsClient.h>
-#else
-#include <ArduinoWebsockets.h>
-#endif
-
 #include "AutodartsDefines.h"
 #include "AutodartsDetector.h"
+#include "AutodartsCapture.h"
+#include "AutodartsQueue.h"
+#include "AutodartsProfile.h"
+#include "AutodartsHeapAudit.h"
+#include "AutodartsTransport.h"
 
 namespace autodarts {
 
+  typedef MessageQueueT<AUTODARTS_STATE_QUEUE_SIZE, AUTODARTS_NUM_CAMERAS> MessageQueue;
+
   class Board {
   public:
     Board() = delete;
@@ -25,7 +25,7 @@ namespace autodarts {
     };
 
     Board(const String& name, const String& id, const String& version, const String& url) : 
-      _name(name), _id(id), _version(version), _url(url), _detector(_name, _id) {
+      _name(name), _id(id), _url(url), _version(version), _detector(_name, _id) {
 
     };
 
@@ -34,7 +34,7 @@ namespace autodarts {
       _url = address.toString() + ':' + String(port);
     };
     
-    String getName() const {
+    const String& getName() const {
       return _name;
     }
 
@@ -42,7 +42,7 @@ namespace autodarts {
       _name = name;
     }
 
-    String getId() const {
+    const String& getId() const {
       return _id;
     }
 
@@ -50,7 +50,7 @@ namespace autodarts {
       _id = id;
     }
 
-    String getVersion() const {
+    const String& getVersion() const {
       return _version;
     }
 
@@ -58,7 +58,7 @@ namespace autodarts {
       _version = version;
     }
     
-    String getUrl() const {
+    const String& getUrl() const {
       return _url;
     }
     
@@ -70,67 +70,138 @@ namespace autodarts {
       return _isOpen;
     }
 
-#ifdef ALTERNATE_WEBSOCKET
-    bool open(bool force = false) {
-      // Check if already open
-      if (!force && isOpen()) {
-        return true;
+    void setOpen(bool open) {
+      _isOpen = open;
+      _onBoardConnectionCallback(_name, _id, _isOpen);
+      resetAlive();
+    }
+
+    // Dispatch a board event that arrived either on the local websocket
+    // or multiplexed through the cloud subscription
+    void receive(const JsonObjectConst& json) {
+      AUTODARTS_PROFILE(_profile, CALLBACK);
+#ifdef AUTODARTS_LOAD_TEST
+      checkSequence(json);
+#endif
+      _detector.fromJson(json);
+      _numMessages++;
+      resetAlive();
+    }
+
+    // Queue a raw payload, it is parsed once its priority class is
+    // dispatched. State messages are queued in order, telemetry is
+    // coalesced to the newest message per type and camera.
+    void receive(char* payload, size_t length) {
+#ifdef AUTODARTS_HEAP_AUDIT
+      HeapAudit audit;
+#endif
+      _capture.write(payload, length, millis());
+      inject(payload, length);
+#ifdef AUTODARTS_HEAP_AUDIT
+      checkHeap(audit, "Receive");
+#endif
+    }
+
+    // Handles a payload like a received one without capturing it, used to
+    // replay a capture while another one is recorded
+    void inject(char* payload, size_t length) {
+#ifdef AUTODARTS_HEAP_AUDIT
+      HeapAudit audit;
+#endif
+      {
+        AUTODARTS_PROFILE(_profile, CALLBACK);
+        _onBoardMessageCallback(_name, _id, payload, length);
+      }
+      _numBytes += length;
+      if (!_queue.push(payload, length)) {
+        // State ring is full: dispatch the oldest state message now rather
+        // than losing it, then queue the new one
+        dispatch(Priority::STATE, 1);
+        _queue.push(payload, length);
       }
+#ifdef AUTODARTS_HEAP_AUDIT
+      checkHeap(audit, "Receive");
+#endif
+    }
 
-      // Check if url is valid
-      if (_url.isEmpty()) {
-        return false;
+    // Parses and dispatches up to max queued messages of a priority class
+    uint8_t dispatch(Priority priority, uint8_t max = UINT8_MAX) {
+#ifdef AUTODARTS_HEAP_AUDIT
+      HeapAudit audit;
+#endif
+      uint8_t count = 0;
+      while (count < max && _queue.pop(priority, [this](char* payload, size_t length) { parse(payload, length); })) {
+        count++;
       }
+#ifdef AUTODARTS_HEAP_AUDIT
+      checkHeap(audit, "Dispatch");
+#endif
+      return count;
+    }
 
-      // Split url
-      int index = _url.indexOf(':');
-      String address = _url.substring(0, index);
-      int port = _url.substring(index+1).toInt();
+    // Dispatches all state messages before any telemetry
+    void dispatch() {
+      dispatch(Priority::STATE);
+      dispatch(Priority::TELEMETRY);
+    }
 
-      // Open websocket
-      LOG_DEBUG(_name.c_str(), F("Opening connection"));
-      _websocket.begin(address, port, "/api/events");
+    uint32_t getNumCoalesced() const {
+      return _queue.getStats().coalesced;
+    }
 
-      // Register event callback
-      _websocket.onEvent([this](WStype_t type, uint8_t * payload, size_t length) {
-        switch(type) {
-          case WStype_CONNECTED: {
-            _isOpen = true;
-            _onBoardConnectionCallback(_name, _id, _isOpen);
-            break;
-          }
-          case WStype_DISCONNECTED: {
-            _isOpen = false;
-            _onBoardConnectionCallback(_name, _id, _isOpen);
-            break;
-          }
-          case WStype_TEXT: {
-            LOG_DEBUG(_name.c_str(), F("Received data"));
-            DynamicJsonDocument json(2048);
-            deserializeJson(json, payload);
-            _detector.fromJson(json.as<JsonObjectConst>());
-            break;
-          }
-          case WStype_BIN:
-          case WStype_ERROR:		
-          case WStype_FRAGMENT_TEXT_START:
-          case WStype_FRAGMENT_BIN_START:
-          case WStype_FRAGMENT:
-          case WStype_FRAGMENT_FIN:
-            break;
-        }
-        resetAlive();
-      });
+    uint32_t getNumOverflows() const {
+      return _queue.getStats().overflows;
+    }
 
-      // try ever 5000 again if connection has failed
-      _websocket.setReconnectInterval(5000);
+#ifdef AUTODARTS_HEAP_AUDIT
+    // Receives and dispatches that allocated, from the message callback
+    // and capture to the detector callbacks, see HeapAudit for what is
+    // detected
+    uint32_t getNumHeapAllocations() const {
+      return _numHeapAllocations;
+    }
+#endif
+
+#ifdef AUTODARTS_PROFILING
+    const Profile& getProfile() const {
+      return _profile;
+    }
 
-      return true;
+    Profile& getProfile() {
+      return _profile;
     }
-#else
+#endif
+
+    bool startCapture(fs::FS& fs, const char* path) {
+      LOG_INFO(_name.c_str(), F("Capturing to ") << path);
+      return _capture.begin(fs, path);
+    }
+
+    void stopCapture() {
+      _capture.end();
+    }
+
+    uint32_t getNumMessages() const {
+      return _numMessages;
+    }
+
+    uint32_t getNumBytes() const {
+      return _numBytes;
+    }
+
+#ifdef AUTODARTS_LOAD_TEST
+    uint32_t getNumDropped() const {
+      return _numDropped;
+    }
+
+    uint32_t getNumLate() const {
+      return _numLate;
+    }
+#endif
+
     bool open(bool force = false) {
-      // Check if already open
-      if (!force && isOpen()) {
+      // Check if already open or connecting, the transport reconnects by itself
+      if (!force && _isStarted) {
         return true;
       }
 
@@ -139,69 +210,98 @@ namespace autodarts {
         return false;
       }
 
-      // Register message callback
-      _websocket.onMessage([this](websockets::WebsocketsMessage message) {
-        LOG_DEBUG(_name.c_str(), F("Received data"));
-        DynamicJsonDocument json(2048);
-        deserializeJson(json, message.data());
-        _detector.fromJson(json.as<JsonObjectConst>());
-        resetAlive();
-      });
+      // Split url
+      int index = _url.indexOf(':');
+      String address = index < 0 ? _url : _url.substring(0, index);
+      uint16_t port = index < 0 ? 3180 : _url.substring(index+1).toInt();
 
       // Register event callback
-      _websocket.onEvent([this](websockets::WebsocketsEvent event, String data) {
-        if(event == websockets::WebsocketsEvent::ConnectionOpened) {
+      _transport->onEvent([this](Transport::Type type, char* payload, size_t length) {
+        switch(type) {
+          case Transport::Type::CONNECTED: {
             LOG_DEBUG(_name.c_str(), F("Connection opened"));
-            _isOpen = true;
-            _onConnectionCallback(_name, _id, _isOpen);
-        } else if(event == websockets::WebsocketsEvent::ConnectionClosed) {
+            setOpen(true);
+            break;
+          }
+          case Transport::Type::DISCONNECTED: {
             LOG_DEBUG(_name.c_str(), F("Connection closed"));
-            _isOpen = false;
-            _onConnectionCallback(_name, _id, _isOpen);
+            setOpen(false);
+            break;
+          }
+          case Transport::Type::TEXT: {
+            LOG_DEBUG(_name.c_str(), F("Received data"));
+            receive(payload, length);
+            break;
+          }
         }
         resetAlive();
       });
 
-      // Open websocket
+      // Open websocket, retry after the reconnect interval if connection has failed
       LOG_DEBUG(_name.c_str(), F("Opening connection"));
-      char websocketUrl[48];
-      sprintf(websocketUrl, AUTODARTS_WS_LOCAL_URL, _url.c_str());
-      return _websocket.connect(websocketUrl);
+      _transport->setReconnectInterval(_reconnectInterval);
+      _isStarted = _transport->open(address, port, "/api/events");
+      return _isStarted;
     }
-#endif
-
-
 
     void close() {
-      
-    LOG_DEBUG(_name.c_str(), F("Closing connection"));
-#ifdef ALTERNATE_WEBSOCKET
-      _websocket.disconnect();
-#else
-      _websocket.close();
-#endif
+      LOG_DEBUG(_name.c_str(), F("Closing connection"));
+      _transport->close();
       _isOpen = false;
+      _isStarted = false;
     }
 
-    bool update() {
-#ifdef ALTERNATE_WEBSOCKET
-      _websocket.loop();
-#else
-      if(_websocket.available() && _websocket.poll()) {
-        return true;
+    // Polls the transport, queued messages are dispatched right away unless
+    // the caller dispatches priority classes across boards itself
+    bool update(bool dispatchAll = true) {
+      bool received;
+      {
+        AUTODARTS_PROFILE(_profile, IO);
+        received = _transport->poll();
+      }
+      if (dispatchAll) {
+        dispatch();
       }
-#endif
 
       if (isOpen() && !isAlive()) {
         LOG_ERROR(_name.c_str(), F("Connection timeout!"));
         close();
       }
 
-      return false;
+      return received;
+    }
+
+    // Replaces the websocket transport, e.g. by a loopback for benchmarks.
+    // The old transport is closed even while it is still connecting, the
+    // next open() then opens the new one.
+    void setTransport(std::unique_ptr<Transport> transport) {
+      close();
+      _transport = std::move(transport);
+    }
+
+    Transport& getTransport() {
+      return *_transport;
     }
 
     bool isAlive() const {
-      return (millis() - _lastAlive) < 10000;
+      return (millis() - _lastAlive) < _aliveTimeout;
+    }
+
+    // Applied on the next open()
+    void setReconnectInterval(uint16_t interval) {
+      _reconnectInterval = interval;
+    }
+
+    uint16_t getReconnectInterval() const {
+      return _reconnectInterval;
+    }
+
+    void setAliveTimeout(uint32_t timeout) {
+      _aliveTimeout = timeout;
+    }
+
+    uint32_t getAliveTimeout() const {
+      return _aliveTimeout;
     }
 
     void resetAlive() {
@@ -226,6 +326,10 @@ namespace autodarts {
       _onBoardConnectionCallback = callback;
     }
 
+    void onBoardMessage(BoardMessageCallback callback) {
+      _onBoardMessageCallback = callback;
+    }
+
     void onCameraStats(CameraStatsCallback callback) {
       _onCameraStatsCallback = callback;
       _detector.onCameraStats(_onCameraStatsCallback);
@@ -251,28 +355,114 @@ namespace autodarts {
       _detector.onDetectionEvent(_onDetectionEventCallback);
     }
 
+    void onThrow(ThrowCallback callback) {
+      _onThrowCallback = callback;
+      _detector.onThrow(_onThrowCallback);
+    }
+
+    const Detector& getDetector() const {
+      return _detector;
+    }
+
+    Detector& getDetector() {
+      return _detector;
+    }
+
   private:
+#ifdef AUTODARTS_LOAD_TEST
+    // Messages of the load generator carry a sequence number and the sender
+    // time. Latency is relative to the smallest clock offset seen so far.
+    void checkSequence(const JsonObjectConst& json) {
+      if (!json.containsKey("seq")) {
+        return;
+      }
+      uint32_t seq = json["seq"];
+      if (seq < _lastSeq) {
+        // Generator restarted the stream after a scripted disconnect
+        _lastSeq = seq;
+      }
+      else if (_numMessages > 0 && seq > _lastSeq + 1) {
+        _numDropped += seq - _lastSeq - 1;
+      }
+      _lastSeq = seq;
+
+      int32_t offset = millis() - json["ts"].as<uint32_t>();
+      if (_numMessages == 0 || offset < _minOffset) {
+        _minOffset = offset;
+      }
+      if (offset - _minOffset > AUTODARTS_LOAD_TEST_LATE_MS) {
+        _numLate++;
+      }
+    }
+
+    uint32_t _lastSeq = 0;
+    uint32_t _numDropped = 0;
+    uint32_t _numLate = 0;
+    int32_t  _minOffset = 0;
+#endif
+
+    // Parses the payload in place, so strings of the document reference the
+    // payload buffer and are only valid while the message is dispatched
+    void parse(char* payload, size_t length) {
+      DeserializationError err;
+      {
+        AUTODARTS_PROFILE(_profile, PARSE);
+        err = deserializeJson(_json, payload, length);
+      }
+      if (err) {
+        LOG_ERROR(_name.c_str(), F("Could not deserialize message: ") << err.c_str());
+        return;
+      }
+      receive(_json.as<JsonObjectConst>());
+    }
+
+#ifdef AUTODARTS_HEAP_AUDIT
+    // Steady state receive and dispatch must not allocate, churn fragments
+    // the heap. Nested audits end with 0 and are not counted twice.
+    void checkHeap(HeapAudit& audit, const char* stage) {
+      uint32_t allocated = audit.end();
+      if (allocated) {
+        _numHeapAllocations++;
+        LOG_WARNING(_name.c_str(), stage << F(" allocated ") << allocated << (audit.isTraced() ? F(" blocks") : F(" bytes")));
+      }
+    }
+#endif
+
     String _name = "";
     String _id = "";
     String _url = "";
     String _version = "";
     bool _isOpen = false;
+    bool _isStarted = false;
     uint64_t _lastAlive = 0;
+    uint16_t _reconnectInterval = 5000;
+    uint32_t _aliveTimeout = 10000;
+    uint32_t _numMessages = 0;
+    uint32_t _numBytes = 0;
+#ifdef AUTODARTS_HEAP_AUDIT
+    uint32_t _numHeapAllocations = 0;
+#endif
+#ifdef AUTODARTS_PROFILING
+    Profile _profile;
+#endif
     Detector _detector;
+    DynamicJsonDocument _json{2048};
+    CaptureWriter _capture;
+    MessageQueue _queue;
 
-#ifdef ALTERNATE_WEBSOCKET
-    WebSocketsClient _websocket;
-#else
-    websockets::WebsocketsClient _websocket;
-#endif
+    std::unique_ptr<Transport> _transport{new DefaultTransport};
 
     BoardConnectionCallback   _onBoardConnectionCallback   = [](const String&, const String&, bool){};
+    BoardMessageCallback      _onBoardMessageCallback      = [](const String&, const String&, const char*, size_t){};
     CameraStatsCallback       _onCameraStatsCallback       = [](const String&, const String&, int8_t, int8_t, int16_t, int16_t){};
     CameraSystemStateCallback _onCameraSystemStateCallback = [](const String&, const String&, State, State){};
     DetectionStatsCallback    _onDetectionStatsCallback    = [](const String&, const String&, int8_t, int16_t, int16_t){};
     DetectionStateCallback    _onDetectionStateCallback    = [](const String&, const String&, State, State,  int16_t){};
     DetectionEventCallback    _onDetectionEventCallback    = [](const String&, const String&, Status::Code, Event::Code){};
+    ThrowCallback             _onThrowCallback             = [](const String&, const String&, const Throw&, int16_t){};
   };
+
+  typedef CaptureReplay<Board> BoardReplay;
 } // autodarts
 
 
@@ -6,23 +6,28 @@
 #include "AutodartsDefines.h"
 
 namespace autodarts {
+  // Read-only view of the last stats received from a camera
   class Camera {
   public:
     Camera() = delete;
 
-    Camera(const String& boardName, const String& boardId) :
-      _boardName(boardName), _boardId(boardId) {
+    Camera(const String& boardName, const String& boardId, int8_t id = -1, int8_t fps = -1, int16_t width = -1, int16_t height = -1) :
+      _boardName(boardName), _boardId(boardId), _id(id), _fps(fps), _width(width), _height(height) {
 
     }
 
-    String getBoardId() const {
+    const String& getBoardId() const {
       return _boardId;
     }
 
-    String getBoardName() const {
+    const String& getBoardName() const {
       return _boardName;
     }
 
+    bool isValid() const {
+      return _id >= 0;
+    }
+
     int8_t getId() const {
       return _id;
     }
@@ -39,20 +44,6 @@ namespace autodarts {
       return _height;
     }
 
-    void fromJson(const JsonObjectConst& root) {
-      if (root["type"] == "cam_stats") {
-        _id     = root["data"]["id"];
-        _fps    = root["data"]["fps"];
-        _width  = root["data"]["resolution"]["width"];
-        _height = root["data"]["resolution"]["height"];
-        _onCameraStatsCallback(_boardName, _boardId, _id, _fps, _width, _height);
-      }
-      else {
-        LOG_WARNING("CameraSystem", F("Unknown message type:"));
-        serializeJsonPretty(root, Serial);
-      }
-    }
-
     void toJson(JsonObject& root) const {
       JsonObject data = root.createNestedObject("data");
       data["id"] = _id;
@@ -62,36 +53,38 @@ namespace autodarts {
       root["type"] = "cam_stats";
     }
 
-    void onCameraStats(CameraStatsCallback callback) {
-      _onCameraStatsCallback = callback;
-    }
-
   private:
     const String& _boardName, _boardId;
 
-    int8_t  _id = -1;
-    int8_t  _fps = -1;
-    int16_t _width = -1;
-    int16_t _height = -1;
-
-    CameraStatsCallback _onCameraStatsCallback = [](const String&, const String&, int8_t, int8_t, int16_t, int16_t){};
+    int8_t  _id;
+    int8_t  _fps;
+    int16_t _width;
+    int16_t _height;
   };
 
 
-  class CameraSystem {
-  public:
-    CameraSystem() = delete;
+  // Camera stats are stored as arrays indexed by camera id
+  template<uint8_t NumCameras>
+  class CameraSystemT {
+    static_assert(NumCameras >= 1 && NumCameras <= 8, "Camera system supports 1 to 8 cameras");
 
-    CameraSystem(const String& boardName, const String& boardId) :
-      _boardName(boardName), _boardId(boardId), _cameras({Camera(boardName, boardId), Camera(boardName, boardId), Camera(boardName, boardId)}) {
+  public:
+    CameraSystemT() = delete;
 
+    CameraSystemT(const String& boardName, const String& boardId) :
+      _boardName(boardName), _boardId(boardId) {
+      for (uint8_t idx = 0; idx < NumCameras; idx++) {
+        _fps[idx]    = -1;
+        _width[idx]  = -1;
+        _height[idx] = -1;
+      }
     }
 
-    String getBoardId() const {
+    const String& getBoardId() const {
       return _boardId;
     }
 
-    String getBoardName() const {
+    const String& getBoardName() const {
       return _boardName;
     }
 
@@ -103,25 +96,24 @@ namespace autodarts {
       return _isRunning;
     }
 
-    uint8_t getNumCameras() const {
-      return _cameras.size();
+    static constexpr uint8_t getNumCameras() {
+      return NumCameras;
     }
 
-    Camera* getCameraById(int8_t id) {
-      for (auto it = _cameras.begin(); it < _cameras.end(); it++) {
-        if (it->getId() == id) {
-          return it;
-        }
-      }
-      return nullptr;
+    // Cameras are valid once their first cam_stats arrived
+    bool hasCamera(int8_t id) const {
+      return id >= 0 && id < NumCameras && (_valid & (1 << id));
     }
 
-    Camera& operator [](uint8_t idx) {
-      return _cameras[idx];
+    Camera getCameraById(int8_t id) const {
+      if (!hasCamera(id)) {
+        return Camera(_boardName, _boardId);
+      }
+      return Camera(_boardName, _boardId, id, _fps[id], _width[id], _height[id]);
     }
 
-    const Camera& operator [](uint8_t idx) const {
-      return _cameras[idx];
+    Camera operator [](uint8_t idx) const {
+      return getCameraById(idx);
     }
 
     void fromJson(const JsonObjectConst& root) {
@@ -136,9 +128,18 @@ namespace autodarts {
         _onCameraSystemStateCallback(_boardName, _boardId, opened, running);
       }
       else if (root["type"] == "cam_stats") {
-        int8_t id = root["data"]["id"];
-        if (id >= 0 && id < _cameras.size()) {
-          _cameras[id].fromJson(root);
+        // Checked as int, so ids beyond int8_t do not wrap into range
+        JsonObjectConst data = root["data"];
+        int id = data["id"] | -1;
+        if (id >= 0 && id < NumCameras) {
+          _fps[id]    = data["fps"];
+          _width[id]  = data["resolution"]["width"];
+          _height[id] = data["resolution"]["height"];
+          _valid |= (1 << id);
+          _onCameraStatsCallback(_boardName, _boardId, id, _fps[id], _width[id], _height[id]);
+        }
+        else {
+          LOG_WARNING("CameraSystem", F("Camera id out of range: ") << id);
         }
       }
       else {
@@ -156,9 +157,6 @@ namespace autodarts {
 
     void onCameraStats(CameraStatsCallback callback) {
       _onCameraStatsCallback = callback;
-      for (Camera& camera : _cameras) {
-          camera.onCameraStats(_onCameraStatsCallback);
-      }
     }
 
     void onCameraSystemState(CameraSystemStateCallback callback) {
@@ -166,10 +164,13 @@ namespace autodarts {
     }
 
   private:
-    std::array<Camera, 3> _cameras;
-
     const String& _boardName, _boardId;
 
+    int8_t  _fps[NumCameras];
+    int16_t _width[NumCameras];
+    int16_t _height[NumCameras];
+    uint8_t _valid = 0;
+
     bool   _isOpened = false;
     bool   _isRunning = false;
     bool   _wasOpened = false;
@@ -179,6 +180,8 @@ namespace autodarts {
     CameraSystemStateCallback _onCameraSystemStateCallback = [](const String&, const String&, State, State){};
   };
 
+  typedef CameraSystemT<AUTODARTS_NUM_CAMERAS> CameraSystem;
+
 } // autodarts
 
 
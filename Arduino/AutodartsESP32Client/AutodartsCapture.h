@@ -0,0 +1,183 @@
+#ifndef AutodartsCapture_h_
+#define AutodartsCapture_h_
+
+#include <FS.h>
+#include <vector>
+
+#include "AutodartsDefines.h"
+
+namespace autodarts {
+
+  // Binary capture format:
+  //   header: "ADC" + version byte
+  //   frame:  varint delta millis, varint length, payload bytes
+  static const uint8_t AUTODARTS_CAPTURE_MAGIC[]  = {'A', 'D', 'C'};
+  static const uint8_t AUTODARTS_CAPTURE_VERSION  = 1;
+
+  class CaptureWriter {
+  public:
+    bool begin(fs::FS& fs, const char* path) {
+      end();
+      _file = fs.open(path, FILE_WRITE);
+      if (!_file) {
+        LOG_ERROR("CaptureWriter", F("Could not open capture file: ") << path);
+        return false;
+      }
+      _file.write(AUTODARTS_CAPTURE_MAGIC, sizeof(AUTODARTS_CAPTURE_MAGIC));
+      _file.write(AUTODARTS_CAPTURE_VERSION);
+      _lastTimestamp = millis();
+      _numFrames = 0;
+      return true;
+    }
+
+    void end() {
+      if (_file) {
+        LOG_INFO("CaptureWriter", F("Captured ") << _numFrames << F(" frames"));
+        _file.close();
+      }
+    }
+
+    bool isOpen() {
+      return _file;
+    }
+
+    void write(const char* payload, size_t length, uint32_t timestamp) {
+      if (!_file) {
+        return;
+      }
+      writeVarint(timestamp - _lastTimestamp);
+      writeVarint(length);
+      _file.write(reinterpret_cast<const uint8_t*>(payload), length);
+      _lastTimestamp = timestamp;
+      _numFrames++;
+    }
+
+    uint32_t getNumFrames() const {
+      return _numFrames;
+    }
+
+  private:
+    void writeVarint(uint32_t value) {
+      uint8_t buffer[5];
+      uint8_t size = 0;
+      do {
+        buffer[size] = value & 0x7f;
+        value >>= 7;
+        if (value) {
+          buffer[size] |= 0x80;
+        }
+        size++;
+      } while (value);
+      _file.write(buffer, size);
+    }
+
+    fs::File _file;
+    uint32_t _lastTimestamp = 0;
+    uint32_t _numFrames = 0;
+  };
+
+
+  // Feeds a capture back into a board, either at the recorded pace or as
+  // fast as possible
+  template<typename TBoard>
+  class CaptureReplay {
+  public:
+    bool begin(fs::FS& fs, const char* path, bool realtime = true) {
+      _file = fs.open(path, FILE_READ);
+      if (!_file) {
+        LOG_ERROR("CaptureReplay", F("Could not open capture file: ") << path);
+        return false;
+      }
+
+      uint8_t header[sizeof(AUTODARTS_CAPTURE_MAGIC) + 1];
+      if (_file.read(header, sizeof(header)) != sizeof(header) ||
+          memcmp(header, AUTODARTS_CAPTURE_MAGIC, sizeof(AUTODARTS_CAPTURE_MAGIC)) != 0 ||
+          header[sizeof(AUTODARTS_CAPTURE_MAGIC)] != AUTODARTS_CAPTURE_VERSION) {
+        LOG_ERROR("CaptureReplay", F("Invalid capture file: ") << path);
+        _file.close();
+        return false;
+      }
+
+      _realtime = realtime;
+      _startMillis = millis();
+      _captureMillis = 0;
+      _numFrames = 0;
+      _numBytes = 0;
+      _hasFrame = readFrame();
+      return true;
+    }
+
+    // Replays all frames that are due, returns false when the capture is
+    // exhausted. Frames are injected, so a capture running on the board
+    // does not record them again.
+    bool update(TBoard& board) {
+      while (_hasFrame && (!_realtime || (millis() - _startMillis) >= _captureMillis)) {
+        board.inject(_payload.data(), _length);
+        board.dispatch();
+        _hasFrame = readFrame();
+      }
+      if (!_hasFrame && _file) {
+        LOG_INFO("CaptureReplay", F("Replayed ") << _numFrames << F(" frames, ") << _numBytes << F(" bytes in ") << (millis() - _startMillis) << F("ms"));
+        _file.close();
+      }
+      return _hasFrame;
+    }
+
+    uint32_t getNumFrames() const {
+      return _numFrames;
+    }
+
+    uint32_t getNumBytes() const {
+      return _numBytes;
+    }
+
+  private:
+    bool readVarint(uint32_t& value) {
+      value = 0;
+      for (uint8_t shift = 0; shift < 35; shift += 7) {
+        int c = _file.read();
+        if (c < 0) {
+          return false;
+        }
+        value |= static_cast<uint32_t>(c & 0x7f) << shift;
+        if (!(c & 0x80)) {
+          return true;
+        }
+      }
+      return false;
+    }
+
+    bool readFrame() {
+      uint32_t delta;
+      if (!readVarint(delta) || !readVarint(_length)) {
+        return false;
+      }
+      // Keep room for a terminator, payload buffer is reused between frames
+      if (_payload.size() < _length + 1) {
+        _payload.resize(_length + 1);
+      }
+      if (_file.read(reinterpret_cast<uint8_t*>(_payload.data()), _length) != _length) {
+        LOG_ERROR("CaptureReplay", F("Truncated frame"));
+        return false;
+      }
+      _payload[_length] = '\0';
+      _captureMillis += delta;
+      _numFrames++;
+      _numBytes += _length;
+      return true;
+    }
+
+    fs::File _file;
+    std::vector<char> _payload;
+    uint32_t _length = 0;
+    uint32_t _startMillis = 0;
+    uint32_t _captureMillis = 0;
+    uint32_t _numFrames = 0;
+    uint32_t _numBytes = 0;
+    bool _realtime = true;
+    bool _hasFrame = false;
+  };
+
+} // autodarts
+
+#endif // AutodartsCapture_h_
@@ -0,0 +1,182 @@
+#ifndef AutodartsCheckout_h_
+#define AutodartsCheckout_h_
+
+#include <stdint.h>
+#include <stdio.h>
+
+namespace autodarts {
+
+  // Double-out checkout suggestions for remaining scores 2..170. The tables
+  // are generated at compile time, so they live in flash and a lookup is a
+  // single array access. Each entry packs up to three darts into one byte
+  // each, (multiplier << 5) | number, with the finishing double last.
+  namespace checkout {
+
+    constexpr uint8_t dart(uint8_t multiplier, uint8_t number) {
+      return (multiplier << 5) | number;
+    }
+
+    constexpr uint8_t numberOf(uint8_t dart) {
+      return dart & 0x1f;
+    }
+
+    constexpr uint8_t multiplierOf(uint8_t dart) {
+      return dart >> 5;
+    }
+
+    constexpr int16_t valueOf(uint8_t dart) {
+      return numberOf(dart) * multiplierOf(dart);
+    }
+
+    // Dart scoring exactly the given value, singles preferred over trebles over doubles
+    constexpr uint8_t single(int16_t value) {
+      return (value >= 1 && value <= 20)           ? dart(1, value)
+           : (value == 25)                         ? dart(1, 25)
+           : (value == 50)                         ? dart(2, 25)
+           : (value <= 60 && value % 3 == 0 && value > 0) ? dart(3, value / 3)
+           : (value <= 40 && value % 2 == 0 && value > 0) ? dart(2, value / 2)
+           : 0;
+    }
+
+    // Doubles in order of preference after the configured favourite
+    constexpr uint8_t DOUBLE_ORDER_SIZE = 21;
+    constexpr uint8_t doubleOrder(uint8_t idx) {
+      return idx ==  0 ? 20 : idx ==  1 ? 16 : idx ==  2 ?  8 : idx ==  3 ? 18 : idx ==  4 ? 12
+           : idx ==  5 ? 10 : idx ==  6 ?  4 : idx ==  7 ?  2 : idx ==  8 ?  1 : idx ==  9 ? 14
+           : idx == 10 ?  6 : idx == 11 ? 13 : idx == 12 ? 19 : idx == 13 ? 17 : idx == 14 ? 15
+           : idx == 15 ? 11 : idx == 16 ?  9 : idx == 17 ?  7 : idx == 18 ?  5 : idx == 19 ?  3
+           : 25;
+    }
+
+    constexpr uint8_t rankedDouble(uint8_t rank, uint8_t preferred) {
+      return rank == 0 ? dart(2, preferred) : dart(2, doubleOrder(rank - 1));
+    }
+
+    // Setup darts in descending value: trebles, bull, outer bull, singles
+    constexpr uint8_t SETUP_ORDER_SIZE = 42;
+    constexpr uint8_t setupDart(uint8_t idx) {
+      return idx < 20  ? dart(3, 20 - idx)
+           : idx == 20 ? dart(2, 25)
+           : idx == 21 ? dart(1, 25)
+           : dart(1, 20 - (idx - 22));
+    }
+
+    constexpr uint32_t pack(uint8_t first, uint8_t second = 0, uint8_t third = 0) {
+      return first | (static_cast<uint32_t>(second) << 8) | (static_cast<uint32_t>(third) << 16);
+    }
+
+    constexpr uint32_t oneDart(int16_t remaining) {
+      return remaining == 50                                           ? pack(dart(2, 25))
+           : (remaining >= 2 && remaining <= 40 && remaining % 2 == 0) ? pack(dart(2, remaining / 2))
+           : 0;
+    }
+
+    constexpr uint32_t twoDartsWith(int16_t rest, uint8_t finish) {
+      return (rest > 0 && single(rest)) ? pack(single(rest), finish) : 0;
+    }
+
+    constexpr uint32_t twoDarts(int16_t remaining, uint8_t preferred, uint8_t rank = 0) {
+      return rank > DOUBLE_ORDER_SIZE ? 0
+           : twoDartsWith(remaining - valueOf(rankedDouble(rank, preferred)), rankedDouble(rank, preferred))
+             ? twoDartsWith(remaining - valueOf(rankedDouble(rank, preferred)), rankedDouble(rank, preferred))
+             : twoDarts(remaining, preferred, rank + 1);
+    }
+
+    constexpr uint32_t setupWith(int16_t rest, uint8_t setup, uint8_t finish) {
+      return (rest > 0 && single(rest)) ? pack(setup, single(rest), finish) : 0;
+    }
+
+    constexpr uint32_t setup(int16_t remaining, uint8_t finish, uint8_t idx = 0) {
+      return idx >= SETUP_ORDER_SIZE ? 0
+           : setupWith(remaining - valueOf(setupDart(idx)), setupDart(idx), finish)
+             ? setupWith(remaining - valueOf(setupDart(idx)), setupDart(idx), finish)
+             : setup(remaining, finish, idx + 1);
+    }
+
+    constexpr uint32_t threeDarts(int16_t remaining, uint8_t preferred, uint8_t rank = 0) {
+      return rank > DOUBLE_ORDER_SIZE ? 0
+           : setup(remaining - valueOf(rankedDouble(rank, preferred)), rankedDouble(rank, preferred))
+             ? setup(remaining - valueOf(rankedDouble(rank, preferred)), rankedDouble(rank, preferred))
+             : threeDarts(remaining, preferred, rank + 1);
+    }
+
+    // Fewest darts first, then the most preferred double
+    constexpr uint32_t entry(int16_t remaining, uint8_t preferred) {
+      return remaining < 2 || remaining > 170 ? 0
+           : oneDart(remaining)                ? oneDart(remaining)
+           : twoDarts(remaining, preferred)    ? twoDarts(remaining, preferred)
+           : threeDarts(remaining, preferred);
+    }
+
+    template<uint16_t... Is> struct Sequence {};
+    template<uint16_t N, uint16_t... Is> struct MakeSequence : MakeSequence<N - 1, N - 1, Is...> {};
+    template<uint16_t... Is> struct MakeSequence<0, Is...> { typedef Sequence<Is...> type; };
+
+    template<uint8_t Preferred, typename S = typename MakeSequence<171>::type> struct Table;
+    template<uint8_t Preferred, uint16_t... Is>
+    struct Table<Preferred, Sequence<Is...>> {
+      static constexpr uint32_t entries[sizeof...(Is)] = { entry(Is, Preferred)... };
+    };
+    template<uint8_t Preferred, uint16_t... Is>
+    constexpr uint32_t Table<Preferred, Sequence<Is...>>::entries[sizeof...(Is)];
+
+  } // checkout
+
+
+  // Checkout lookup with a preferred finishing double (1-20, or 25 for bull)
+  template<uint8_t PreferredDouble = 20>
+  class CheckoutT {
+    static_assert((PreferredDouble >= 1 && PreferredDouble <= 20) || PreferredDouble == 25, "Preferred double must be 1-20 or 25");
+
+  public:
+    // Returns 0 if there is no finish with the given number of darts
+    static uint32_t lookup(int16_t remaining, uint8_t dartsLeft = 3) {
+      if (remaining < 0 || remaining > 170) {
+        return 0;
+      }
+      uint32_t entry = checkout::Table<PreferredDouble>::entries[remaining];
+      return getNumDarts(entry) <= dartsLeft ? entry : 0;
+    }
+
+    static uint8_t getNumDarts(uint32_t entry) {
+      return (entry & 0xff ? 1 : 0) + (entry & 0xff00 ? 1 : 0) + (entry & 0xff0000 ? 1 : 0);
+    }
+
+    // Dart at the given position, the finishing double is the last one
+    static uint8_t getDart(uint32_t entry, uint8_t idx) {
+      return (entry >> (8 * idx)) & 0xff;
+    }
+
+    static uint8_t getNumber(uint8_t dart) {
+      return checkout::numberOf(dart);
+    }
+
+    static uint8_t getMultiplier(uint8_t dart) {
+      return checkout::multiplierOf(dart);
+    }
+
+    // Formats an entry as e.g. "T20 T20 BULL", returns the number of characters written
+    static size_t format(uint32_t entry, char* buffer, size_t size) {
+      size_t length = 0;
+      buffer[0] = '\0';
+      for (uint8_t idx = 0; idx < getNumDarts(entry) && length < size; idx++) {
+        uint8_t dart = getDart(entry, idx);
+        const char* separator = idx ? " " : "";
+        int written;
+        if (getNumber(dart) == 25) {
+          written = snprintf(buffer + length, size - length, "%s%s", separator, getMultiplier(dart) == 2 ? "BULL" : "25");
+        }
+        else {
+          written = snprintf(buffer + length, size - length, "%s%c%u", separator, "SDT"[getMultiplier(dart) - 1], getNumber(dart));
+        }
+        length += written > 0 ? written : 0;
+      }
+      return length < size ? length : size - 1;
+    }
+  };
+
+  typedef CheckoutT<> Checkout;
+
+} // autodarts
+
+#endif // AutodartsCheckout_h_
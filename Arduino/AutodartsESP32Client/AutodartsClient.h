@@ -4,12 +4,18 @@
 #define AutodartsClient_h_
 
 #include <StreamUtils.h>
+#include <WiFi.h>
 
 #include <ArduinoJson.h>
 #include <ArduinoWebsockets.h>
 
 #include "AutodartsDefines.h"
 #include "AutodartsBoard.h"
+#include "AutodartsGzip.h"
+#include "AutodartsMatch.h"
+#include "AutodartsJournal.h"
+#include "AutodartsDiscovery.h"
+#include "AutodartsRawJson.h"
 
 namespace autodarts {
 
@@ -19,53 +25,126 @@ namespace autodarts {
     typedef std::pair<String, uint64_t> Token;
     typedef std::unique_ptr<Board> BoardPtr;
     typedef std::vector<BoardPtr> BoardArray;
+    typedef std::unique_ptr<Match> MatchPtr;
 
-    void addBoard(const JsonObjectConst& json)  {
+    bool addBoard(const JsonObjectConst& json)  {
       BoardPtr board(new Board(json));
-      board->onBoardConnection(_onBoardConnectionCallback);
-      board->onCameraStats(_onCameraStatsCallback);
-      board->onCameraSystemState(_onCameraSystemStateCallback);
-      board->onDetectionStats(_onDetectionStatsCallback);
-      board->onDetectionState(_onDetectionStateCallback);
-      board->onDetectionEvent(_onDetectionEventCallback);
-      _boards.push_back(std::move(board));
+      return addBoard(board);
     };
 
-    void addBoard(const String& name, const String& id, const String& version, const String& url) {
+    bool addBoard(const String& name, const String& id, const String& version, const String& url) {
       BoardPtr board(new Board(name, id, version, url));
-      board->onBoardConnection(_onBoardConnectionCallback);
-      board->onCameraStats(_onCameraStatsCallback);
-      board->onCameraSystemState(_onCameraSystemStateCallback);
-      board->onDetectionStats(_onDetectionStatsCallback);
-      board->onDetectionState(_onDetectionStateCallback);
-      board->onDetectionEvent(_onDetectionEventCallback);
-      _boards.push_back(std::move(board));
+      return addBoard(board);
     };
 
-    void addBoard(const String& name, const String& id, const String& version, const IPAddress& address, uint16_t port = 3180) {
+    bool addBoard(const String& name, const String& id, const String& version, const IPAddress& address, uint16_t port = 3180) {
       BoardPtr board(new Board(name, id, version, address, port));
-      board->onBoardConnection(_onBoardConnectionCallback);
-      board->onCameraStats(_onCameraStatsCallback);
-      board->onCameraSystemState(_onCameraSystemStateCallback);
-      board->onDetectionStats(_onDetectionStatsCallback);
-      board->onDetectionState(_onDetectionStateCallback);
-      board->onDetectionEvent(_onDetectionEventCallback);
-      _boards.push_back(std::move(board));
+      return addBoard(board);
     }
 
-    void addBoard(BoardPtr& board) {
-      board->onBoardConnection(_onBoardConnectionCallback);
-      board->onCameraStats(_onCameraStatsCallback);
-      board->onCameraSystemState(_onCameraSystemStateCallback);
-      board->onDetectionStats(_onDetectionStatsCallback);
-      board->onDetectionState(_onDetectionStateCallback);
-      board->onDetectionEvent(_onDetectionEventCallback);
+    // Returns false if the board was rejected, it is appended otherwise
+    bool addBoard(BoardPtr& board) {
+#ifdef AUTODARTS_MAX_BOARDS
+      if (_boards.size() >= AUTODARTS_MAX_BOARDS) {
+        LOG_ERROR(__FUNCTION__, F("Maximum number of boards reached, skipping [") << board->getName() << F("]"));
+        return false;
+      }
+#endif
+      if (_boards.empty()) {
+        _baselineFreeHeap = ESP.getFreeHeap();
+      }
+
+      board->setReconnectInterval(_reconnectInterval);
+      board->setAliveTimeout(_aliveTimeout);
+
+      // Connection changes and detection events pass through the journal,
+      // every state change invalidates the snapshot
+      uint8_t handle = _nextHandle++;
+      board->onBoardConnection([this, handle](const String& boardName, const String& boardId, bool connected) {
+        _journal.append(handle, connected ? Journal::CONNECTED : Journal::DISCONNECTED);
+        _snapshotDirty = true;
+        _onBoardConnectionCallback(boardName, boardId, connected);
+      });
+      board->onBoardMessage(_onBoardMessageCallback);
+      board->onCameraStats([this](const String& boardName, const String& boardId, int8_t id, int8_t fps, int16_t width, int16_t height) {
+        _snapshotDirty = true;
+        _onCameraStatsCallback(boardName, boardId, id, fps, width, height);
+      });
+      board->onCameraSystemState([this](const String& boardName, const String& boardId, State opened, State running) {
+        _snapshotDirty = true;
+        _onCameraSystemStateCallback(boardName, boardId, opened, running);
+      });
+      board->onDetectionStats([this](const String& boardName, const String& boardId, int8_t fps, int16_t width, int16_t height) {
+        _snapshotDirty = true;
+        _onDetectionStatsCallback(boardName, boardId, fps, width, height);
+      });
+      board->onDetectionState([this](const String& boardName, const String& boardId, State connected, State running, int16_t numThrows) {
+        _snapshotDirty = true;
+        _onDetectionStateCallback(boardName, boardId, connected, running, numThrows);
+      });
+      Event::Code lastEvent = Event::Code::UNKNOWN;
+      board->onDetectionEvent([this, handle, lastEvent](const String& boardName, const String& boardId, Status::Code status, Event::Code event) mutable {
+        if (event != lastEvent) {
+          _journal.append(handle, static_cast<uint8_t>(event));
+          lastEvent = event;
+        }
+        _snapshotDirty = true;
+        _onDetectionEventCallback(boardName, boardId, status, event);
+      });
+      Detector& detector = board->getDetector();
+      board->onThrow([this, &detector](const String& boardName, const String& boardId, const Throw& dart, int16_t numThrows) {
+        Match* match = findMatch(boardId);
+        if (match) {
+          match->applyThrow(dart);
+          detector.setCheckout(match->getCheckout());
+          _snapshotDirty = true;
+          LOG_DEBUG(boardName.c_str(), F("Match updated in ") << match->getLastUpdateMicros() << F("us, remaining: ") << match->getRemaining());
+        }
+        _onThrowCallback(boardName, boardId, dart, numThrows);
+      });
+      if (isConnected()) {
+        subscribeBoard(*board);
+      }
       _boards.push_back(std::move(board));
+      _snapshotDirty = true;
+      return true;
+    }
+
+    // Board timings, applied to present and future boards
+    void setReconnectInterval(uint16_t interval) {
+      _reconnectInterval = interval;
+      for (BoardPtr& board : _boards) {
+        board->setReconnectInterval(interval);
+      }
+    }
+
+    void setAliveTimeout(uint32_t timeout) {
+      _aliveTimeout = timeout;
+      for (BoardPtr& board : _boards) {
+        board->setAliveTimeout(timeout);
+      }
+    }
+
+    const BoardArray& getBoards() const {
+      return _boards;
+    }
+
+    size_t getNumBoards() const {
+      return _boards.size();
+    }
+
+    const Board& getBoard(uint8_t idx) const {
+      return *_boards[idx];
+    }
+
+    Board& getBoard(uint8_t idx) {
+      return *_boards[idx];
     }
 
     void deleteBoard(int8_t idx) {
       if (idx < _boards.size()) {
         _boards.erase(_boards.begin() + idx);
+        _snapshotDirty = true;
       }
       else {
         LOG_ERROR(__FUNCTION__, F("Index out of bounds!"));
@@ -82,12 +161,87 @@ namespace autodarts {
       }
     }
 
+    // Current state of all boards as JSON. It is only serialized again after
+    // a board changed, so frequent readers get the last rendered bytes and
+    // the version tells them whether anything changed.
+    const char* getSnapshot(size_t* length = nullptr, uint32_t* version = nullptr) {
+      if (_snapshotDirty || _snapshot.empty()) {
+        renderSnapshot();
+      }
+      if (length) {
+        *length = _snapshotLength;
+      }
+      if (version) {
+        *version = _snapshotVersion;
+      }
+      return _snapshot.data();
+    }
+
+    uint32_t getSnapshotVersion() const {
+      return _snapshotVersion;
+    }
+
+    uint32_t getSnapshotRenderMicros() const {
+      return _snapshotRenderMicros;
+    }
+
     void printBoards() const {
       for (uint8_t idx = 0; idx < _boards.size(); idx++) {
           printBoard(idx);
       }
     }
 
+    // Heap consumed per board since the first board was added, including
+    // websocket buffers of opened connections
+    uint32_t getHeapPerBoard() const {
+      uint32_t freeHeap = ESP.getFreeHeap();
+      if (_boards.empty() || freeHeap >= _baselineFreeHeap) {
+        return sizeof(Board);
+      }
+      return (_baselineFreeHeap - freeHeap) / _boards.size();
+    }
+
+    // Estimated number of boards that fit into the remaining heap
+    uint32_t getBoardCapacity() const {
+      uint32_t capacity = _boards.size() + ESP.getMaxAllocHeap() / getHeapPerBoard();
+#ifdef AUTODARTS_MAX_BOARDS
+      capacity = min<uint32_t>(capacity, AUTODARTS_MAX_BOARDS);
+#endif
+      return capacity;
+    }
+
+    void printMemoryUsage() const {
+      LOG_INFO(__FUNCTION__, F("Boards: ") << _boards.size() << F("/") << getBoardCapacity()
+                          << F(" Heap per board: ") << getHeapPerBoard()
+                          << F(" Free heap: ") << ESP.getFreeHeap()
+                          << F(" Min free heap: ") << ESP.getMinFreeHeap()
+                          << F(" Max alloc: ") << ESP.getMaxAllocHeap());
+      for (const BoardPtr& board : _boards) {
+#ifdef AUTODARTS_LOAD_TEST
+        LOG_INFO(board->getName().c_str(), F("Messages: ") << board->getNumMessages() << F(" Bytes: ") << board->getNumBytes()
+                                        << F(" Dropped: ") << board->getNumDropped() << F(" Late: ") << board->getNumLate());
+#else
+        LOG_INFO(board->getName().c_str(), F("Messages: ") << board->getNumMessages() << F(" Bytes: ") << board->getNumBytes());
+#endif
+      }
+    }
+
+    // Throw cycle timings per board, see Detector::Timings
+    void printTimings() const {
+      for (const BoardPtr& board : _boards) {
+        const Detector::Timings& timings = board->getDetector().getTimings();
+        LOG_INFO(board->getName().c_str(), F("Throw interval: ") << timings.throwInterval.getMean() << F("ms (p90 ") << timings.throwInterval.getPercentile(90)
+                                        << F("ms) Takeout: ") << timings.takeoutDuration.getMean() << F("ms (p90 ") << timings.takeoutDuration.getPercentile(90)
+                                        << F("ms) Reset recovery: ") << timings.resetRecovery.getMean() << F("ms (max ") << timings.resetRecovery.getMax() << F("ms)"));
+      }
+    }
+
+    void resetTimings() {
+      for (BoardPtr& board : _boards) {
+        board->getDetector().resetTimings();
+      }
+    }
+
     bool openBoard(uint8_t idx, bool force = false) const {
       if (idx < _boards.size()) {
         if (!_boards[idx]->open(force)) {
@@ -119,12 +273,124 @@ namespace autodarts {
       return true;
     }
 
-    void updateBoards() const {
-      for (uint8_t idx = 0; idx < _boards.size(); idx++) {
-        updateBoard(idx);
+    // Board handles in the journal are assigned in the order boards are added
+    bool beginJournal(fs::FS& fs, const char* prefix = "/journal") {
+      return _journal.begin(fs, prefix);
+    }
+
+    void endJournal() {
+      _journal.end();
+    }
+
+    const Journal& getJournal() const {
+      return _journal;
+    }
+
+    bool startCapture(uint8_t idx, fs::FS& fs, const char* path) {
+      if (idx < _boards.size()) {
+        return _boards[idx]->startCapture(fs, path);
+      }
+      LOG_ERROR(__FUNCTION__, F("Index out of bounds!"));
+      return false;
+    }
+
+    void stopCapture(uint8_t idx) {
+      if (idx < _boards.size()) {
+        _boards[idx]->stopCapture();
+      }
+      else {
+        LOG_ERROR(__FUNCTION__, F("Index out of bounds!"));
+      }
+    }
+
+    // Probes the local subnet for boards, found boards are added and opened
+    // without the autodarts.io API. Runs in the background of updateBoards().
+    bool discoverBoards(uint16_t port = 3180, uint8_t maxProbes = 8, uint16_t timeout = 300) {
+      _discovery.onBoardFound([this](const IPAddress& address, uint16_t port) {
+        String url = address.toString() + ':' + String(port);
+        if (findBoardByUrl(_boards, url) >= 0) {
+          return;
+        }
+        // The upgrade response carries no id, autodarts.io replaces it once the board is listed
+        String id = AUTODARTS_DISCOVERY_ID_PREFIX + url;
+        if (addBoard("Board " + address.toString(), id, "", address, port)) {
+          openBoard(_boards.size() - 1);
+        }
+      });
+      return _discovery.begin(WiFi.localIP(), WiFi.subnetMask(), port, maxProbes, timeout);
+    }
+
+    bool isDiscovering() const {
+      return _discovery.isRunning();
+    }
+
+    void updateBoards() {
+#ifdef AUTODARTS_PROFILING
+      for (BoardPtr& board : _boards) {
+        board->getProfile().beginLoop();
+      }
+      _cloudProfile.beginLoop();
+      uint32_t loopStart = AUTODARTS_CYCLE_COUNT();
+#endif
+      _discovery.update();
+      _journal.update();
+
+      // Boards are served by the cloud subscription instead of local sockets
+      if (_cloudEnabled) {
+        updateCloud();
+      }
+      else {
+        for (BoardPtr& board : _boards) {
+          board->update(false);
+        }
       }
+
+      // Receive on all boards first, so state messages of every board are
+      // dispatched before any board's telemetry
+      for (BoardPtr& board : _boards) {
+        board->dispatch(Priority::STATE);
+      }
+      for (BoardPtr& board : _boards) {
+        board->dispatch(Priority::TELEMETRY);
+      }
+#ifdef AUTODARTS_PROFILING
+      checkLoopBudget(AUTODARTS_CYCLE_COUNT() - loopStart);
+#endif
+    }
+
+#ifdef AUTODARTS_PROFILING
+    // Warns whenever updateBoards() takes longer than the budget, 0 disables
+    void setLoopBudget(uint32_t micros) {
+      _loopBudget = micros;
+    }
+
+    uint32_t getLoopBudget() const {
+      return _loopBudget;
     }
 
+    uint32_t getNumBudgetOverruns() const {
+      return _numBudgetOverruns;
+    }
+
+    void printProfile() const {
+      for (const BoardPtr& board : _boards) {
+        const Profile& profile = board->getProfile();
+        LOG_INFO(board->getName().c_str(), F("CPU time: ") << Profile::toMicros(profile.getTotalCycles()) << F("us")
+                                        << F(" I/O: ") << Profile::toMicros(profile.getTotalCycles(Profile::IO))
+                                        << F("us (max ") << Profile::toMicros(profile.getMaxCycles(Profile::IO))
+                                        << F("us) Parse: ") << Profile::toMicros(profile.getTotalCycles(Profile::PARSE))
+                                        << F("us (max ") << Profile::toMicros(profile.getMaxCycles(Profile::PARSE))
+                                        << F("us) Callback: ") << Profile::toMicros(profile.getTotalCycles(Profile::CALLBACK))
+                                        << F("us (max ") << Profile::toMicros(profile.getMaxCycles(Profile::CALLBACK)) << F("us)"));
+      }
+      if (_cloudEnabled) {
+        LOG_INFO("Cloud", F("CPU time: ") << Profile::toMicros(_cloudProfile.getTotalCycles()) << F("us (max ")
+                       << Profile::toMicros(_cloudProfile.getMaxCycles(Profile::IO)) << F("us)"));
+      }
+      LOG_INFO(__FUNCTION__, F("Loop budget overruns: ") << _numBudgetOverruns);
+    }
+#endif
+
     int autoDetectBoards(const String& username, const String& password, bool forceUpdate = false) {
       // Get access token to connect to autodarts.io account
       int ret = requestAccessToken(username, password, _accessToken, forceUpdate);
@@ -133,9 +399,15 @@ namespace autodarts {
         return ret;
       }
 
+      // Forget cached validators to force a full listing
+      if (forceUpdate) {
+        _boardsETag = "";
+        _boardsLastModified = "";
+      }
+
       // Get boards from autodarts.io account
       ret = requestBoards(_boards, _accessToken);
-      if (ret != HTTP_CODE_OK) {
+      if (ret != HTTP_CODE_OK && ret != HTTP_CODE_NOT_MODIFIED) {
         LOG_ERROR(__FUNCTION__, F("Could not get all boards from autodarts.io"));
         return ret;
       }
@@ -151,40 +423,40 @@ namespace autodarts {
       _lastChecked = millis();
       return autoDetectBoards(username, password);
     }
-/*
-    bool connect(const String& username, const String& password) {
-      if (requestAccessToken(username, password) != HTTP_CODE_OK) {
-        return false;
-      }
-      if (requestTicket()!= HTTP_CODE_OK) {
-        return false;
-      }
-      
-      bool connected = _websocket.connect(AUTODARTS_WS_SECURE_URL + _ticket);
-      if (!connected) {
-        LOG_ERROR("connect", "Could not connect to websocket");
-      }
+    bool connect(const String& username, const String& password, const String& url = AUTODARTS_WS_SECURE_URL) {
+      _username = username;
+      _password = password;
+      _cloudUrl = url;
+      _cloudEnabled = true;
 
       _websocket.onMessage([this](websockets::WebsocketsMessage message) {
-        DynamicJsonDocument json(1024);
-        deserializeJson(json, message.data());
-        serializeJsonPretty(json, Serial);
+        // The message is our own copy, so its buffer may be handed out mutable
+        websockets::WSString& data = const_cast<websockets::WSString&>(message.rawData());
+        receiveCloudMessage(&data[0], data.size());
       });
 
       _websocket.onEvent([this](websockets::WebsocketsEvent event, String data) {
         if(event == websockets::WebsocketsEvent::ConnectionOpened) {
-            Serial.print("Connnection Opened: ");
+          LOG_INFO("onEvent", F("Cloud connection opened"));
         } else if(event == websockets::WebsocketsEvent::ConnectionClosed) {
-            Serial.print("Connnection Closed: ");
-        } else if(event == websockets::WebsocketsEvent::GotPing) {
-            Serial.print("Got a Ping: ");
-        } else if(event == websockets::WebsocketsEvent::GotPong) {
-            Serial.print("Got a Pong: ");
+          LOG_INFO("onEvent", F("Cloud connection closed"));
+          setBoardsOpen(false);
         }
       });
-      return connected;
+
+      return openCloud();
+    }
+
+    void disconnect() {
+      _cloudEnabled = false;
+      _websocket.close();
+      setBoardsOpen(false);
     }
-*/
+
+    bool isConnected() {
+      return _cloudEnabled && _websocket.available();
+    }
+
     int requestAccessToken(const String& username, const String& password, Token& accessToken, bool forceUpdate = false) const {
       // Check if token is still valid    
       if (!forceUpdate && accessToken.second > millis()) {
@@ -229,6 +501,107 @@ namespace autodarts {
       return ret;
     }
 
+    // Fetches the active match of a board and keeps it updated from throws
+    int trackMatch(uint8_t idx, const String& url = AUTODARTS_API_MATCHES_URL) {
+      if (idx >= _boards.size()) {
+        LOG_ERROR(__FUNCTION__, F("Index out of bounds!"));
+        return HTTP_CODE_BAD_REQUEST;
+      }
+
+      Match* match = findMatch(_boards[idx]->getId());
+      if (!match) {
+        MatchPtr created(new Match(_boards[idx]->getId()));
+        match = created.get();
+        _matches.push_back(std::move(created));
+      }
+      int ret = requestMatch(*match, _accessToken, url);
+      _boards[idx]->getDetector().setCheckout(match->getCheckout());
+      _snapshotDirty = true;
+      return ret;
+    }
+
+    void untrackMatch(uint8_t idx) {
+      if (idx < _boards.size()) {
+        for (auto it = _matches.begin(); it != _matches.end(); it++) {
+          if ((*it)->getBoardId() == _boards[idx]->getId()) {
+            _matches.erase(it);
+            _boards[idx]->getDetector().setCheckout(0);
+            _snapshotDirty = true;
+            return;
+          }
+        }
+      }
+    }
+
+    // Matches are kept on the heap, so the pointer stays valid while other
+    // boards track matches, until the board's match is untracked
+    const Match* getMatch(uint8_t idx) {
+      return idx < _boards.size() ? findMatch(_boards[idx]->getId()) : nullptr;
+    }
+
+    int requestMatch(Match& match, const Token& accessToken, const String& url = AUTODARTS_API_MATCHES_URL) const {
+      // Check if input data is avialable
+      if (accessToken.first.isEmpty() || accessToken.second < millis()) {
+        LOG_ERROR(__FUNCTION__, F("Access token is invalid!"));
+        return HTTP_CODE_UNAUTHORIZED;
+      }
+
+      // Send GET to retrieve active matches
+      HTTPClient httpClient;
+      httpClient.useHTTP10(true);
+      httpClient.begin(url);
+      httpClient.addHeader("Authorization", "Bearer " + accessToken.first);
+      int ret = httpClient.GET();
+
+      if (ret == HTTP_CODE_OK) {
+        // Prepare filter
+        DynamicJsonDocument filter(256);
+        filter["id"] = true;
+        filter["settings"]["baseScore"] = true;
+        filter["settings"]["outMode"] = true;
+        filter["players"][0]["name"] = true;
+        filter["players"][0]["boardId"] = true;
+        filter["gameScores"] = true;
+        filter["scores"][0]["legs"] = true;
+        filter["player"] = true;
+        filter["finished"] = true;
+
+        // Read json from stream in chunks until the match of the board is found
+        ret = HTTP_CODE_NOT_FOUND;
+        Stream& stream = httpClient.getStream();
+        stream.find('[');
+        do {
+          DynamicJsonDocument doc(2048);
+          DeserializationError err = deserializeJson(doc, stream, DeserializationOption::Filter(filter));
+          if (err) {
+            LOG_ERROR(__FUNCTION__, F("Could not deserialize match: ") << err.c_str());
+            continue;
+          }
+
+          for (JsonObjectConst player : doc["players"].as<JsonArrayConst>()) {
+            if (match.getBoardId().equals(player["boardId"].as<const char*>())) {
+              match.fromJson(doc.as<JsonObjectConst>());
+              ret = HTTP_CODE_OK;
+              break;
+            }
+          }
+        } while (ret != HTTP_CODE_OK && stream.findUntil(",", "]"));
+
+        if (ret == HTTP_CODE_OK) {
+          LOG_INFO(__FUNCTION__, F("Tracking match [") << match.getId() << F("] with ") << match.getNumPlayers() << F(" players"));
+        }
+        else {
+          LOG_WARNING(__FUNCTION__, F("No active match for board [") << match.getBoardId() << F("]"));
+        }
+      }
+      else {
+        LOG_ERROR(__FUNCTION__, F("Could not retrieve matches [") << ret << F("]: ") << httpClient.getString());
+      }
+
+      httpClient.end();
+      return ret;
+    }
+
     int requestTicket(String& ticket, const Token& accessToken) const {
       // Check if input data is avialable
       if (accessToken.first.isEmpty() || accessToken.second < millis()) {
@@ -245,6 +618,11 @@ namespace autodarts {
       
       if (ret == HTTP_CODE_OK) {
         ticket = httpClient.getString();
+        ticket.trim();
+        // Ticket may be delivered as a json string
+        if (ticket.startsWith("\"") && ticket.endsWith("\"")) {
+          ticket = ticket.substring(1, ticket.length() - 1);
+        }
       }
       else {
         LOG_ERROR(__FUNCTION__, F("Could not retrieve ticket [") << ret << F("]: ") << httpClient.getString());
@@ -261,55 +639,48 @@ namespace autodarts {
         return HTTP_CODE_UNAUTHORIZED;
       }
 
-      // Send POST to retrieve boards
+      // Send conditional GET to retrieve boards
+      const char* headerKeys[] = {"ETag", "Last-Modified", "Content-Encoding"};
       HTTPClient httpClient;
       httpClient.useHTTP10(true);
       httpClient.begin(AUTODARTS_API_BOARDS_URL);
+      httpClient.collectHeaders(headerKeys, 3);
       httpClient.addHeader("Authorization", "Bearer " + accessToken.first);
+      httpClient.addHeader(F("Accept-Encoding"), F("gzip"));
+      if (!_boardsETag.isEmpty()) {
+        httpClient.addHeader(F("If-None-Match"), _boardsETag);
+      }
+      if (!_boardsLastModified.isEmpty()) {
+        httpClient.addHeader(F("If-Modified-Since"), _boardsLastModified);
+      }
       int ret = httpClient.GET();
       
       if (ret == HTTP_CODE_OK) {
-        // Prepare filter      
-        DynamicJsonDocument filter(80);
-        filter["id"] = true;
-        filter["name"] = true;
-        filter["ip"] = true;
-        filter["version"] = true;
+        uint32_t start = micros();
+        size_t transferred = 0;
 
-        // Read json from stream in chunks
-        httpClient.getStream().find('[');
-        do {
-          DynamicJsonDocument doc(1024);
-          DeserializationError err = deserializeJson(doc, httpClient.getStream(), DeserializationOption::Filter(filter));        
-          if (err) {
-            LOG_ERROR(__FUNCTION__, F("Could not deserialize board information: ") << err.c_str());
-            continue;
+        if (httpClient.header("Content-Encoding").equalsIgnoreCase("gzip")) {
+          GzipStream stream(httpClient.getStream());
+          parseBoards(boards, stream);
+          if (!stream.finish()) {
+            ret = HTTP_CODE_INTERNAL_SERVER_ERROR;
           }
+          transferred = stream.getCompressedBytes();
+        }
+        else {
+          parseBoards(boards, httpClient.getStream());
+          transferred = max(httpClient.getSize(), 0);
+        }
 
-          bool found = false;
-          const char* id = doc["id"];
-          // Check if board with the given id is already present
-          for (BoardPtr& board : boards) {
-            // If board already exists, only update data
-            if (board->getId().equals(id)) {
-              LOG_INFO(__FUNCTION__, F("Found an existing board [") << board->getName() << F("][") << board->getId() << F("]"));
-              board->fromJson(doc.as<JsonObject>());
-              found = true;
-              break;
-            }
-          }
-          // If no board with the given id is found add a new one
-          if (!found) {
-            BoardPtr board(new Board(doc.as<JsonObject>()));
-            if (board->getUrl().isEmpty()) {
-              LOG_WARNING(__FUNCTION__, F("Skipping board with empty url [") << board->getName() << F("][") << board->getId() << F("]"));
-            }
-            else {
-              LOG_INFO(__FUNCTION__, F("Found a new board [")  << board->getName() << F("][") << board->getId() << F("]"));
-              addBoard(board);
-            }
-          }
-        } while (httpClient.getStream().findUntil(",", "]"));
+        // Only remember validators of a complete listing
+        if (ret == HTTP_CODE_OK) {
+          _boardsETag = httpClient.header("ETag");
+          _boardsLastModified = httpClient.header("Last-Modified");
+        }
+        LOG_DEBUG(__FUNCTION__, F("Boards refreshed: ") << transferred << F(" bytes in ") << (micros() - start) << F("us"));
+      }
+      else if (ret == HTTP_CODE_NOT_MODIFIED) {
+        LOG_DEBUG(__FUNCTION__, F("Boards not modified"));
       }
       else {
         LOG_ERROR(__FUNCTION__, F("Could not retrieve boards [") << ret << F("]: ") << httpClient.getString());
@@ -319,60 +690,368 @@ namespace autodarts {
       return ret;
     }
 
+    void parseBoards(BoardArray& boards, Stream& stream) {
+      // Prepare filter      
+      DynamicJsonDocument filter(80);
+      filter["id"] = true;
+      filter["name"] = true;
+      filter["ip"] = true;
+      filter["version"] = true;
+
+      // Read json from stream in chunks
+      stream.find('[');
+      do {
+        DynamicJsonDocument doc(1024);
+        DeserializationError err = deserializeJson(doc, stream, DeserializationOption::Filter(filter));        
+        if (err) {
+          LOG_ERROR(__FUNCTION__, F("Could not deserialize board information: ") << err.c_str());
+          continue;
+        }
+
+        bool found = false;
+        const char* id = doc["id"];
+        // Check if board with the given id is already present
+        for (BoardPtr& board : boards) {
+          // If board already exists, only update data
+          if (board->getId().equals(id)) {
+            LOG_INFO(__FUNCTION__, F("Found an existing board [") << board->getName() << F("][") << board->getId() << F("]"));
+            String url = board->getUrl();
+            board->fromJson(doc.as<JsonObject>());
+            // A board that moved is reopened by the next openBoards()
+            if (board->getUrl() != url) {
+              board->close();
+            }
+            found = true;
+            break;
+          }
+        }
+        // Boards found on the local network have a placeholder id, adopt them by url
+        if (!found && doc["ip"].is<const char*>()) {
+          int idx = findBoardByUrl(boards, doc["ip"].as<const char*>());
+          if (idx >= 0 && boards[idx]->getId().startsWith(AUTODARTS_DISCOVERY_ID_PREFIX)) {
+            LOG_INFO(__FUNCTION__, F("Found a discovered board [") << doc["name"].as<const char*>() << F("][") << id << F("]"));
+            String url = boards[idx]->getUrl();
+            boards[idx]->fromJson(doc.as<JsonObject>());
+            // Keep the port the board was discovered on
+            boards[idx]->setUrl(url);
+            found = true;
+          }
+        }
+        // If no board with the given id is found add a new one
+        if (!found) {
+          BoardPtr board(new Board(doc.as<JsonObject>()));
+          if (board->getUrl().isEmpty()) {
+            LOG_WARNING(__FUNCTION__, F("Skipping board with empty url [") << board->getName() << F("][") << board->getId() << F("]"));
+          }
+          else {
+            LOG_INFO(__FUNCTION__, F("Found a new board [")  << board->getName() << F("][") << board->getId() << F("]"));
+            addBoard(board);
+          }
+        }
+      } while (stream.findUntil(",", "]"));
+    }
+
     void onBoardConnection(BoardConnectionCallback callback) {
       _onBoardConnectionCallback = callback;
+    }
+
+    void onBoardMessage(BoardMessageCallback callback) {
+      _onBoardMessageCallback = callback;
       for (BoardPtr& board : _boards) {
-        board->onBoardConnection(_onBoardConnectionCallback);
+        board->onBoardMessage(_onBoardMessageCallback);
       }
     }
 
     void onCameraStats(CameraStatsCallback callback) {
       _onCameraStatsCallback = callback;
-      for (BoardPtr& board : _boards) {
-        board->onCameraStats(_onCameraStatsCallback);
-      }
     }
 
     void onCameraSystemState(CameraSystemStateCallback callback) {
       _onCameraSystemStateCallback = callback;
-      for (BoardPtr& board : _boards) {
-        board->onCameraSystemState(_onCameraSystemStateCallback);
-      }
     }
 
     void onDetectionStats(DetectionStatsCallback callback) {
       _onDetectionStatsCallback = callback;
-      for (BoardPtr& board : _boards) {
-        board->onDetectionStats(_onDetectionStatsCallback);
-      }
     }
 
     void onDetectionState(DetectionStateCallback callback) {
       _onDetectionStateCallback = callback;
-      for (BoardPtr& board : _boards) {
-        board->onDetectionState(_onDetectionStateCallback);
-      }
     }
 
     void onDetectionEvent(DetectionEventCallback callback) {
       _onDetectionEventCallback = callback;
+    }
+
+    void onThrow(ThrowCallback callback) {
+      _onThrowCallback = callback;
+    }
+
+  private:
+#ifdef AUTODARTS_PROFILING
+    // Blames the board and phase that used the most cycles of a slow loop
+    void checkLoopBudget(uint32_t cycles) {
+      uint32_t micros = Profile::toMicros(cycles);
+      if (!_loopBudget || micros <= _loopBudget) {
+        return;
+      }
+      _numBudgetOverruns++;
+
+      // The cloud connection is blamed like a board for its socket I/O
+      Hotspot hotspot;
+      const char* worstName = findHotspot(_cloudProfile, hotspot) ? "Cloud" : nullptr;
+      for (const BoardPtr& board : _boards) {
+        if (findHotspot(board->getProfile(), hotspot)) {
+          worstName = board->getName().c_str();
+        }
+      }
+      if (worstName) {
+        LOG_WARNING(__FUNCTION__, F("Loop took ") << micros << F("us of ") << _loopBudget << F("us budget, ")
+                               << worstName << F(" spent ") << Profile::toMicros(hotspot.cycles) << F("us in ") << Profile::toCString(hotspot.phase));
+      }
+      else {
+        LOG_WARNING(__FUNCTION__, F("Loop took ") << micros << F("us of ") << _loopBudget << F("us budget outside of boards"));
+      }
+    }
+#endif
+
+    // Urls match on their host, a missing port means the default port
+    static int findBoardByUrl(const BoardArray& boards, const String& url) {
+      String host = url.substring(0, url.indexOf(':') < 0 ? url.length() : url.indexOf(':'));
+      uint16_t port = url.indexOf(':') < 0 ? 3180 : url.substring(url.indexOf(':') + 1).toInt();
+      for (size_t idx = 0; idx < boards.size(); idx++) {
+        const String& other = boards[idx]->getUrl();
+        int index = other.indexOf(':');
+        String otherHost = index < 0 ? other : other.substring(0, index);
+        uint16_t otherPort = index < 0 ? 3180 : other.substring(index + 1).toInt();
+        if (host == otherHost && port == otherPort) {
+          return idx;
+        }
+      }
+      return -1;
+    }
+
+    void renderSnapshot() {
+      uint32_t start = micros();
+
+      // The document and buffer keep their capacity between renders. A
+      // document that is too small grows up to AUTODARTS_SNAPSHOT_MAX_SIZE,
+      // the last snapshot is kept if it cannot grow any further.
+      while (!buildSnapshot(_snapshotVersion + 1)) {
+        size_t capacity = _snapshotJson.capacity();
+        if (capacity < AUTODARTS_SNAPSHOT_MAX_SIZE) {
+          // A failed allocation leaves a capacity of 0, start over from 1KB
+          size_t grown = capacity ? capacity * 2 : 1024;
+          grown = grown < AUTODARTS_SNAPSHOT_MAX_SIZE ? grown : AUTODARTS_SNAPSHOT_MAX_SIZE;
+          LOG_WARNING(__FUNCTION__, F("Snapshot document too small, growing it to ") << grown << F(" bytes"));
+          _snapshotJson = DynamicJsonDocument(grown);
+        }
+        if (_snapshotJson.capacity() <= capacity) {
+          LOG_ERROR(__FUNCTION__, F("Could not grow snapshot document beyond ") << capacity << F(" bytes"));
+          _snapshotDirty = false;
+          return;
+        }
+      }
+      _snapshotVersion++;
+
+      size_t size = measureJson(_snapshotJson) + 1;
+      if (_snapshot.size() < size) {
+        _snapshot.resize(size);
+      }
+      _snapshotLength = serializeJson(_snapshotJson, _snapshot.data(), _snapshot.size());
+      _snapshotDirty = false;
+      _snapshotRenderMicros = micros() - start;
+    }
+
+    // Fills the snapshot document, returns false if it overflowed
+    bool buildSnapshot(uint32_t version) {
+      JsonObject root = _snapshotJson.to<JsonObject>();
+      root["version"] = version;
+      JsonArray boards = root.createNestedArray("boards");
+      for (const BoardPtr& board : _boards) {
+        JsonObject entry = boards.createNestedObject();
+        entry["id"]   = board->getId().c_str();
+        entry["name"] = board->getName().c_str();
+        entry["open"] = board->isOpen();
+
+        const Detector& detector = board->getDetector();
+        JsonObject state = entry.createNestedObject("detector");
+        state["connected"] = detector.isConnected();
+        state["running"]   = detector.isRunning();
+        state["status"]    = detector.getStatus().toCString();
+        state["event"]     = detector.getEvent().toCString();
+        state["numThrows"] = detector.getNumThrows();
+        if (detector.getCheckout()) {
+          char checkout[16];
+          Checkout::format(detector.getCheckout(), checkout, sizeof(checkout));
+          state["checkout"] = checkout;
+        }
+        state["fps"]       = detector.getFPS();
+        state["width"]     = detector.getWidth();
+        state["height"]    = detector.getHeight();
+
+        const CameraSystem& cameraSystem = detector.getCameraSystem();
+        JsonObject cameras = entry.createNestedObject("cameras");
+        cameras["opened"]  = cameraSystem.isOpen();
+        cameras["running"] = cameraSystem.isRunning();
+        JsonArray stats = cameras.createNestedArray("stats");
+        for (uint8_t id = 0; id < AUTODARTS_NUM_CAMERAS; id++) {
+          if (cameraSystem.hasCamera(id)) {
+            Camera camera = cameraSystem.getCameraById(id);
+            JsonObject stat = stats.createNestedObject();
+            stat["id"]     = id;
+            stat["fps"]    = camera.getFPS();
+            stat["width"]  = camera.getWidth();
+            stat["height"] = camera.getHeight();
+          }
+        }
+      }
+      return !_snapshotJson.overflowed();
+    }
+
+    Match* findMatch(const String& boardId) {
+      for (MatchPtr& match : _matches) {
+        if (match->getBoardId() == boardId) {
+          return match.get();
+        }
+      }
+      return nullptr;
+    }
+
+    bool openCloud() {
+      _lastCloudAttempt = millis();
+
+      // Tickets are single use, so every (re)connect needs a fresh one
+      int ret = requestAccessToken(_username, _password, _accessToken);
+      if (ret != HTTP_CODE_OK) {
+        LOG_ERROR(__FUNCTION__, F("Could not get token to connect to autodarts.io"));
+        return false;
+      }
+      ret = requestTicket(_ticket, _accessToken);
+      if (ret != HTTP_CODE_OK) {
+        LOG_ERROR(__FUNCTION__, F("Could not get ticket to connect to autodarts.io"));
+        return false;
+      }
+
+      if (!_websocket.connect(_cloudUrl + _ticket)) {
+        LOG_ERROR(__FUNCTION__, F("Could not connect to websocket"));
+        return false;
+      }
+
       for (BoardPtr& board : _boards) {
-        board->onDetectionEvent(_onDetectionEventCallback);
+        subscribeBoard(*board);
       }
+      setBoardsOpen(true);
+      return true;
+    }
+
+    void updateCloud() {
+      if (_websocket.available()) {
+        // Boards account their own messages within the poll
+        AUTODARTS_PROFILE(_cloudProfile, IO);
+        _websocket.poll();
+      }
+      else if ((millis() - _lastCloudAttempt) >= AUTODARTS_CLOUD_RECONNECT_INTERVAL) {
+        LOG_INFO(__FUNCTION__, F("Renewing ticket and reconnecting to autodarts.io"));
+        openCloud();
+      }
+    }
+
+    void subscribeBoard(const Board& board) {
+      // One subscription per board channel, the API has no wildcard topics
+      for (const char* topic : AUTODARTS_WS_BOARD_TOPICS) {
+        char message[128];
+        snprintf(message, sizeof(message), AUTODARTS_WS_SUBSCRIBE_REQUEST, board.getId().c_str(), topic);
+        if (!_websocket.send(message)) {
+          LOG_ERROR(__FUNCTION__, F("Could not subscribe to ") << topic << F(" of board [") << board.getName() << F("]"));
+        }
+      }
+    }
+
+    void setBoardsOpen(bool open) {
+      for (BoardPtr& board : _boards) {
+        if (board->isOpen() != open) {
+          board->setOpen(open);
+        }
+      }
+    }
+
+    // Routes a cloud message by its topic "<boardId>.<kind>" and queues its
+    // data on the board, like a message received on the board's own socket.
+    // The board parses and dispatches it with its local messages, so cloud
+    // messages share the state and telemetry queues.
+    void receiveCloudMessage(char* payload, size_t length) {
+      rawjson::Span topic, data;
+      if (!rawjson::findString(payload, length, "topic", topic) || !rawjson::findMember(payload, length, "data", data)) {
+        return;
+      }
+      Board* board = findCloudBoard(topic);
+      if (board == nullptr) {
+        return;
+      }
+      // Terminate the data in place, the topic is not used after the lookup
+      char* message = payload + (data.data - payload);
+      message[data.length] = '\0';
+      board->receive(message, data.length);
+    }
+
+    // Returns nullptr for unknown boards
+    Board* findCloudBoard(const rawjson::Span& topic) {
+      const char* dot = static_cast<const char*>(memchr(topic.data, '.', topic.length));
+      size_t idLength = dot ? dot - topic.data : topic.length;
+
+      for (BoardPtr& board : _boards) {
+        const String& id = board->getId();
+        if (id.length() == idLength && strncmp(id.c_str(), topic.data, idLength) == 0) {
+          return board.get();
+        }
+      }
+      LOG_WARNING(__FUNCTION__, F("Message for unknown board: ") << String(topic.data).substring(0, idLength));
+      return nullptr;
     }
 
-  private:
     String _ticket;
+    String _boardsETag;
+    String _boardsLastModified;
     Token _accessToken;
     BoardArray _boards;
+    std::vector<MatchPtr> _matches;
+    Journal _journal;
+    Discovery _discovery;
+    uint8_t _nextHandle = 0;
     uint64_t _lastChecked = 0;
+    uint32_t _baselineFreeHeap = 0;
+    uint16_t _reconnectInterval = 5000;
+    uint32_t _aliveTimeout = 10000;
+
+    DynamicJsonDocument _snapshotJson{4096};
+    std::vector<char> _snapshot;
+    size_t   _snapshotLength = 0;
+    uint32_t _snapshotVersion = 0;
+    uint32_t _snapshotRenderMicros = 0;
+    bool     _snapshotDirty = true;
+
+#ifdef AUTODARTS_PROFILING
+    uint32_t _loopBudget = 0;
+    uint32_t _numBudgetOverruns = 0;
+    // Cloud socket I/O, messages are accounted to their boards
+    Profile  _cloudProfile;
+#endif
+
+    websockets::WebsocketsClient _websocket;
+    String _username;
+    String _password;
+    String _cloudUrl;
+    bool _cloudEnabled = false;
+    uint64_t _lastCloudAttempt = 0;
 
     BoardConnectionCallback   _onBoardConnectionCallback   = [](const String&, const String&, bool){};
+    BoardMessageCallback      _onBoardMessageCallback      = [](const String&, const String&, const char*, size_t){};
     CameraStatsCallback       _onCameraStatsCallback       = [](const String&, const String&, int8_t, int8_t, int16_t, int16_t){};
     CameraSystemStateCallback _onCameraSystemStateCallback = [](const String&, const String&, State, State){};
     DetectionStatsCallback    _onDetectionStatsCallback    = [](const String&, const String&, int8_t, int16_t, int16_t){};
     DetectionStateCallback    _onDetectionStateCallback    = [](const String&, const String&, State, State, int16_t){};
     DetectionEventCallback    _onDetectionEventCallback    = [](const String&, const String&, Status::Code, Event::Code){};
+    ThrowCallback             _onThrowCallback             = [](const String&, const String&, const Throw&, int16_t){};
   };
 
 } // autodarts
@@ -3,19 +3,66 @@ WiFiManager wifiManager;
 WiFiManagerParameter autodartsUsername("username", "Autodarts Username", "", 40);
 WiFiManagerParameter autodartsPassword("password", "Autodarts Password", "", 20);
 
+// Use boards of AutodartsLoadGenerator instead of autodarts.io. Boards are
+// added one per report, so heap and loop time are logged per board count.
+//#define LOAD_GENERATOR_ADDRESS IPAddress(192, 168, 1, 50)
+#define LOAD_GENERATOR_BOARDS  4
+#define LOAD_GENERATOR_PORT    3180
+#ifdef LOAD_GENERATOR_ADDRESS
+#define AUTODARTS_LOAD_TEST
+#endif
+
+// Per board CPU time accounting and loop budget warnings
+//#define AUTODARTS_PROFILING
+#define LOOP_BUDGET_MICROS 20000
+
 #include "AutodartsClient.h"
 autodarts::Client client;
 
 #include <SPIFFS.h>
+#include "AutodartsConfig.h"
+autodarts::Config config;
+
+// Find boards on the local network before autodarts.io answers, comment out to disable
+#define LOCAL_DISCOVERY
+
+// Rebroadcast board events to local displays, uncomment to enable
+//#define EVENT_SERVER_PORT 3181
+#ifdef EVENT_SERVER_PORT
+#include "AutodartsEventServer.h"
+autodarts::EventServer eventServer(EVENT_SERVER_PORT);
+#endif
+
+#include "AutodartsLeds.h"
+
+// LED channels of the engine, in the order of ledPins
+#define LED_RED    0
+#define LED_GREEN  1
+#define LED_BLUE   2
+#define LED_WHITE  3
+const uint8_t ledPins[] = {32, 33, 14, 12};
+
+void writeLed(uint8_t channel, uint8_t level) {
+  analogWrite(ledPins[channel], level);
+}
 
-#define LED_RED    32
-#define LED_GREEN  33
-#define LED_BLUE   14
-#define LED_WHITE  12
+autodarts::LedEngineT<4> leds(writeLed);
 
 bool paramsSave  = false;
 bool paramsApply = false;
 
+#ifdef LOAD_GENERATOR_ADDRESS
+uint8_t  numLoadBoards = 0;
+uint32_t maxLoopMicros = 0;
+
+void addLoadBoard() {
+  uint8_t idx = numLoadBoards++;
+  if (client.addBoard("Mock " + String(idx), "mock-" + String(idx), "", LOAD_GENERATOR_ADDRESS, LOAD_GENERATOR_PORT + idx)) {
+    client.openBoard(client.getNumBoards() - 1);
+  }
+}
+#endif
+
 
 
 // Increase stack size
@@ -24,26 +71,34 @@ SET_LOOP_TASK_STACK_SIZE(16*1024); // 16KB
 void onBoardConnectionCallback(const String& boardName, const String& boardId, bool connected) {
   if (connected) {
     LOG_INFO("Autodarts", F("Board '") << boardName << F("' connected"));
-    digitalWrite(LED_RED, LOW);
+    leds.play(LED_RED, autodarts::Effect::FADE_OUT, 500);
   }
   else {
     LOG_INFO("Autodarts", F("Board '") << boardName << F("' disconnected"));
-    digitalWrite(LED_RED, HIGH);
-    digitalWrite(LED_WHITE, LOW);
+    leds.play(LED_RED, autodarts::Effect::ON);
+    leds.play(LED_WHITE, autodarts::Effect::OFF);
   }
 }
 
 void onCameraSystemStateCallback(const String& boardName, const String& boardId, autodarts::State opened, autodarts::State running) {
   if (running == autodarts::State::TRUE || running == autodarts::State::TURNED_TRUE) {
     LOG_INFO("Autodarts", F("Cameras started"));
-    digitalWrite(LED_WHITE, HIGH);
+    leds.play(LED_WHITE, autodarts::Effect::FADE_IN, 500);
   }
   else if(running == autodarts::State::FALSE || running == autodarts::State::TURNED_FALSE) {
     LOG_INFO("Autodarts", F("Cameras stopped"));
-    digitalWrite(LED_WHITE, LOW);
+    leds.play(LED_WHITE, autodarts::Effect::FADE_OUT, 500);
   }
 }
 
+void onDetectionEventCallback(const String& boardName, const String& boardId, autodarts::Status::Code status, autodarts::Event::Code event) {
+  leds.onEvent(boardId.c_str(), event);
+}
+
+void onThrowCallback(const String& boardName, const String& boardId, const autodarts::Throw& dart, int16_t numThrows) {
+  leds.play(LED_GREEN, autodarts::Effect::FLASH, 300);
+}
+
 void onSaveWifiParams () {
   if (strlen(autodartsUsername.getValue()) != 0 && strlen(autodartsPassword.getValue()) != 0) {
     paramsSave = true;
@@ -54,8 +109,14 @@ void onSaveWifiParams () {
 bool connect(uint8_t numRetries = 0) {
   uint8_t retries = 0;
   while (retries <= numRetries) {
-    if (client.autoDetectBoards(autodartsUsername.getValue(), autodartsPassword.getValue()) == HTTP_CODE_OK) {
+    int ret = client.autoDetectBoards(autodartsUsername.getValue(), autodartsPassword.getValue());
+    if (ret == HTTP_CODE_OK || ret == HTTP_CODE_NOT_MODIFIED) {
+      // Only boards new to this lookup are opened, cached ones are already connecting
       client.openBoards();
+      // Cache boards, so they are opened right away on the next boot
+      if (config.setBoards(client.getBoards())) {
+        config.save(SPIFFS);
+      }
       return true;
     }
     retries++;
@@ -64,73 +125,46 @@ bool connect(uint8_t numRetries = 0) {
 }
 
 bool saveParams() {
-  bool ret = false;
-
-  DynamicJsonDocument json(1024);
-  json["autodarts_username"] = autodartsUsername.getValue();
-  json["autodarts_password"] = autodartsPassword.getValue();
-
-  File configFile = SPIFFS.open("/autodarts_config.json", "w");
-  if (configFile) {
-    serializeJsonPretty(json, Serial);
-    serializeJson(json, configFile);
-    ret = true;
-  }
-  else {
-    LOG_ERROR("Autodarts", F("Failed to open config file for writing!"));
-  }
-
-  configFile.close();
-  return ret;
+  return config.setCredentials(autodartsUsername.getValue(), autodartsPassword.getValue()) && config.save(SPIFFS);
 }
 
 bool loadParams() {
-  bool ret = false;
-
-  if (SPIFFS.exists("/autodarts_config.json")) {
-    File configFile = SPIFFS.open("/autodarts_config.json", "r");
-    if (configFile) {
-      size_t size = configFile.size();
-      char buffer[size];
-      configFile.readBytes(buffer, size);
-
-      DynamicJsonDocument json(1024);
-      DeserializationError err = deserializeJson(json, buffer);
-      if ( !err ) {
-        serializeJsonPretty(json, Serial);
-        autodartsUsername.setValue(json["autodarts_username"], 40);
-        autodartsPassword.setValue(json["autodarts_password"], 20);
-        ret = true;
-      } else {
-        LOG_ERROR("Autodarts", F("Failed to read json config!"));
-      }
-    }
-    configFile.close();
-  } else {
-    LOG_ERROR("Autodarts", F("Could not open config file for reading!"));
+  if (!config.load(SPIFFS) && !config.migrate(SPIFFS)) {
+    LOG_ERROR("Autodarts", F("Could not load config!"));
+    return false;
+  }
+  LOG_INFO("Autodarts", F("Config loaded in ") << config.getLoadMicros() << F("us"));
+
+  const autodarts::Config::Data& data = config.data();
+  autodartsUsername.setValue(data.username, 40);
+  autodartsPassword.setValue(data.password, 20);
+  client.setReconnectInterval(data.reconnectInterval);
+  client.setAliveTimeout(data.aliveTimeout);
+  for (uint8_t idx = 0; idx < data.numBoards; idx++) {
+    const autodarts::Config::CachedBoard& board = data.boards[idx];
+    client.addBoard(board.name, board.id, board.version, board.url);
   }
-  return ret;
+  return strlen(data.username) != 0 && strlen(data.password) != 0;
 }
 
 void setup() {
   Serial.begin(115200);
 
-  // Init pins
-  pinMode(LED_RED, OUTPUT);
-  digitalWrite(LED_RED, HIGH);
-
-  pinMode(LED_GREEN, OUTPUT);
-  digitalWrite(LED_GREEN, LOW);
-
-  pinMode(LED_BLUE, OUTPUT);
-  digitalWrite(LED_BLUE, LOW);
-
-  pinMode(LED_WHITE, OUTPUT);
-  digitalWrite(LED_WHITE, LOW);
-
-  // Try to load config from SPIFFS
+  // Init leds, red until a board is connected
+  for (uint8_t pin : ledPins) {
+    pinMode(pin, OUTPUT);
+  }
+  leds.begin();
+  leds.play(LED_RED, autodarts::Effect::ON);
+  leds.mapEvent(autodarts::Event::Code::STARTING,         LED_WHITE, autodarts::Effect::PULSE, 1000, true);
+  leds.mapEvent(autodarts::Event::Code::TAKEOUT_STARTED,  LED_BLUE,  autodarts::Effect::PULSE, 1000, true);
+  leds.mapEvent(autodarts::Event::Code::TAKEOUT_FINISHED, LED_BLUE,  autodarts::Effect::FADE_OUT, 300);
+  leds.mapEvent(autodarts::Event::Code::RESET,            LED_BLUE,  autodarts::Effect::BLINK, 200);
+
+  // Try to load config from SPIFFS, legacy json config is migrated once
   if (SPIFFS.begin()) {
     paramsApply = loadParams();
+    client.beginJournal(SPIFFS);
   }
   else {
     LOG_ERROR("Autodarts", F("Could not mount file system!"));
@@ -153,6 +187,11 @@ void setup() {
   // If connection fails it starts an access point with the specified name
   if(wifiManager.autoConnect("AutodartsAP")){
     LOG_INFO("Autodarts", F("Wifi connected"));
+    // Cached boards connect while autodarts.io is queried
+    client.openBoards();
+#ifdef LOCAL_DISCOVERY
+    client.discoverBoards();
+#endif
   }
   else {
     LOG_INFO("Autodarts", F("Wifi portal running"));
@@ -161,9 +200,27 @@ void setup() {
   // Start webportal
   wifiManager.startWebPortal();
 
+#ifdef AUTODARTS_PROFILING
+  client.setLoopBudget(LOOP_BUDGET_MICROS);
+#endif
+
   // Register callbacks
   client.onBoardConnection(onBoardConnectionCallback);
   client.onCameraSystemState(onCameraSystemStateCallback);
+  client.onDetectionEvent(onDetectionEventCallback);
+  client.onThrow(onThrowCallback);
+
+#ifdef LOAD_GENERATOR_ADDRESS
+  paramsApply = false;
+  addLoadBoard();
+#endif
+
+#ifdef EVENT_SERVER_PORT
+  eventServer.begin();
+  client.onBoardMessage([](const String& boardName, const String& boardId, const char* payload, size_t length) {
+    eventServer.publish(boardName, boardId, payload, length);
+  });
+#endif
 }
 
 void loop() {
@@ -177,6 +234,39 @@ void loop() {
     paramsApply = !connect(1);
   }
 
+#ifdef LOAD_GENERATOR_ADDRESS
+  uint32_t loopStart = micros();
+#endif
   client.updateBoards();
+#ifdef LOAD_GENERATOR_ADDRESS
+  uint32_t loopMicros = micros() - loopStart;
+  maxLoopMicros = loopMicros > maxLoopMicros ? loopMicros : maxLoopMicros;
+  static uint32_t lastReport = 0;
+  if (millis() - lastReport >= 5000) {
+    LOG_INFO("Scaling", F("Boards: ") << client.getNumBoards() << F(" Heap per board: ") << client.getHeapPerBoard()
+                     << F(" Free heap: ") << ESP.getFreeHeap() << F(" Max loop: ") << maxLoopMicros << F("us"));
+    maxLoopMicros = 0;
+    client.printMemoryUsage();
+    client.printTimings();
+#ifdef AUTODARTS_PROFILING
+    client.printProfile();
+#endif
+    const auto& ledStats = leds.getStats();
+    LOG_INFO("Leds", F("Frames: ") << ledStats.frames << F(" Missed: ") << ledStats.missedFrames
+                  << F(" Max jitter: ") << ledStats.maxJitterMicros << F("us Max render: ") << ledStats.maxRenderMicros << F("us"));
+    size_t snapshotLength = 0;
+    uint32_t snapshotVersion = 0;
+    client.getSnapshot(&snapshotLength, &snapshotVersion);
+    LOG_INFO("Autodarts", F("Snapshot v") << snapshotVersion << F(": ") << snapshotLength << F(" bytes rendered in ") << client.getSnapshotRenderMicros() << F("us"));
+    if (numLoadBoards < LOAD_GENERATOR_BOARDS) {
+      addLoadBoard();
+    }
+    lastReport = millis();
+  }
+#endif
+#ifdef EVENT_SERVER_PORT
+  eventServer.update();
+#endif
+  leds.update();
   delay(1);
 }
\ No newline at end of file
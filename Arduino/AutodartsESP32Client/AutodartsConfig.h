@@ -0,0 +1,236 @@
+#ifndef AutodartsConfig_h_
+#define AutodartsConfig_h_
+
+#include <FS.h>
+#include <stddef.h>
+
+#include "AutodartsCrc.h"
+#include "AutodartsDefines.h"
+
+namespace autodarts {
+
+  // Persistent settings in a compact binary file that is loaded directly
+  // into a struct. The file starts with a header carrying magic, layout
+  // version, payload size and a CRC32 of the payload. Saving writes a
+  // temporary file and renames it over the old one, so a power loss leaves
+  // either the old or the new settings behind.
+  //
+  // Fields are only ever appended to Data. Files written by an older version
+  // are loaded up to their size, newer fields keep their defaults.
+  class Config {
+  public:
+    static const uint32_t MAGIC       = 0x43444441; // "ADDC"
+    static const uint16_t VERSION     = 1;
+    static const uint8_t  MAX_BOARDS  = 8;
+
+    struct CachedBoard {
+      char name[32];
+      char id[40];
+      char version[16];
+      char url[48];
+    };
+
+    struct Data {
+      char     username[41] = "";
+      char     password[21] = "";
+      uint16_t reconnectInterval = 5000;
+      uint32_t aliveTimeout = 10000;
+      uint8_t  numBoards = 0;
+      CachedBoard boards[MAX_BOARDS] = {};
+    };
+
+    Config() = default;
+
+    Config(const char* path) :
+      _path(path) {
+
+    }
+
+    Data& data() {
+      return _data;
+    }
+
+    const Data& data() const {
+      return _data;
+    }
+
+    // Loads the settings, falls back to the temporary file if a save was
+    // interrupted between removing the old file and renaming the new one
+    bool load(fs::FS& fs) {
+      uint32_t start = micros();
+      bool ret = read(fs, _path) || read(fs, tempPath());
+      _loadMicros = micros() - start;
+      return ret;
+    }
+
+    bool save(fs::FS& fs) const {
+      String temp = tempPath();
+      fs::File file = fs.open(temp, FILE_WRITE);
+      if (!file) {
+        LOG_ERROR("Config", F("Could not open ") << temp << F(" for writing!"));
+        return false;
+      }
+
+      Header header;
+      header.magic   = MAGIC;
+      header.version = VERSION;
+      header.size    = sizeof(Data);
+      header.crc     = crc32(reinterpret_cast<const uint8_t*>(&_data), sizeof(Data));
+      bool ok = file.write(reinterpret_cast<const uint8_t*>(&header), sizeof(header)) == sizeof(header)
+             && file.write(reinterpret_cast<const uint8_t*>(&_data), sizeof(Data)) == sizeof(Data);
+      file.close();
+      if (!ok) {
+        LOG_ERROR("Config", F("Could not write ") << temp);
+        fs.remove(temp);
+        return false;
+      }
+
+      // Not every file system renames over an existing file
+      fs.remove(_path);
+      if (!fs.rename(temp, _path)) {
+        LOG_ERROR("Config", F("Could not rename ") << temp << F(" to ") << _path);
+        return false;
+      }
+      return true;
+    }
+
+    // Imports credentials from the JSON file of earlier firmware and removes it
+    bool migrate(fs::FS& fs, const char* legacyPath = "/autodarts_config.json") {
+      if (!fs.exists(legacyPath)) {
+        return false;
+      }
+      fs::File file = fs.open(legacyPath, FILE_READ);
+      if (!file) {
+        return false;
+      }
+      DynamicJsonDocument json(256);
+      DeserializationError err = deserializeJson(json, file);
+      file.close();
+      if (err) {
+        LOG_ERROR("Config", F("Could not read legacy config: ") << err.c_str());
+        return false;
+      }
+
+      // The legacy file is kept if its credentials cannot be taken over
+      if (!setCredentials(json["autodarts_username"] | "", json["autodarts_password"] | "") || !save(fs)) {
+        return false;
+      }
+      fs.remove(legacyPath);
+      LOG_INFO("Config", F("Migrated ") << legacyPath << F(" to ") << _path);
+      return true;
+    }
+
+    // Credentials that do not fit are rejected, a truncated password would
+    // only fail later at the login
+    bool setCredentials(const char* username, const char* password) {
+      if (!fits(username, sizeof(_data.username)) || !fits(password, sizeof(_data.password))) {
+        LOG_ERROR("Config", F("Credentials too long, at most ") << sizeof(_data.username) - 1
+                            << F(" characters username and ") << sizeof(_data.password) - 1 << F(" password"));
+        return false;
+      }
+      copy(_data.username, username, sizeof(_data.username));
+      copy(_data.password, password, sizeof(_data.password));
+      return true;
+    }
+
+    // Remembers boards, so they can be opened before autodarts.io answers.
+    // Returns false if the cached boards did not change, so saving can be
+    // skipped. Boards whose id or url do not fit are not cached, a
+    // truncated one would open the wrong board; names and versions are
+    // only shown until autodarts.io answers and are truncated. Boards past
+    // MAX_BOARDS are not cached either.
+    template<typename TBoardArray>
+    bool setBoards(const TBoardArray& boards) {
+      uint8_t numBoards = 0;
+      uint8_t numSkipped = 0;
+      CachedBoard cachedBoards[MAX_BOARDS] = {};
+      for (const auto& board : boards) {
+        if (!fits(board->getId().c_str(), sizeof(CachedBoard::id)) || !fits(board->getUrl().c_str(), sizeof(CachedBoard::url))) {
+          LOG_WARNING("Config", F("Not caching board ") << board->getName() << F(", id or url too long"));
+          continue;
+        }
+        if (numBoards >= MAX_BOARDS) {
+          numSkipped++;
+          continue;
+        }
+        CachedBoard& cached = cachedBoards[numBoards++];
+        copy(cached.name,    board->getName().c_str(),    sizeof(cached.name));
+        copy(cached.id,      board->getId().c_str(),      sizeof(cached.id));
+        copy(cached.version, board->getVersion().c_str(), sizeof(cached.version));
+        copy(cached.url,     board->getUrl().c_str(),     sizeof(cached.url));
+      }
+      if (numSkipped) {
+        LOG_WARNING("Config", F("Caching only ") << MAX_BOARDS << F(" boards, ") << numSkipped << F(" not cached"));
+      }
+      if (numBoards == _data.numBoards && memcmp(cachedBoards, _data.boards, numBoards*sizeof(CachedBoard)) == 0) {
+        return false;
+      }
+      _data.numBoards = numBoards;
+      memcpy(_data.boards, cachedBoards, sizeof(cachedBoards));
+      return true;
+    }
+
+    uint32_t getLoadMicros() const {
+      return _loadMicros;
+    }
+
+  private:
+    struct Header {
+      uint32_t magic;
+      uint16_t version;
+      uint16_t size;
+      uint32_t crc;
+    };
+
+    bool read(fs::FS& fs, const String& path) {
+      fs::File file = fs.open(path, FILE_READ);
+      if (!file) {
+        return false;
+      }
+
+      Header header;
+      if (file.read(reinterpret_cast<uint8_t*>(&header), sizeof(header)) != sizeof(header)
+          || header.magic != MAGIC || header.version > VERSION || header.size > sizeof(Data)) {
+        LOG_ERROR("Config", F("Invalid config header in ") << path);
+        return false;
+      }
+
+      Data data;
+      if (file.read(reinterpret_cast<uint8_t*>(&data), header.size) != header.size
+          || crc32(reinterpret_cast<const uint8_t*>(&data), header.size) != header.crc) {
+        LOG_ERROR("Config", F("Config checksum mismatch in ") << path);
+        return false;
+      }
+      // Older layouts may hold fewer boards than they count
+      size_t storedBoards = header.size > offsetof(Data, boards) ? (header.size - offsetof(Data, boards)) / sizeof(CachedBoard) : 0;
+      if (data.numBoards > MAX_BOARDS) {
+        data.numBoards = 0;
+      }
+      if (data.numBoards > storedBoards) {
+        data.numBoards = storedBoards;
+      }
+      _data = data;
+      return true;
+    }
+
+    String tempPath() const {
+      return _path + F(".tmp");
+    }
+
+    static bool fits(const char* source, size_t size) {
+      return !source || strlen(source) < size;
+    }
+
+    static void copy(char* target, const char* source, size_t size) {
+      strncpy(target, source ? source : "", size - 1);
+      target[size - 1] = '\0';
+    }
+
+    String   _path = "/autodarts.cfg";
+    Data     _data;
+    uint32_t _loadMicros = 0;
+  };
+
+} // autodarts
+
+#endif // AutodartsConfig_h_
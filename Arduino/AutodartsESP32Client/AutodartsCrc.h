@@ -0,0 +1,30 @@
+#ifndef AutodartsCrc_h_
+#define AutodartsCrc_h_
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace autodarts {
+
+  // CRC32 (IEEE) with a nibble table, small enough to live in flash. Calls
+  // can be chained by passing the previous result, start with 0.
+  inline uint32_t crc32(uint32_t crc, const uint8_t* data, size_t length) {
+    static const uint32_t table[16] = {
+      0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac, 0x76dc4190, 0x6b6b51f4, 0x4db26158, 0x5005713c,
+      0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c, 0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c,
+    };
+    crc = ~crc;
+    for (size_t idx = 0; idx < length; idx++) {
+      crc = table[(crc ^ data[idx]) & 0x0f] ^ (crc >> 4);
+      crc = table[(crc ^ (data[idx] >> 4)) & 0x0f] ^ (crc >> 4);
+    }
+    return ~crc;
+  }
+
+  inline uint32_t crc32(const uint8_t* data, size_t length) {
+    return crc32(0, data, length);
+  }
+
+} // autodarts
+
+#endif // AutodartsCrc_h_
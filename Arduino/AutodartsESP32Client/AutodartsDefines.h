@@ -2,148 +2,76 @@
 #define AutodartsDefines_h_
 
 #define LOG_FORMATTING LOG_FORMATTING_NOTIME
+// EasyLogger drops levels above LOG_LEVEL at compile time, arguments of
+// disabled log statements are never evaluated. Define it before including
+// the client to silence debug output, e.g. LOG_LEVEL_INFO.
+#ifndef LOG_LEVEL
 #define LOG_LEVEL LOG_LEVEL_DEBUG
+#endif
 #include <EasyLogger.h>
+#include <ArduinoJson.h>
 
-namespace autodarts {
-
-  class Board;
-
-  struct Status {
-    enum class Code : int8_t {
-      UNKNOWN          =  -1,
-      STOPPED          =   0,
-      STARTING         =   2,
-      THROW            =   8,
-      TAKEOUT          =   16,
-      TAKEOUT_PROGRESS =   32,
-    };
-
-    Status(Code value) {
-      _value = value;
-    }
-
-    Status(int8_t value) {
-      _value = static_cast<Code>(value);
-    }
-
-    Status& operator=(const Code& value) {
-      _value = value;
-      return *this;
-    }
-
-    Status& operator=(int8_t value) {
-      _value = static_cast<Code>(value);
-      return *this;
-    }
-
-    Code value() const  {
-      return _value;
-    }
+#include "AutodartsEvents.h"
 
-    void value(Code value) {
-      _value = value;
-    }
+// Define AUTODARTS_MAX_BOARDS to make Client::addBoard() reject boards
+// beyond a fixed count, by default only the heap limits the board count
 
-    static String toString(Code value) {
-      switch (value) {
-        case Code::STOPPED:          return F("Stopped");
-        case Code::STARTING:         return F("Starting");
-        case Code::THROW:            return F("Throw");
-        case Code::TAKEOUT:          return F("Takeout");
-        case Code::TAKEOUT_PROGRESS: return F("Takeout in progress");
-        default:                     return F("Unknown");
-      }
-    }
+#ifndef AUTODARTS_NUM_CAMERAS
+#define AUTODARTS_NUM_CAMERAS 3
+#endif
 
-    String toString() const {
-      return toString(_value);
-    }
+#ifndef AUTODARTS_MAX_THROWS
+#define AUTODARTS_MAX_THROWS 3
+#endif
 
-    static Code fromString(const String& value) {
-      if      (value == F("Stopped"))             return Code::STOPPED;
-      else if (value == F("Starting"))            return Code::STARTING;
-      else if (value == F("Throw"))               return Code::THROW;
-      else if (value == F("Takeout"))             return Code::TAKEOUT;
-      else if (value == F("Takeout in progress")) return Code::TAKEOUT_PROGRESS;
-      else                                        return Code::UNKNOWN;
-    }
+#ifndef AUTODARTS_HEATMAP_SIZE
+#define AUTODARTS_HEATMAP_SIZE 16
+#endif
 
-  private:
-    Code _value = Code::UNKNOWN;
-  };
+#ifndef AUTODARTS_STATE_QUEUE_SIZE
+#define AUTODARTS_STATE_QUEUE_SIZE 4
+#endif
 
-  struct Event {
-    enum class Code : int8_t {
-      UNKNOWN          =  -1,
-      STOPPED          =   0,
-      STOPPING         =   1,
-      STARTING         =   2,
-      STARTED          =   4,
-      THROW_DETECTED   =   8,
-      TAKEOUT_STARTED  =  16,
-      TAKEOUT_FINISHED =  32,
-      RESET            =  64,
-    };
-
-    Event(Code value) {
-      _value = value;
-    }
+// Upper bound the snapshot document may grow to, in bytes
+#ifndef AUTODARTS_SNAPSHOT_MAX_SIZE
+#define AUTODARTS_SNAPSHOT_MAX_SIZE 32768
+#endif
 
-    Event(int8_t value) {
-      _value = static_cast<Code>(value);
-    }
+#ifndef AUTODARTS_LOAD_TEST_LATE_MS
+#define AUTODARTS_LOAD_TEST_LATE_MS 100
+#endif
 
-    Event& operator=(const Code& value) {
-      _value = value;
-      return *this;
-    }
+namespace autodarts {
 
-    Event& operator=(int8_t value) {
-      _value = static_cast<Code>(value);
-      return *this;
-    }
+  class Board;
 
-    Code value() const  {
-      return _value;
-    }
+  struct Throw {
+    int8_t number     = -1;  // 1-20, 25 for bull, 0 for a miss
+    int8_t multiplier =  0;  // 0 for a miss, 1-3 otherwise
+    float  x          =  0;
+    float  y          =  0;
 
-    void value(Code value) {
-      _value = value;
+    int16_t score() const {
+      return number > 0 ? number * multiplier : 0;
     }
 
-    static String toString(Code value) {
-      switch (value) {
-        case Code::STOPPED:          return F("Stopped");
-        case Code::STOPPING:         return F("Stopping");
-        case Code::STARTING:         return F("Starting");
-        case Code::STARTED:          return F("Started");
-        case Code::THROW_DETECTED:   return F("Throw detected");
-        case Code::TAKEOUT_STARTED:  return F("Takeout started");
-        case Code::TAKEOUT_FINISHED: return F("Takeout finished");
-        case Code::RESET:            return F("Manual reset");
-        default:                     return F("Unknown");
-      }
+    bool isDouble() const {
+      return multiplier == 2;
     }
 
-    String toString() const {
-      return toString(_value);
+    void fromJson(const JsonObjectConst& root) {
+      number     = root["segment"]["number"] | -1;
+      multiplier = root["segment"]["multiplier"] | 0;
+      x          = root["coords"]["x"] | 0.0f;
+      y          = root["coords"]["y"] | 0.0f;
     }
 
-    static Code fromString(const String& value) {
-      if      (value == F("Stopped"))             return Code::STOPPED;
-      else if (value == F("Stopping"))            return Code::STOPPING;
-      else if (value == F("Starting"))            return Code::STARTING;
-      else if (value == F("Started"))             return Code::STARTED;
-      else if (value == F("Throw detected"))      return Code::THROW_DETECTED;
-      else if (value == F("Takeout started"))     return Code::TAKEOUT_STARTED;
-      else if (value == F("Takeout finished"))    return Code::TAKEOUT_FINISHED;
-      else if (value == F("Manual reset"))        return Code::RESET;
-      else                                        return Code::UNKNOWN;
+    void toJson(JsonObject& root) const {
+      root["number"]     = number;
+      root["multiplier"] = multiplier;
+      root["x"]          = x;
+      root["y"]          = y;
     }
-
-  private:
-    Code _value = Code::UNKNOWN;
   };
 
   enum class State : int8_t {
@@ -159,6 +87,8 @@ namespace autodarts {
   typedef std::function<void(const String& boardName, const String& boardId, State connected, State running, int16_t numThrows)>    DetectionStateCallback;
   typedef std::function<void(const String& boardName, const String& boardId, Status::Code status, Event::Code event)>               DetectionEventCallback;
   typedef std::function<void(const String& boardName, const String& boardId, bool connected)>                                       BoardConnectionCallback;
+  typedef std::function<void(const String& boardName, const String& boardId, const char* payload, size_t length)>                   BoardMessageCallback;
+  typedef std::function<void(const String& boardName, const String& boardId, const Throw& dart, int16_t numThrows)>                  ThrowCallback;
 
   static const char* AUTODARTS_URL                   = "https://autodarts.io";
   static const char* AUTODARTS_AUTH_KEYCLOAK_URL     = "https://login.autodarts.io/realms/autodarts/protocol/openid-connect/token";
@@ -168,6 +98,14 @@ namespace autodarts {
   static const char* AUTODARTS_API_TICKET_URL        = "https://api.autodarts.io/ms/v0/ticket";
   static const char* AUTODARTS_WS_SECURE_URL         = "ws://api.autodarts.io/ms/v0/subscribe?ticket=";
   static const char* AUTODARTS_WS_LOCAL_URL          = "ws://%s/api/events";
+  static const char* AUTODARTS_WS_SUBSCRIBE_REQUEST  = "{\"channel\":\"autodarts.boards\",\"type\":\"subscribe\",\"topic\":\"%s.%s\"}";
+  static const char* AUTODARTS_WS_BOARD_TOPICS[]     = {"state", "stats", "cam_state", "cam_stats"};
+  static const char* AUTODARTS_DISCOVERY_REQUEST     = "GET /api/events HTTP/1.1\r\nHost: %s:%u\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                                                       "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\nSec-WebSocket-Version: 13\r\n\r\n";
+  // Ids of discovered boards until autodarts.io reports the real id
+  static const char* AUTODARTS_DISCOVERY_ID_PREFIX   = "lan-";
+
+  static const uint32_t AUTODARTS_CLOUD_RECONNECT_INTERVAL = 5000;
 };
 
 #endif // AutodartsDefines_h_
@@ -6,23 +6,28 @@
 
 #include "AutodartsDefines.h"
 #include "AutodartsCameras.h"
+#include "AutodartsCheckout.h"
+#include "AutodartsSegments.h"
+#include "AutodartsTiming.h"
 
 namespace autodarts {
 
+  typedef HeatmapT<AUTODARTS_HEATMAP_SIZE> Heatmap;
+
   class Detector {
   public:
     Detector() = delete;
 
     Detector(const String& boardName, const String& boardId) :
-      _boardName(boardName), _boardId(boardId), _cameraSystem(boardName, boardId) {
+      _cameraSystem(boardName, boardId), _boardName(boardName), _boardId(boardId) {
 
     }
 
-    String getBoardId() const {
+    const String& getBoardId() const {
       return _boardId;
     }
 
-    String getBoardName() const {
+    const String& getBoardName() const {
       return _boardName;
     }
 
@@ -58,25 +63,101 @@ namespace autodarts {
       return _event;
     }
 
+    uint8_t getNumStoredThrows() const {
+      return _numStoredThrows;
+    }
+
+    const Throw& getThrow(uint8_t idx) const {
+      return _throws[idx];
+    }
+
+    // Checkout of the current visit, kept up to date while a match of the
+    // board is tracked, see Checkout for the encoding
+    uint32_t getCheckout() const {
+      return _checkout;
+    }
+
+    void setCheckout(uint32_t checkout) {
+      _checkout = checkout;
+    }
+
+    const Heatmap& getHeatmap() const {
+      return _heatmap;
+    }
+
+    void resetHeatmap() {
+      _heatmap.reset();
+    }
+
+    // Durations between throws of a visit, from takeout start to finish and
+    // from a manual reset until the board left STARTING, in milliseconds
+    struct Timings {
+      TimingHistogram throwInterval;
+      TimingHistogram takeoutDuration;
+      TimingHistogram resetRecovery;
+    };
+
+    const Timings& getTimings() const {
+      return _timings;
+    }
+
+    void resetTimings() {
+      _timings.throwInterval.reset();
+      _timings.takeoutDuration.reset();
+      _timings.resetRecovery.reset();
+    }
+
     CameraSystem& getCameraSystem() {
       return _cameraSystem;
     }
 
+    const CameraSystem& getCameraSystem() const {
+      return _cameraSystem;
+    }
+
     void fromJson(const JsonObjectConst& root) {
       if (root["type"] == "state") {
         _wasConnected = _isConnected;
         _wasRunning   = _isRunning;
 
+        int16_t previousThrows = _numThrows;
+        Event::Code previousEvent = _event.value();
+
         _isConnected = root["data"]["connected"];
         _isRunning   = root["data"]["running"];
         _numThrows   = root["data"]["numThrows"];
-        _status.fromString(root["data"]["status"]);
-        _event.fromString(root["data"]["event"]);
+        _status = Status::fromString(root["data"]["status"].as<const char*>());
+        _event  = Event::fromString(root["data"]["event"].as<const char*>());
+
+        _numStoredThrows = 0;
+        for (JsonObjectConst dart : root["data"]["throws"].as<JsonArrayConst>()) {
+          if (_numStoredThrows >= AUTODARTS_MAX_THROWS) {
+            break;
+          }
+          // Throws without a segment are classified from their coordinates
+          Throw& stored = _throws[_numStoredThrows++];
+          stored.fromJson(dart);
+          if (stored.number < 0) {
+            segments::classify(stored.x, stored.y, stored.number, stored.multiplier);
+          }
+        }
+
+        updateTimings(previousEvent, previousThrows);
 
         State connected = static_cast<State>(2*_isConnected - _wasConnected);
         State running   = static_cast<State>(2*_isRunning   - _wasRunning);
         _onDetectionStateCallback(_boardName, _boardId, connected, running, _numThrows);
         _onDetectionEventCallback(_boardName, _boardId, _status.value(), _event.value());
+
+        // Report throws added since the last state, throws present on the
+        // first state after connecting are not reported
+        if (previousThrows >= 0) {
+          for (int16_t idx = previousThrows; idx < _numThrows && idx < _numStoredThrows; idx++) {
+            const Throw& dart = _throws[idx];
+            _heatmap.add(dart.x, dart.y, dart.number, dart.multiplier);
+            _onThrowCallback(_boardName, _boardId, dart, idx + 1);
+          }
+        }
       }
       else if (root["type"] == "stats") {
         _fps    = root["data"]["fps"];
@@ -97,8 +178,8 @@ namespace autodarts {
       JsonObject data = root.createNestedObject("data");
       data["connected"] = _isConnected;
       data["running"]   = _isRunning;
-      data["status"]    = _status.toString();
-      data["event"]     = _event.toString();
+      data["status"]    = _status.toCString();
+      data["event"]     = _event.toCString();
       data["numThrows"] = _numThrows;
       root["type"]      = "state";
     }
@@ -125,7 +206,50 @@ namespace autodarts {
       _onDetectionEventCallback = callback;
     }
 
+    void onThrow(ThrowCallback callback) {
+      _onThrowCallback = callback;
+    }
+
   private:
+    void updateTimings(Event::Code previousEvent, int16_t previousThrows) {
+      uint32_t now = millis();
+      Event::Code event = _event.value();
+
+      if (previousThrows >= 0 && _numThrows > previousThrows) {
+        if (_lastThrowMillis) {
+          _timings.throwInterval.add(now - _lastThrowMillis);
+        }
+        _lastThrowMillis = now;
+      }
+
+      if (event != previousEvent) {
+        switch (event) {
+          case Event::Code::TAKEOUT_STARTED:
+            _takeoutMillis = now;
+            break;
+          case Event::Code::TAKEOUT_FINISHED:
+            if (_takeoutMillis) {
+              _timings.takeoutDuration.add(now - _takeoutMillis);
+              _takeoutMillis = 0;
+            }
+            // The next visit starts a new throw interval
+            _lastThrowMillis = 0;
+            break;
+          case Event::Code::RESET:
+            _resetMillis = now;
+            _lastThrowMillis = 0;
+            break;
+          default:
+            break;
+        }
+      }
+
+      if (_resetMillis && event != Event::Code::RESET && _status.value() != Status::Code::STARTING) {
+        _timings.resetRecovery.add(now - _resetMillis);
+        _resetMillis = 0;
+      }
+    }
+
     CameraSystem _cameraSystem;
     
     const String& _boardName, _boardId;
@@ -142,11 +266,22 @@ namespace autodarts {
     Status _status = Status::Code::UNKNOWN;
     Event _event = Event::Code::UNKNOWN;
 
+    Throw   _throws[AUTODARTS_MAX_THROWS];
+    uint8_t _numStoredThrows = 0;
+    uint32_t _checkout = 0;
+    Heatmap _heatmap;
+
+    Timings  _timings;
+    uint32_t _lastThrowMillis = 0;
+    uint32_t _takeoutMillis = 0;
+    uint32_t _resetMillis = 0;
+
     CameraStatsCallback       _onCameraStatsCallback       = [](const String&, const String&, int8_t, int8_t, int16_t, int16_t){};
     CameraSystemStateCallback _onCameraSystemStateCallback = [](const String&, const String&, State, State){};
     DetectionStatsCallback    _onDetectionStatsCallback    = [](const String&, const String&, int8_t, int16_t, int16_t){};
     DetectionStateCallback    _onDetectionStateCallback    = [](const String&, const String&, State, State,  int16_t){};
     DetectionEventCallback    _onDetectionEventCallback    = [](const String&, const String&, Status::Code, Event::Code){};
+    ThrowCallback             _onThrowCallback             = [](const String&, const String&, const Throw&, int16_t){};
   };
 
 } // autodarts
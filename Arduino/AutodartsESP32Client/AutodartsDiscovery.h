@@ -0,0 +1,243 @@
+#ifndef AutodartsDiscovery_h_
+#define AutodartsDiscovery_h_
+
+#include <IPAddress.h>
+#include <lwip/sockets.h>
+#include <errno.h>
+#include <unistd.h>
+#include <functional>
+
+#include "AutodartsDefines.h"
+
+namespace autodarts {
+
+  typedef std::function<void(const IPAddress& address, uint16_t port)> DiscoveryCallback;
+
+  // Finds boards on the local network without the autodarts.io API. Every
+  // host of the subnet is probed with a websocket upgrade of /api/events on
+  // the board port. Probes use non-blocking sockets, at most maxProbes are in
+  // flight and each gives up after the timeout, so update() never blocks the
+  // loop. Subnets larger than a /24 are limited to the /24 of the local
+  // address.
+  class Discovery {
+  public:
+    static const uint8_t MAX_PROBES = 16;
+
+    Discovery() = default;
+    Discovery(const Discovery&) = delete;
+
+    ~Discovery() {
+      stop();
+    }
+
+    bool begin(const IPAddress& local, const IPAddress& subnet, uint16_t port = 3180, uint8_t maxProbes = 8, uint16_t timeout = 300) {
+      stop();
+      uint32_t address = ntohl(static_cast<uint32_t>(local));
+      uint32_t mask    = ntohl(static_cast<uint32_t>(subnet)) | 0xffffff00;
+
+      _local     = address;
+      _next      = (address & mask) + 1;
+      _last      = (address | ~mask) - 1;
+      _port      = port;
+      _maxProbes = maxProbes < MAX_PROBES ? maxProbes : MAX_PROBES;
+      _timeout   = timeout;
+      _numFound  = 0;
+      _start     = millis();
+      _running   = true;
+      LOG_INFO("Discovery", F("Probing ") << IPAddress(htonl(_next)).toString() << F(" - ") << IPAddress(htonl(_last)).toString() << F(" on port ") << port);
+      return true;
+    }
+
+    void stop() {
+      for (Probe& probe : _probes) {
+        closeProbe(probe);
+      }
+      _running = false;
+    }
+
+    bool isRunning() const {
+      return _running;
+    }
+
+    uint8_t getNumFound() const {
+      return _numFound;
+    }
+
+    void onBoardFound(DiscoveryCallback callback) {
+      _onBoardFoundCallback = callback;
+    }
+
+    // Advances all probes, returns false once every host was probed
+    bool update() {
+      if (!_running) {
+        return false;
+      }
+
+      // Fill free slots with the next hosts. If no socket is available the
+      // host is probed again on a later update instead of being skipped.
+      for (Probe& probe : _probes) {
+        if (probe.fd < 0 && _next <= _last && numActive() < _maxProbes) {
+          // Intended: stop filling without advancing _next. Sockets are
+          // shared with the boards and the cloud connection, so none will
+          // free up during this update; the remaining slots wait for the
+          // running probes to finish.
+          if (_next != _local && !openProbe(probe, _next)) {
+            break;
+          }
+          _next++;
+        }
+      }
+
+      // Poll all probes at once without waiting
+      fd_set readSet, writeSet;
+      FD_ZERO(&readSet);
+      FD_ZERO(&writeSet);
+      int maxFd = -1;
+      for (Probe& probe : _probes) {
+        if (probe.fd >= 0) {
+          FD_SET(probe.fd, probe.state == Probe::CONNECTING ? &writeSet : &readSet);
+          maxFd = probe.fd > maxFd ? probe.fd : maxFd;
+        }
+      }
+      if (maxFd >= 0) {
+        timeval timeout = {0, 0};
+        if (select(maxFd + 1, &readSet, &writeSet, nullptr, &timeout) > 0) {
+          for (Probe& probe : _probes) {
+            if (probe.fd >= 0 && FD_ISSET(probe.fd, probe.state == Probe::CONNECTING ? &writeSet : &readSet)) {
+              advance(probe);
+            }
+          }
+        }
+      }
+
+      // Drop probes of hosts that did not answer in time
+      uint32_t now = millis();
+      for (Probe& probe : _probes) {
+        if (probe.fd >= 0 && (now - probe.start) >= _timeout) {
+          closeProbe(probe);
+        }
+      }
+
+      if (_next > _last && numActive() == 0) {
+        LOG_INFO("Discovery", F("Found ") << _numFound << F(" boards in ") << (millis() - _start) << F("ms"));
+        _running = false;
+      }
+      return _running;
+    }
+
+  private:
+    struct Probe {
+      enum State : uint8_t {
+        CONNECTING,
+        UPGRADING,
+      };
+      int      fd = -1;
+      uint32_t address = 0;
+      uint32_t start = 0;
+      State    state = CONNECTING;
+      // Status line of the response, which may arrive in several reads
+      char     response[24];
+      uint8_t  received = 0;
+    };
+
+    uint8_t numActive() const {
+      uint8_t count = 0;
+      for (const Probe& probe : _probes) {
+        count += probe.fd >= 0;
+      }
+      return count;
+    }
+
+    // Returns false if no socket could be created
+    bool openProbe(Probe& probe, uint32_t address) {
+      probe.fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+      if (probe.fd < 0) {
+        LOG_DEBUG("Discovery", F("No socket available, retrying ") << IPAddress(htonl(address)).toString());
+        return false;
+      }
+      fcntl(probe.fd, F_SETFL, fcntl(probe.fd, F_GETFL, 0) | O_NONBLOCK);
+
+      sockaddr_in target = {};
+      target.sin_family      = AF_INET;
+      target.sin_port        = htons(_port);
+      target.sin_addr.s_addr = htonl(address);
+      probe.address = address;
+      probe.start   = millis();
+      probe.state   = Probe::CONNECTING;
+      probe.received = 0;
+      if (connect(probe.fd, reinterpret_cast<sockaddr*>(&target), sizeof(target)) < 0 && errno != EINPROGRESS) {
+        closeProbe(probe);
+      }
+      return true;
+    }
+
+    void advance(Probe& probe) {
+      if (probe.state == Probe::CONNECTING) {
+        int err = 0;
+        socklen_t length = sizeof(err);
+        getsockopt(probe.fd, SOL_SOCKET, SO_ERROR, &err, &length);
+        if (err) {
+          closeProbe(probe);
+          return;
+        }
+        // Something listens on the port, check that it speaks the board websocket
+        char request[200];
+        int size = snprintf(request, sizeof(request), AUTODARTS_DISCOVERY_REQUEST, IPAddress(htonl(probe.address)).toString().c_str(), static_cast<unsigned>(_port));
+        if (send(probe.fd, request, size, 0) != size) {
+          closeProbe(probe);
+          return;
+        }
+        probe.state = Probe::UPGRADING;
+        return;
+      }
+
+      // Wait for the whole status line, or as much of it as fits
+      int length = recv(probe.fd, probe.response + probe.received, sizeof(probe.response) - 1 - probe.received, 0);
+      if (length < 0 && (errno == EWOULDBLOCK || errno == EAGAIN)) {
+        return;
+      }
+      if (length <= 0) {
+        closeProbe(probe);
+        return;
+      }
+      probe.received += length;
+      probe.response[probe.received] = '\0';
+      if (!strstr(probe.response, "\r\n") && probe.received < sizeof(probe.response) - 1) {
+        return;
+      }
+
+      if (strncmp(probe.response, "HTTP/1.1 101 ", 13) == 0) {
+        IPAddress address(htonl(probe.address));
+        LOG_INFO("Discovery", F("Found board at ") << address.toString() << ':' << _port);
+        _numFound++;
+        closeProbe(probe);
+        _onBoardFoundCallback(address, _port);
+        return;
+      }
+      closeProbe(probe);
+    }
+
+    void closeProbe(Probe& probe) {
+      if (probe.fd >= 0) {
+        close(probe.fd);
+        probe.fd = -1;
+      }
+    }
+
+    Probe    _probes[MAX_PROBES];
+    uint32_t _local = 0;
+    uint32_t _next = 0;
+    uint32_t _last = 0;
+    uint32_t _start = 0;
+    uint16_t _port = 3180;
+    uint16_t _timeout = 300;
+    uint8_t  _maxProbes = 8;
+    uint8_t  _numFound = 0;
+    bool     _running = false;
+
+    DiscoveryCallback _onBoardFoundCallback = [](const IPAddress&, uint16_t){};
+  };
+
+} // autodarts
+
+#endif // AutodartsDiscovery_h_
@@ -0,0 +1,209 @@
+#ifndef AutodartsEventServer_h_
+#define AutodartsEventServer_h_
+
+#include <WebSocketsServer.h>
+#include <lwip/sockets.h>
+#include <memory>
+#include <vector>
+
+#include "AutodartsDefines.h"
+
+namespace autodarts {
+
+  // Rebroadcasts board payloads to local subscribers, e.g. displays. Every
+  // payload is encoded once into a reference counted buffer which is shared
+  // by the queues of all subscribers.
+  //
+  // sendTXT() is synchronous, it returns once lwIP took the whole frame.
+  // update() therefore only sends to subscribers whose socket is writable;
+  // a display that stopped reading is skipped instead of stalling the loop
+  // for the client write timeout. Writable means lwIP has send buffer left,
+  // a frame larger than that may still block until the rest is taken. The
+  // send budget caps the frames per update() and the queue keeps publish()
+  // from ever touching a socket; skipped subscribers fall behind and are
+  // disconnected after maxDropped drops.
+  class EventServer {
+  public:
+    typedef std::shared_ptr<const std::vector<char>> MessagePtr;
+
+    EventServer(uint16_t port = 3181, uint8_t queueSize = 8, uint8_t sendBudget = 2) :
+      _server(port), _queueSize(queueSize), _sendBudget(sendBudget) {
+      for (Subscriber& subscriber : _subscribers) {
+        subscriber.queue.resize(_queueSize);
+      }
+    }
+
+    void begin() {
+      _server.onEvent([this](uint8_t num, WStype_t type, uint8_t* payload, size_t length) {
+        if (num >= WEBSOCKETS_SERVER_CLIENT_MAX) {
+          return;
+        }
+        switch(type) {
+          case WStype_CONNECTED: {
+            LOG_INFO("EventServer", F("Subscriber ") << num << F(" connected"));
+            _subscribers[num].reset();
+            _subscribers[num].connected = true;
+            break;
+          }
+          case WStype_DISCONNECTED: {
+            LOG_INFO("EventServer", F("Subscriber ") << num << F(" disconnected"));
+            _subscribers[num].reset();
+            break;
+          }
+          default:
+            break;
+        }
+      });
+      _server.begin();
+    }
+
+    void publish(const String& boardName, const String& boardId, const char* payload, size_t length) {
+      if (getNumSubscribers() == 0) {
+        return;
+      }
+
+      // Encode once as {"board":"<id>","event":<payload>}
+      static const char prefix[] = "{\"board\":\"";
+      static const char infix[]  = "\",\"event\":";
+      std::shared_ptr<std::vector<char>> message = std::make_shared<std::vector<char>>();
+      message->reserve(sizeof(prefix) + boardId.length() + sizeof(infix) + length);
+      message->insert(message->end(), prefix, prefix + sizeof(prefix) - 1);
+      message->insert(message->end(), boardId.c_str(), boardId.c_str() + boardId.length());
+      message->insert(message->end(), infix, infix + sizeof(infix) - 1);
+      message->insert(message->end(), payload, payload + length);
+      message->push_back('}');
+
+      MessagePtr shared(message);
+      for (uint8_t num = 0; num < WEBSOCKETS_SERVER_CLIENT_MAX; num++) {
+        _subscribers[num].push(shared, _queueSize);
+      }
+    }
+
+    void update() {
+      _server.loop();
+
+      for (uint8_t num = 0; num < WEBSOCKETS_SERVER_CLIENT_MAX; num++) {
+        Subscriber& subscriber = _subscribers[num];
+        if (!subscriber.connected) {
+          continue;
+        }
+
+        // Drop subscribers that cannot keep up instead of buffering unbounded
+        if (subscriber.dropped >= _maxDropped) {
+          LOG_WARNING("EventServer", F("Subscriber ") << num << F(" too slow, disconnecting"));
+          _server.disconnect(num);
+          subscriber.reset();
+          continue;
+        }
+
+        if (subscriber.count == 0 || !_server.isWritable(num)) {
+          continue;
+        }
+        for (uint8_t sent = 0; sent < _sendBudget && subscriber.count > 0; sent++) {
+          const MessagePtr& message = subscriber.front();
+          if (!_server.sendTXT(num, reinterpret_cast<const uint8_t*>(message->data()), message->size())) {
+            break;
+          }
+          subscriber.pop(_queueSize);
+          // Caught up, forget the drops of the last backlog
+          if (subscriber.count == 0) {
+            subscriber.dropped = 0;
+          }
+        }
+      }
+    }
+
+    uint8_t getNumSubscribers() const {
+      uint8_t count = 0;
+      for (const Subscriber& subscriber : _subscribers) {
+        count += subscriber.connected;
+      }
+      return count;
+    }
+
+    uint32_t getDropped(uint8_t num) const {
+      return num < WEBSOCKETS_SERVER_CLIENT_MAX ? _subscribers[num].totalDropped : 0;
+    }
+
+    void setMaxDropped(uint16_t maxDropped) {
+      _maxDropped = maxDropped;
+    }
+
+  private:
+    // The library keeps the sockets of its clients to itself
+    class Server : public WebSocketsServer {
+    public:
+      Server(uint16_t port) :
+        WebSocketsServer(port) {
+
+      }
+
+      // Polls the socket without waiting, subscribers without one are
+      // left to sendTXT()
+      bool isWritable(uint8_t num) {
+        WiFiClient* tcp = _clients[num].tcp;
+        int fd = tcp ? tcp->fd() : -1;
+        if (fd < 0) {
+          return true;
+        }
+        fd_set writeSet;
+        FD_ZERO(&writeSet);
+        FD_SET(fd, &writeSet);
+        timeval timeout = {0, 0};
+        return select(fd + 1, nullptr, &writeSet, nullptr, &timeout) > 0;
+      }
+    };
+
+    struct Subscriber {
+      std::vector<MessagePtr> queue;
+      uint8_t  head = 0;
+      uint8_t  count = 0;
+      uint16_t dropped = 0;
+      uint32_t totalDropped = 0;
+      bool     connected = false;
+
+      void push(const MessagePtr& message, uint8_t size) {
+        if (!connected) {
+          return;
+        }
+        // Queue full, drop oldest message
+        if (count == size) {
+          pop(size);
+          dropped++;
+          totalDropped++;
+        }
+        queue[(head + count) % size] = message;
+        count++;
+      }
+
+      const MessagePtr& front() const {
+        return queue[head];
+      }
+
+      void pop(uint8_t size) {
+        queue[head].reset();
+        head = (head + 1) % size;
+        count--;
+      }
+
+      void reset() {
+        for (MessagePtr& message : queue) {
+          message.reset();
+        }
+        head = 0;
+        count = 0;
+        dropped = 0;
+        connected = false;
+      }
+    };
+
+    Server _server;
+    Subscriber _subscribers[WEBSOCKETS_SERVER_CLIENT_MAX];
+    uint8_t  _queueSize;
+    uint8_t  _sendBudget;
+    uint16_t _maxDropped = 64;
+  };
+
+} // autodarts
+
+#endif // AutodartsEventServer_h_
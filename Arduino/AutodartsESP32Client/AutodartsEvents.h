@@ -0,0 +1,177 @@
+#ifndef AutodartsEvents_h_
+#define AutodartsEvents_h_
+
+#include <Arduino.h>
+#include <string.h>
+
+namespace autodarts {
+
+  // Detection status and events as reported by the board. Kept apart from
+  // AutodartsDefines.h, so consumers that need only the codes build without
+  // the logging and JSON libraries.
+  struct Status {
+    enum class Code : int8_t {
+      UNKNOWN          =  -1,
+      STOPPED          =   0,
+      STARTING         =   2,
+      THROW            =   8,
+      TAKEOUT          =   16,
+      TAKEOUT_PROGRESS =   32,
+    };
+
+    Status(Code value) {
+      _value = value;
+    }
+
+    Status(int8_t value) {
+      _value = static_cast<Code>(value);
+    }
+
+    Status& operator=(const Code& value) {
+      _value = value;
+      return *this;
+    }
+
+    Status& operator=(int8_t value) {
+      _value = static_cast<Code>(value);
+      return *this;
+    }
+
+    Code value() const  {
+      return _value;
+    }
+
+    void value(Code value) {
+      _value = value;
+    }
+
+    static const char* toCString(Code value) {
+      switch (value) {
+        case Code::STOPPED:          return "Stopped";
+        case Code::STARTING:         return "Starting";
+        case Code::THROW:            return "Throw";
+        case Code::TAKEOUT:          return "Takeout";
+        case Code::TAKEOUT_PROGRESS: return "Takeout in progress";
+        default:                     return "Unknown";
+      }
+    }
+
+    static String toString(Code value) {
+      return String(toCString(value));
+    }
+
+    const char* toCString() const {
+      return toCString(_value);
+    }
+
+    String toString() const {
+      return toString(_value);
+    }
+
+    static Code fromString(const char* value) {
+      if      (value == nullptr)                          return Code::UNKNOWN;
+      else if (strcmp(value, "Stopped") == 0)             return Code::STOPPED;
+      else if (strcmp(value, "Starting") == 0)            return Code::STARTING;
+      else if (strcmp(value, "Throw") == 0)               return Code::THROW;
+      else if (strcmp(value, "Takeout") == 0)             return Code::TAKEOUT;
+      else if (strcmp(value, "Takeout in progress") == 0) return Code::TAKEOUT_PROGRESS;
+      else                                                return Code::UNKNOWN;
+    }
+
+    static Code fromString(const String& value) {
+      return fromString(value.c_str());
+    }
+
+  private:
+    Code _value = Code::UNKNOWN;
+  };
+
+  struct Event {
+    enum class Code : int8_t {
+      UNKNOWN          =  -1,
+      STOPPED          =   0,
+      STOPPING         =   1,
+      STARTING         =   2,
+      STARTED          =   4,
+      THROW_DETECTED   =   8,
+      TAKEOUT_STARTED  =  16,
+      TAKEOUT_FINISHED =  32,
+      RESET            =  64,
+    };
+
+    Event(Code value) {
+      _value = value;
+    }
+
+    Event(int8_t value) {
+      _value = static_cast<Code>(value);
+    }
+
+    Event& operator=(const Code& value) {
+      _value = value;
+      return *this;
+    }
+
+    Event& operator=(int8_t value) {
+      _value = static_cast<Code>(value);
+      return *this;
+    }
+
+    Code value() const  {
+      return _value;
+    }
+
+    void value(Code value) {
+      _value = value;
+    }
+
+    static const char* toCString(Code value) {
+      switch (value) {
+        case Code::STOPPED:          return "Stopped";
+        case Code::STOPPING:         return "Stopping";
+        case Code::STARTING:         return "Starting";
+        case Code::STARTED:          return "Started";
+        case Code::THROW_DETECTED:   return "Throw detected";
+        case Code::TAKEOUT_STARTED:  return "Takeout started";
+        case Code::TAKEOUT_FINISHED: return "Takeout finished";
+        case Code::RESET:            return "Manual reset";
+        default:                     return "Unknown";
+      }
+    }
+
+    static String toString(Code value) {
+      return String(toCString(value));
+    }
+
+    const char* toCString() const {
+      return toCString(_value);
+    }
+
+    String toString() const {
+      return toString(_value);
+    }
+
+    static Code fromString(const char* value) {
+      if      (value == nullptr)                       return Code::UNKNOWN;
+      else if (strcmp(value, "Stopped") == 0)          return Code::STOPPED;
+      else if (strcmp(value, "Stopping") == 0)         return Code::STOPPING;
+      else if (strcmp(value, "Starting") == 0)         return Code::STARTING;
+      else if (strcmp(value, "Started") == 0)          return Code::STARTED;
+      else if (strcmp(value, "Throw detected") == 0)   return Code::THROW_DETECTED;
+      else if (strcmp(value, "Takeout started") == 0)  return Code::TAKEOUT_STARTED;
+      else if (strcmp(value, "Takeout finished") == 0) return Code::TAKEOUT_FINISHED;
+      else if (strcmp(value, "Manual reset") == 0)     return Code::RESET;
+      else                                             return Code::UNKNOWN;
+    }
+
+    static Code fromString(const String& value) {
+      return fromString(value.c_str());
+    }
+
+  private:
+    Code _value = Code::UNKNOWN;
+  };
+
+} // autodarts
+
+#endif // AutodartsEvents_h_
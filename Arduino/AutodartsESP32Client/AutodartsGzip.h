@@ -0,0 +1,248 @@
+#ifndef AutodartsGzip_h_
+#define AutodartsGzip_h_
+
+#include <Stream.h>
+#include <memory>
+#include <new>
+#include <esp32/rom/miniz.h>
+
+#include "AutodartsDefines.h"
+#include "AutodartsCrc.h"
+
+namespace autodarts {
+
+  // Inflates a gzip encoded source stream on the fly. Uses the miniz inflater
+  // from the ESP32 ROM, so only the 32KB window and the decompressor state
+  // are allocated on the heap while the stream is in use. The CRC32 and size
+  // of the trailer are checked once the deflate stream ends, call finish()
+  // after the consumer stopped reading to verify a body.
+  class GzipStream : public Stream {
+  public:
+    GzipStream() = delete;
+
+    GzipStream(Stream& source) :
+      _source(source), _decompressor(new (std::nothrow) tinfl_decompressor), _window(new (std::nothrow) uint8_t[TINFL_LZ_DICT_SIZE]) {
+      // The window is a single 32KB block, a fragmented heap may not have it
+      if (!_decompressor || !_window) {
+        LOG_ERROR("GzipStream", F("Could not allocate the inflate window"));
+        _error = true;
+        _done = true;
+        return;
+      }
+      tinfl_init(_decompressor.get());
+      _done = !readHeader();
+    }
+
+    int available() override {
+      return fill() ? _outAvailable : 0;
+    }
+
+    int read() override {
+      if (!fill()) {
+        return -1;
+      }
+      uint8_t c = _window[_outPos];
+      _outPos = (_outPos + 1) & (TINFL_LZ_DICT_SIZE - 1);
+      _outAvailable--;
+      _decompressedBytes++;
+      return c;
+    }
+
+    int peek() override {
+      return fill() ? _window[_outPos] : -1;
+    }
+
+    size_t write(uint8_t) override {
+      return 0;
+    }
+
+    bool hasError() const {
+      return _error;
+    }
+
+    // Inflates whatever the consumer did not read, so the trailer is
+    // checked, returns true if the body was complete and intact
+    bool finish() {
+      while (fill()) {
+        _decompressedBytes += _outAvailable;
+        _outPos = (_outPos + _outAvailable) & (TINFL_LZ_DICT_SIZE - 1);
+        _outAvailable = 0;
+      }
+      return !_error;
+    }
+
+    size_t getCompressedBytes() const {
+      return _compressedBytes;
+    }
+
+    size_t getDecompressedBytes() const {
+      return _decompressedBytes;
+    }
+
+  private:
+    enum Flags : uint8_t {
+      FHCRC    = 0x02,
+      FEXTRA   = 0x04,
+      FNAME    = 0x08,
+      FCOMMENT = 0x10,
+    };
+
+    int readSource() {
+      uint8_t c;
+      if (_source.readBytes(&c, 1) != 1) {
+        return -1;
+      }
+      _compressedBytes++;
+      return c;
+    }
+
+    bool skipSource(size_t count) {
+      while (count--) {
+        if (readSource() < 0) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    bool skipString() {
+      int c;
+      do {
+        c = readSource();
+      } while (c > 0);
+      return c == 0;
+    }
+
+    bool readHeader() {
+      // Magic number, compression method (8 = deflate), flags
+      uint8_t header[10];
+      for (uint8_t& b : header) {
+        int c = readSource();
+        if (c < 0) {
+          LOG_ERROR("GzipStream", F("Truncated gzip header"));
+          _error = true;
+          return false;
+        }
+        b = c;
+      }
+
+      if (header[0] != 0x1f || header[1] != 0x8b || header[2] != 8) {
+        LOG_ERROR("GzipStream", F("Invalid gzip header"));
+        _error = true;
+        return false;
+      }
+
+      uint8_t flags = header[3];
+      bool ok = true;
+      if (ok && (flags & FEXTRA)) {
+        int lo = readSource();
+        int hi = readSource();
+        ok = lo >= 0 && hi >= 0 && skipSource(lo | (hi << 8));
+      }
+      if (ok && (flags & FNAME)) {
+        ok = skipString();
+      }
+      if (ok && (flags & FCOMMENT)) {
+        ok = skipString();
+      }
+      if (ok && (flags & FHCRC)) {
+        ok = skipSource(2);
+      }
+      if (!ok) {
+        LOG_ERROR("GzipStream", F("Truncated gzip header"));
+        _error = true;
+      }
+      return ok;
+    }
+
+    int readTrailer() {
+      if (_inSize > 0) {
+        _inSize--;
+        return _in[_inPos++];
+      }
+      return readSource();
+    }
+
+    // CRC32 and size modulo 2^32 of the uncompressed data, little endian
+    bool checkTrailer() {
+      uint8_t trailer[8];
+      for (uint8_t& b : trailer) {
+        int c = readTrailer();
+        if (c < 0) {
+          LOG_ERROR("GzipStream", F("Truncated gzip trailer"));
+          return false;
+        }
+        b = c;
+      }
+      uint32_t crc  = trailer[0] | (trailer[1] << 8) | (trailer[2] << 16) | (static_cast<uint32_t>(trailer[3]) << 24);
+      uint32_t size = trailer[4] | (trailer[5] << 8) | (trailer[6] << 16) | (static_cast<uint32_t>(trailer[7]) << 24);
+      if (crc != _crc || size != _size) {
+        LOG_ERROR("GzipStream", F("Gzip trailer mismatch"));
+        return false;
+      }
+      return true;
+    }
+
+    bool fill() {
+      while (_outAvailable == 0 && !_done) {
+        // Refill input buffer
+        if (_inSize == 0 && !_inputEnd) {
+          _inPos = 0;
+          _inSize = _source.readBytes(_in, sizeof(_in));
+          _compressedBytes += _inSize;
+          _inputEnd = (_inSize == 0);
+        }
+
+        size_t inBytes  = _inSize;
+        size_t outBytes = TINFL_LZ_DICT_SIZE - _outNext;
+        mz_uint32 flags = _inputEnd ? 0 : TINFL_FLAG_HAS_MORE_INPUT;
+        tinfl_status status = tinfl_decompress(_decompressor.get(), _in + _inPos, &inBytes, _window.get(), _window.get() + _outNext, &outBytes, flags);
+
+        _inPos  += inBytes;
+        _inSize -= inBytes;
+        _outPos  = _outNext;
+        _outAvailable = outBytes;
+        _outNext = (_outNext + outBytes) & (TINFL_LZ_DICT_SIZE - 1);
+        _crc   = crc32(_crc, _window.get() + _outPos, outBytes);
+        _size += outBytes;
+
+        if (status == TINFL_STATUS_DONE) {
+          _error = !checkTrailer();
+          _done = true;
+        }
+        else if (status < TINFL_STATUS_DONE) {
+          LOG_ERROR("GzipStream", F("Inflate failed: ") << status);
+          _error = true;
+          _done = true;
+        }
+        else if (status == TINFL_STATUS_NEEDS_MORE_INPUT && _inputEnd) {
+          LOG_ERROR("GzipStream", F("Unexpected end of compressed data"));
+          _error = true;
+          _done = true;
+        }
+      }
+      return _outAvailable > 0;
+    }
+
+    Stream& _source;
+    std::unique_ptr<tinfl_decompressor> _decompressor;
+    std::unique_ptr<uint8_t[]> _window;
+
+    uint8_t _in[512];
+    size_t  _inPos = 0;
+    size_t  _inSize = 0;
+    size_t  _outPos = 0;
+    size_t  _outNext = 0;
+    size_t  _outAvailable = 0;
+    size_t  _compressedBytes = 0;
+    size_t  _decompressedBytes = 0;
+    uint32_t _crc = 0;
+    uint32_t _size = 0;
+    bool    _inputEnd = false;
+    bool    _done = false;
+    bool    _error = false;
+  };
+
+} // autodarts
+
+#endif // AutodartsGzip_h_
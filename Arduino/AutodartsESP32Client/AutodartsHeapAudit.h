@@ -0,0 +1,91 @@
+#ifndef AutodartsHeapAudit_h_
+#define AutodartsHeapAudit_h_
+
+#include "AutodartsDefines.h"
+
+#ifdef AUTODARTS_HEAP_AUDIT
+
+#include <sdkconfig.h>
+#ifdef CONFIG_HEAP_TRACING_STANDALONE
+#include <esp_heap_trace.h>
+#endif
+
+namespace autodarts {
+
+  // Counts heap allocations made while an audit is alive. With heap tracing
+  // enabled in the IDF configuration (CONFIG_HEAP_TRACING_STANDALONE) every
+  // allocation is recorded, including blocks freed again before the audit
+  // ends. The prebuilt Arduino core ships without heap tracing, there only
+  // the free heap is compared, which catches retained allocations but not
+  // transient churn. Both variants see allocations of other tasks made at
+  // the same time, e.g. the WiFi stack, so single hits are no proof.
+  //
+  // Audits nest: one created while another is alive is inert and ends with
+  // 0, its allocations are counted by the outermost audit.
+  class HeapAudit {
+  public:
+    HeapAudit() {
+      if (depth()++ > 0) {
+        _nested = true;
+        return;
+      }
+#ifdef CONFIG_HEAP_TRACING_STANDALONE
+      static heap_trace_record_t records[16];
+      static bool initialized = heap_trace_init_standalone(records, 16) == ESP_OK;
+      _traced = initialized && heap_trace_start(HEAP_TRACE_ALL) == ESP_OK;
+#endif
+      _freeHeap = ESP.getFreeHeap();
+    }
+
+    HeapAudit(const HeapAudit&) = delete;
+
+    ~HeapAudit() {
+      stop();
+      depth()--;
+    }
+
+    // Allocations since construction when traced, otherwise bytes retained
+    uint32_t end() {
+      if (_nested) {
+        return 0;
+      }
+#ifdef CONFIG_HEAP_TRACING_STANDALONE
+      if (_traced) {
+        stop();
+        return heap_trace_get_count();
+      }
+#endif
+      uint32_t freeHeap = ESP.getFreeHeap();
+      return freeHeap < _freeHeap ? _freeHeap - freeHeap : 0;
+    }
+
+    bool isTraced() const {
+      return _traced;
+    }
+
+  private:
+    static uint8_t& depth() {
+      static uint8_t value = 0;
+      return value;
+    }
+
+    void stop() {
+#ifdef CONFIG_HEAP_TRACING_STANDALONE
+      if (_traced && !_stopped) {
+        heap_trace_stop();
+      }
+#endif
+      _stopped = true;
+    }
+
+    uint32_t _freeHeap = 0;
+    bool     _traced = false;
+    bool     _nested = false;
+    bool     _stopped = false;
+  };
+
+} // autodarts
+
+#endif // AUTODARTS_HEAP_AUDIT
+
+#endif // AutodartsHeapAudit_h_
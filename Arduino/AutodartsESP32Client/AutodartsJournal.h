@@ -0,0 +1,267 @@
+#ifndef AutodartsJournal_h_
+#define AutodartsJournal_h_
+
+#include <FS.h>
+
+#include "AutodartsDefines.h"
+#include "AutodartsJournalFormat.h"
+
+namespace autodarts {
+
+  // Persistent history of board events. Records are appended to a RAM buffer
+  // and written in large batches by a background task, so the loop never
+  // waits on flash and each flash write covers many events. Segments are
+  // rotated once they exceed the configured size, the segment with the
+  // highest sequence number is continued after a reboot. The format is
+  // described in AutodartsJournalFormat.h.
+  class Journal {
+  public:
+    enum Code : uint8_t {
+      CONNECTED    = 0x80,
+      DISCONNECTED = 0x81,
+      // Detection events are stored as their Event::Code value
+    };
+
+    struct Stats {
+      uint32_t records = 0;
+      uint32_t recordBytes = 0;
+      uint32_t writtenBytes = 0;
+      uint32_t flushes = 0;
+      uint32_t dropped = 0;
+      uint32_t maxAppendMicros = 0;
+      uint32_t maxFlushMicros = 0;
+    };
+
+    static const uint16_t BUFFER_SIZE = 2048;
+
+    Journal() = default;
+    Journal(const Journal&) = delete;
+
+    ~Journal() {
+      end();
+    }
+
+    bool begin(fs::FS& fs, const char* prefix = "/journal", uint32_t segmentSize = 64 * 1024, uint8_t numSegments = 4, uint32_t flushInterval = 10000) {
+      if (_task) {
+        return true;
+      }
+      _fs = &fs;
+      _prefix = prefix;
+      _segmentSize = segmentSize;
+      _numSegments = numSegments;
+      _flushInterval = flushInterval;
+      _lastFlush = millis();
+      _mutex = xSemaphoreCreateMutex();
+
+      openLatestSegment();
+
+      if (xTaskCreate(&Journal::task, "journal", 4096, this, 1, &_task) != pdPASS) {
+        LOG_ERROR("Journal", F("Could not create journal task!"));
+        _task = nullptr;
+        return false;
+      }
+      return true;
+    }
+
+    // Writes the pending batch and the active buffer before stopping
+    void end() {
+      if (!_task) {
+        return;
+      }
+      waitForWriter();
+      flush();
+      waitForWriter();
+      vTaskDelete(_task);
+      _task = nullptr;
+      _file.close();
+      vSemaphoreDelete(_mutex);
+    }
+
+    // Appends a record, never blocks on flash
+    void append(uint8_t handle, uint8_t code) {
+      if (!_task) {
+        return;
+      }
+      uint32_t start = micros();
+
+      xSemaphoreTake(_mutex, portMAX_DELAY);
+      Batch& batch = _batches[_active];
+      uint16_t size = batch.getSize();
+      if (batch.append(millis(), handle, code)) {
+        _stats.records++;
+        _stats.recordBytes += batch.getSize() - size;
+      }
+      else {
+        _stats.dropped++;
+      }
+      bool full = batch.getSize() >= BUFFER_SIZE * 3 / 4;
+      xSemaphoreGive(_mutex);
+
+      // Hand the buffer over once it is mostly full, old batches are
+      // handed over by update()
+      if (full) {
+        flush();
+      }
+
+      uint32_t duration = micros() - start;
+      if (duration > _stats.maxAppendMicros) {
+        _stats.maxAppendMicros = duration;
+      }
+    }
+
+    // Hands over the active buffer once it is older than the flush interval,
+    // so the last events reach flash even when no more events arrive
+    void update() {
+      if (_task && !_batches[_active].isEmpty() && (millis() - _lastFlush) >= _flushInterval) {
+        flush();
+      }
+    }
+
+    // Swaps buffers and wakes the writer. Returns false while the previous
+    // batch is still written, the records then stay in the active buffer.
+    bool flush() {
+      if (!_task || _writing) {
+        return false;
+      }
+      xSemaphoreTake(_mutex, portMAX_DELAY);
+      bool pending = !_batches[_active].isEmpty();
+      if (pending) {
+        _active ^= 1;
+        _batches[_active].reset();
+        _writing = true;
+      }
+      _lastFlush = millis();
+      xSemaphoreGive(_mutex);
+
+      if (pending) {
+        xTaskNotifyGive(_task);
+      }
+      return true;
+    }
+
+    const Stats& getStats() const {
+      return _stats;
+    }
+
+    // Bytes written to flash per byte of encoded records
+    float getWriteAmplification() const {
+      return _stats.recordBytes ? static_cast<float>(_stats.writtenBytes) / _stats.recordBytes : 0.0f;
+    }
+
+    void printStats() const {
+      LOG_INFO("Journal", F("Records: ") << _stats.records << F(" Record bytes: ") << _stats.recordBytes
+                       << F(" Written: ") << _stats.writtenBytes << F(" Flushes: ") << _stats.flushes
+                       << F(" Dropped: ") << _stats.dropped << F(" Amplification: ") << getWriteAmplification()
+                       << F(" Max append: ") << _stats.maxAppendMicros << F("us Max flush: ") << _stats.maxFlushMicros << F("us"));
+    }
+
+  private:
+    typedef journal::BatchT<BUFFER_SIZE> Batch;
+
+    static void task(void* parameter) {
+      Journal* journal = static_cast<Journal*>(parameter);
+      for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        journal->write();
+      }
+    }
+
+    void waitForWriter() const {
+      while (_writing) {
+        delay(1);
+      }
+    }
+
+    // Runs on the journal task, writes the buffer that is not active
+    void write() {
+      uint32_t start = micros();
+      Batch& batch = _batches[_active ^ 1];
+      const uint8_t* data = batch.finish();
+
+      if (_file.size() + batch.getSize() > _segmentSize) {
+        openSegment((_segment + 1) % _numSegments, _sequence + 1);
+      }
+      if (_file) {
+        _file.write(data, batch.getSize());
+        _file.flush();
+        _stats.writtenBytes += batch.getSize();
+        _stats.flushes++;
+      }
+      batch.reset();
+
+      uint32_t duration = micros() - start;
+      if (duration > _stats.maxFlushMicros) {
+        _stats.maxFlushMicros = duration;
+      }
+      _writing = false;
+    }
+
+    String segmentPath(uint8_t segment) const {
+      return _prefix + '_' + String(segment) + F(".bin");
+    }
+
+    // Continues the segment with the highest sequence number. File times
+    // are no help, the clock is not synchronized.
+    void openLatestSegment() {
+      bool found = false;
+      for (uint8_t segment = 0; segment < _numSegments; segment++) {
+        fs::File file = _fs->open(segmentPath(segment), FILE_READ);
+        uint8_t header[journal::SEGMENT_HEADER_SIZE];
+        uint32_t sequence;
+        if (file && file.read(header, sizeof(header)) == sizeof(header)
+            && journal::readSegmentHeader(header, sizeof(header), sequence)
+            && (!found || journal::isNewer(sequence, _sequence))) {
+          _segment  = segment;
+          _sequence = sequence;
+          found = true;
+        }
+      }
+
+      if (!found) {
+        openSegment(0, 1);
+        return;
+      }
+      _file = _fs->open(segmentPath(_segment), FILE_APPEND);
+      if (!_file) {
+        LOG_ERROR("Journal", F("Could not open journal segment ") << _segment);
+      }
+    }
+
+    // Starts a segment from scratch with a new sequence number
+    void openSegment(uint8_t segment, uint32_t sequence) {
+      _file.close();
+      _segment  = segment;
+      _sequence = sequence;
+      _file = _fs->open(segmentPath(segment), FILE_WRITE);
+      if (!_file) {
+        LOG_ERROR("Journal", F("Could not open journal segment ") << segment);
+        return;
+      }
+      uint8_t header[journal::SEGMENT_HEADER_SIZE];
+      journal::writeSegmentHeader(header, sequence);
+      _file.write(header, sizeof(header));
+      _stats.writtenBytes += sizeof(header);
+    }
+
+    fs::FS*  _fs = nullptr;
+    fs::File _file;
+    String   _prefix;
+    uint32_t _segmentSize = 0;
+    uint32_t _sequence = 0;
+    uint8_t  _numSegments = 0;
+    uint8_t  _segment = 0;
+    uint32_t _flushInterval = 0;
+
+    Batch    _batches[2];
+    uint8_t  _active = 0;
+    uint32_t _lastFlush = 0;
+    volatile bool _writing = false;
+
+    TaskHandle_t      _task = nullptr;
+    SemaphoreHandle_t _mutex = nullptr;
+    Stats _stats;
+  };
+
+} // autodarts
+
+#endif // AutodartsJournal_h_
@@ -0,0 +1,222 @@
+#ifndef AutodartsJournalFormat_h_
+#define AutodartsJournalFormat_h_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "AutodartsCrc.h"
+
+namespace autodarts {
+
+  // On-flash format of the event journal. All integers are little endian.
+  //
+  // Segment: header followed by batches
+  //   uint32 magic "ADJ1", uint32 sequence, incremented per new segment
+  // Batch: header followed by length bytes of records
+  //   0xA5, uint16 length, uint16 record count, uint32 millis of the first
+  //   record, uint32 CRC32 of the records
+  // Record:
+  //   varint delta millis to the previous record, board handle, event code
+  //
+  // Length and CRC delimit every batch, so a reader never mistakes record
+  // bytes for a header and resyncs on the next valid batch after a torn or
+  // corrupted write.
+  namespace journal {
+
+    static const uint32_t SEGMENT_MAGIC       = 0x314a4441; // "ADJ1"
+    static const uint8_t  SEGMENT_HEADER_SIZE = 8;
+    static const uint8_t  BATCH_MARKER        = 0xA5;
+    static const uint8_t  BATCH_HEADER_SIZE   = 13;
+    // Five varint bytes for a 32 bit delta, handle and code
+    static const uint8_t  MAX_RECORD_SIZE     = 7;
+
+    struct Record {
+      uint32_t millis;
+      uint8_t  handle;
+      uint8_t  code;
+    };
+
+    inline void put16(uint8_t* data, uint16_t value) {
+      data[0] = value;
+      data[1] = value >> 8;
+    }
+
+    inline void put32(uint8_t* data, uint32_t value) {
+      put16(data, value);
+      put16(data + 2, value >> 16);
+    }
+
+    inline uint16_t get16(const uint8_t* data) {
+      return data[0] | (data[1] << 8);
+    }
+
+    inline uint32_t get32(const uint8_t* data) {
+      return get16(data) | (static_cast<uint32_t>(get16(data + 2)) << 16);
+    }
+
+    inline void writeSegmentHeader(uint8_t* data, uint32_t sequence) {
+      put32(data, SEGMENT_MAGIC);
+      put32(data + 4, sequence);
+    }
+
+    inline bool readSegmentHeader(const uint8_t* data, size_t length, uint32_t& sequence) {
+      if (length < SEGMENT_HEADER_SIZE || get32(data) != SEGMENT_MAGIC) {
+        return false;
+      }
+      sequence = get32(data + 4);
+      return true;
+    }
+
+    // Sequence numbers compare modulo 2^32
+    inline bool isNewer(uint32_t sequence, uint32_t than) {
+      return static_cast<int32_t>(sequence - than) > 0;
+    }
+
+    // Records of one batch, encoded in place behind room for the header
+    template<uint16_t Size>
+    class BatchT {
+      static_assert(Size > BATCH_HEADER_SIZE + MAX_RECORD_SIZE, "Batch too small for a record");
+
+    public:
+      BatchT() {
+        reset();
+      }
+
+      void reset() {
+        _length = BATCH_HEADER_SIZE;
+        _count = 0;
+      }
+
+      bool isEmpty() const {
+        return _count == 0;
+      }
+
+      uint16_t getCount() const {
+        return _count;
+      }
+
+      // Encoded size including the header
+      uint16_t getSize() const {
+        return _length;
+      }
+
+      // Returns false if the batch is full
+      bool append(uint32_t millis, uint8_t handle, uint8_t code) {
+        if (_length + MAX_RECORD_SIZE > Size) {
+          return false;
+        }
+        if (_count == 0) {
+          _first = millis;
+          _last  = millis;
+        }
+        uint32_t delta = millis - _last;
+        do {
+          _data[_length] = delta & 0x7f;
+          delta >>= 7;
+          if (delta) {
+            _data[_length] |= 0x80;
+          }
+          _length++;
+        } while (delta);
+        _data[_length++] = handle;
+        _data[_length++] = code;
+        _last = millis;
+        _count++;
+        return true;
+      }
+
+      // Fills in the header, the batch is then getSize() bytes at the result
+      const uint8_t* finish() {
+        uint16_t length = _length - BATCH_HEADER_SIZE;
+        _data[0] = BATCH_MARKER;
+        put16(_data + 1, length);
+        put16(_data + 3, _count);
+        put32(_data + 5, _first);
+        put32(_data + 9, crc32(_data + BATCH_HEADER_SIZE, length));
+        return _data;
+      }
+
+    private:
+      uint8_t  _data[Size];
+      uint16_t _length;
+      uint16_t _count;
+      uint32_t _first = 0;
+      uint32_t _last = 0;
+    };
+
+    struct DecodeStats {
+      uint32_t batches = 0;
+      uint32_t records = 0;
+      uint32_t skippedBytes = 0;
+    };
+
+    // Decodes one batch, returns false if it is truncated or corrupted
+    template<typename Callback>
+    bool decodeBatch(const uint8_t* data, size_t length, Callback& callback, uint16_t& count) {
+      if (length < BATCH_HEADER_SIZE || data[0] != BATCH_MARKER) {
+        return false;
+      }
+      uint16_t size = get16(data + 1);
+      count = get16(data + 3);
+      uint32_t millis = get32(data + 5);
+      if (length < static_cast<size_t>(BATCH_HEADER_SIZE) + size || crc32(data + BATCH_HEADER_SIZE, size) != get32(data + 9)) {
+        return false;
+      }
+
+      // Check the record structure before reporting any record of the batch
+      const uint8_t* records = data + BATCH_HEADER_SIZE;
+      for (uint8_t pass = 0; pass < 2; pass++) {
+        uint32_t timestamp = millis;
+        size_t pos = 0;
+        for (uint16_t idx = 0; idx < count; idx++) {
+          uint32_t delta = 0;
+          uint8_t shift = 0;
+          do {
+            if (pos >= size || shift > 28) {
+              return false;
+            }
+            delta |= static_cast<uint32_t>(records[pos] & 0x7f) << shift;
+            shift += 7;
+          } while (records[pos++] & 0x80);
+          if (pos + 2 > size) {
+            return false;
+          }
+          timestamp += delta;
+          if (pass) {
+            callback(Record{timestamp, records[pos], records[pos + 1]});
+          }
+          pos += 2;
+        }
+        if (pos != size) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    // Decodes the batches of a segment without its header. Bytes that do
+    // not start a valid batch are skipped until the next one.
+    template<typename Callback>
+    DecodeStats decode(const uint8_t* data, size_t length, Callback callback) {
+      DecodeStats stats;
+      size_t pos = 0;
+      while (pos < length) {
+        uint16_t count = 0;
+        if (decodeBatch(data + pos, length - pos, callback, count)) {
+          stats.batches++;
+          stats.records += count;
+          pos += BATCH_HEADER_SIZE + get16(data + pos + 1);
+        }
+        else {
+          stats.skippedBytes++;
+          pos++;
+        }
+      }
+      return stats;
+    }
+
+  } // journal
+
+} // autodarts
+
+#endif // AutodartsJournalFormat_h_
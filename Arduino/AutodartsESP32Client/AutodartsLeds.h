@@ -0,0 +1,246 @@
+#ifndef AutodartsLeds_h_
+#define AutodartsLeds_h_
+
+#include <Arduino.h>
+#include <math.h>
+
+#include "AutodartsEvents.h"
+
+namespace autodarts {
+
+  enum class Effect : uint8_t {
+    OFF,
+    ON,
+    BLINK,
+    PULSE,
+    FLASH,
+    FADE_IN,
+    FADE_OUT,
+  };
+
+  // Renders LED effects at a fixed frame rate from the loop. Effects are
+  // sampled from curves computed once in begin(), callbacks only select an
+  // effect, so nothing blocks or allocates while boards are serviced. Levels
+  // are written through a plain function pointer, which can be a PWM pin or
+  // a stand-in that records frames.
+  //
+  // Change detection of events is kept per board for up to NumBoards boards,
+  // further boards replace the least recently seen one.
+  template<uint8_t NumChannels, uint8_t NumBoards = 8>
+  class LedEngineT {
+  public:
+    typedef void (*OutputFunction)(uint8_t channel, uint8_t level);
+
+    static const uint8_t  CURVE_SIZE  = 64;
+    static const uint8_t  NUM_EFFECTS = 7;
+    static const uint8_t  NUM_EVENTS  = 8;
+
+    struct Stats {
+      uint32_t frames = 0;
+      uint32_t missedFrames = 0;
+      uint32_t maxJitterMicros = 0;
+      uint32_t maxRenderMicros = 0;
+    };
+
+    LedEngineT() = delete;
+
+    LedEngineT(OutputFunction output, uint16_t frameRate = 50) :
+      _output(output), _framePeriod(1000000UL / frameRate) {
+
+    }
+
+    void begin() {
+      for (uint8_t idx = 0; idx < CURVE_SIZE; idx++) {
+        float t = static_cast<float>(idx) / (CURVE_SIZE - 1);
+        float pulse = 0.5f - 0.5f * cosf(2.0f * M_PI * t);
+        float flash = expf(-5.0f * t);
+        _curves[static_cast<uint8_t>(Effect::OFF)][idx]      = 0;
+        _curves[static_cast<uint8_t>(Effect::ON)][idx]       = 255;
+        _curves[static_cast<uint8_t>(Effect::BLINK)][idx]    = idx < CURVE_SIZE / 2 ? 255 : 0;
+        // Squared curves look more linear to the eye than linear duty cycles
+        _curves[static_cast<uint8_t>(Effect::PULSE)][idx]    = 255.0f * pulse * pulse + 0.5f;
+        _curves[static_cast<uint8_t>(Effect::FLASH)][idx]    = idx == CURVE_SIZE - 1 ? 0 : 255.0f * flash + 0.5f;
+        _curves[static_cast<uint8_t>(Effect::FADE_IN)][idx]  = 255.0f * t * t + 0.5f;
+        _curves[static_cast<uint8_t>(Effect::FADE_OUT)][idx] = 255.0f * (1.0f - t) * (1.0f - t) + 0.5f;
+      }
+      for (uint8_t channel = 0; channel < NumChannels; channel++) {
+        _channels[channel] = Channel();
+        _output(channel, 0);
+      }
+      _nextFrame = micros();
+    }
+
+    // Starts an effect, one-shot effects hold their last level when done
+    void play(uint8_t channel, Effect effect, uint16_t durationMs = 1000, bool repeat = false) {
+      if (channel >= NumChannels) {
+        return;
+      }
+      Channel& state = _channels[channel];
+      state.effect   = effect;
+      state.start    = millis();
+      state.duration = durationMs ? durationMs : 1;
+      state.repeat   = repeat;
+      state.done     = false;
+    }
+
+    // Effect played when a detection event is reported
+    void mapEvent(Event::Code event, uint8_t channel, Effect effect, uint16_t durationMs = 1000, bool repeat = false) {
+      int8_t idx = eventIndex(event);
+      if (idx < 0 || channel >= NumChannels) {
+        return;
+      }
+      _mapping[idx] = {true, channel, effect, durationMs, repeat};
+    }
+
+    // The detector reports the current event with every state message, so
+    // only changes of a board start the mapped effect
+    void onEvent(const char* boardId, Event::Code event) {
+      BoardEvent& last = lastEvent(boardId);
+      if (event == last.event) {
+        return;
+      }
+      last.event = event;
+      int8_t idx = eventIndex(event);
+      if (idx >= 0 && _mapping[idx].enabled) {
+        const Mapping& mapping = _mapping[idx];
+        play(mapping.channel, mapping.effect, mapping.duration, mapping.repeat);
+      }
+    }
+
+    // Renders a frame if one is due, returns true if it did
+    bool update() {
+      uint32_t now = micros();
+      int32_t late = now - _nextFrame;
+      if (late < 0) {
+        return false;
+      }
+
+      if (static_cast<uint32_t>(late) > _stats.maxJitterMicros) {
+        _stats.maxJitterMicros = late;
+      }
+      // Keep the frame grid, skipping frames the loop was too busy for
+      _nextFrame += _framePeriod;
+      if (static_cast<int32_t>(now - _nextFrame) >= 0) {
+        uint32_t missed = (now - _nextFrame) / _framePeriod + 1;
+        _stats.missedFrames += missed;
+        _nextFrame += missed * _framePeriod;
+      }
+
+      render(millis());
+      _stats.frames++;
+
+      uint32_t duration = micros() - now;
+      if (duration > _stats.maxRenderMicros) {
+        _stats.maxRenderMicros = duration;
+      }
+      return true;
+    }
+
+    uint8_t getLevel(uint8_t channel) const {
+      return channel < NumChannels && _channels[channel].level > 0 ? _channels[channel].level : 0;
+    }
+
+    const Stats& getStats() const {
+      return _stats;
+    }
+
+    void resetStats() {
+      _stats = Stats();
+    }
+
+  private:
+    struct Channel {
+      Effect   effect = Effect::OFF;
+      uint32_t start = 0;
+      uint16_t duration = 1;
+      bool     repeat = false;
+      bool     done = false;
+      int16_t  level = -1;
+    };
+
+    struct Mapping {
+      bool     enabled;
+      uint8_t  channel;
+      Effect   effect;
+      uint16_t duration;
+      bool     repeat;
+    };
+
+    struct BoardEvent {
+      uint32_t hash = 0;
+      uint32_t seen = 0;
+      Event::Code event = Event::Code::UNKNOWN;
+    };
+
+    // Slot of a board by FNV-1a hash of its id, ids are not copied
+    BoardEvent& lastEvent(const char* boardId) {
+      uint32_t hash = 2166136261u;
+      for (const char* it = boardId; it && *it; it++) {
+        hash = (hash ^ static_cast<uint8_t>(*it)) * 16777619u;
+      }
+      _numEvents++;
+      BoardEvent* oldest = &_boards[0];
+      for (BoardEvent& board : _boards) {
+        if (board.seen && board.hash == hash) {
+          board.seen = _numEvents;
+          return board;
+        }
+        if (board.seen < oldest->seen) {
+          oldest = &board;
+        }
+      }
+      *oldest = BoardEvent();
+      oldest->hash = hash;
+      oldest->seen = _numEvents;
+      return *oldest;
+    }
+
+    // Event codes are single bits, STOPPED is zero
+    static int8_t eventIndex(Event::Code event) {
+      int8_t value = static_cast<int8_t>(event);
+      if (value < 0) {
+        return -1;
+      }
+      int8_t idx = 0;
+      while (value) {
+        value >>= 1;
+        idx++;
+      }
+      return idx < NUM_EVENTS ? idx : -1;
+    }
+
+    void render(uint32_t now) {
+      for (uint8_t channel = 0; channel < NumChannels; channel++) {
+        Channel& state = _channels[channel];
+        uint8_t sample = CURVE_SIZE - 1;
+        if (!state.done) {
+          uint32_t elapsed = now - state.start;
+          if (elapsed >= state.duration && !state.repeat) {
+            state.done = true;
+          }
+          else {
+            sample = (elapsed % state.duration) * CURVE_SIZE / state.duration;
+          }
+        }
+        uint8_t level = _curves[static_cast<uint8_t>(state.effect)][sample];
+        if (level != state.level) {
+          state.level = level;
+          _output(channel, level);
+        }
+      }
+    }
+
+    OutputFunction _output;
+    uint32_t _framePeriod;
+    uint32_t _nextFrame = 0;
+    uint8_t  _curves[NUM_EFFECTS][CURVE_SIZE];
+    Channel  _channels[NumChannels];
+    Mapping  _mapping[NUM_EVENTS] = {};
+    BoardEvent _boards[NumBoards];
+    uint32_t _numEvents = 0;
+    Stats    _stats;
+  };
+
+} // autodarts
+
+#endif // AutodartsLeds_h_
@@ -0,0 +1,216 @@
+#ifndef AutodartsMatch_h_
+#define AutodartsMatch_h_
+
+#include <ArduinoJson.h>
+#include <vector>
+
+#include "AutodartsDefines.h"
+#include "AutodartsCheckout.h"
+
+namespace autodarts {
+
+  // X01 match state. Fetched once from the matches API and then updated
+  // incrementally from the throws detected on the board.
+  class Match {
+  public:
+    enum class OutMode : uint8_t {
+      STRAIGHT,
+      DOUBLE,
+      MASTER,
+    };
+
+    struct Player {
+      String   name;
+      int16_t  remaining = 0;
+      uint8_t  legs = 0;
+    };
+
+    Match() = delete;
+
+    Match(const String& boardId) :
+      _boardId(boardId) {
+
+    }
+
+    const String& getBoardId() const {
+      return _boardId;
+    }
+
+    const String& getId() const {
+      return _id;
+    }
+
+    bool isActive() const {
+      return _active;
+    }
+
+    uint8_t getNumPlayers() const {
+      return _players.size();
+    }
+
+    const Player& getPlayer(uint8_t idx) const {
+      return _players[idx];
+    }
+
+    uint8_t getCurrentPlayer() const {
+      return _player;
+    }
+
+    int16_t getRemaining() const {
+      return _active && _player < _players.size() ? _players[_player].remaining : 0;
+    }
+
+    uint8_t getDartsThrown() const {
+      return _dartsThrown;
+    }
+
+    int16_t getBaseScore() const {
+      return _baseScore;
+    }
+
+    OutMode getOutMode() const {
+      return _outMode;
+    }
+
+    // Checkout suggestion for the darts left in the current turn, see Checkout
+    uint32_t getCheckout() const {
+      if (!_active || _outMode != OutMode::DOUBLE) {
+        return 0;
+      }
+      return Checkout::lookup(getRemaining(), 3 - _dartsThrown);
+    }
+
+    uint32_t getLastUpdateMicros() const {
+      return _lastUpdateMicros;
+    }
+
+    void fromJson(const JsonObjectConst& root) {
+      _id        = String(root["id"].as<const char*>());
+      _baseScore = root["settings"]["baseScore"] | 501;
+
+      const char* outMode = root["settings"]["outMode"] | "Double";
+      if      (strcmp(outMode, "Straight") == 0) _outMode = OutMode::STRAIGHT;
+      else if (strcmp(outMode, "Master") == 0)   _outMode = OutMode::MASTER;
+      else                                       _outMode = OutMode::DOUBLE;
+
+      JsonArrayConst players = root["players"];
+      JsonArrayConst scores  = root["gameScores"];
+      JsonArrayConst legs    = root["scores"];
+      _players.resize(players.size() < UINT8_MAX ? players.size() : UINT8_MAX);
+      for (size_t idx = 0; idx < _players.size(); idx++) {
+        _players[idx].name      = String(players[idx]["name"].as<const char*>());
+        _players[idx].remaining = scores[idx] | _baseScore;
+        _players[idx].legs      = legs[idx]["legs"] | 0;
+      }
+
+      // Stale or malformed matches must not index past the players
+      int player   = root["player"] | 0;
+      bool valid   = player >= 0 && static_cast<size_t>(player) < _players.size();
+      if (!valid && !_players.empty()) {
+        LOG_WARNING("Match", F("Current player ") << player << F(" out of range, ignoring match [") << _id << F("]"));
+      }
+      _player      = valid ? player : 0;
+      _legStarter  = _player;
+      _dartsThrown = 0;
+      _turnStart   = valid ? _players[_player].remaining : 0;
+      _active      = valid && !(root["finished"] | false);
+    }
+
+    void toJson(JsonObject& root) const {
+      root["id"]          = _id.c_str();
+      root["baseScore"]   = _baseScore;
+      root["player"]      = _player;
+      root["dartsThrown"] = _dartsThrown;
+      char checkout[16];
+      Checkout::format(getCheckout(), checkout, sizeof(checkout));
+      root["checkout"]    = checkout;
+      JsonArray players = root.createNestedArray("players");
+      for (const Player& player : _players) {
+        JsonObject entry = players.createNestedObject();
+        entry["name"]      = player.name.c_str();
+        entry["remaining"] = player.remaining;
+        entry["legs"]      = player.legs;
+      }
+    }
+
+    // Applies a single dart of the current player
+    void applyThrow(const Throw& dart) {
+      if (!_active || _player >= _players.size()) {
+        return;
+      }
+      uint32_t start = micros();
+
+      Player& player = _players[_player];
+      int16_t remaining = player.remaining - dart.score();
+      bool checkout = remaining == 0 && isValidOut(dart);
+      bool bust = remaining < 0 || (remaining == 0 && !checkout) || (remaining == 1 && _outMode != OutMode::STRAIGHT);
+
+      if (bust) {
+        LOG_DEBUG("Match", player.name << F(" busted"));
+        player.remaining = _turnStart;
+        nextPlayer();
+      }
+      else if (checkout) {
+        LOG_DEBUG("Match", player.name << F(" won the leg"));
+        player.legs++;
+        nextLeg();
+      }
+      else {
+        player.remaining = remaining;
+        if (++_dartsThrown >= 3) {
+          nextPlayer();
+        }
+      }
+
+      _lastUpdateMicros = micros() - start;
+    }
+
+  private:
+    bool isValidOut(const Throw& dart) const {
+      switch (_outMode) {
+        case OutMode::STRAIGHT: return true;
+        case OutMode::MASTER:   return dart.multiplier >= 2;
+        default:                return dart.isDouble();
+      }
+    }
+
+    void nextPlayer() {
+      if (_players.empty()) {
+        _active = false;
+        return;
+      }
+      _player = (_player + 1) % _players.size();
+      _dartsThrown = 0;
+      _turnStart = _players[_player].remaining;
+    }
+
+    void nextLeg() {
+      if (_players.empty()) {
+        _active = false;
+        return;
+      }
+      for (Player& player : _players) {
+        player.remaining = _baseScore;
+      }
+      _legStarter = (_legStarter + 1) % _players.size();
+      _player = _legStarter;
+      _dartsThrown = 0;
+      _turnStart = _baseScore;
+    }
+
+    String  _boardId;
+    String  _id;
+    std::vector<Player> _players;
+    int16_t _baseScore = 501;
+    int16_t _turnStart = 0;
+    OutMode _outMode = OutMode::DOUBLE;
+    uint8_t _player = 0;
+    uint8_t _legStarter = 0;
+    uint8_t _dartsThrown = 0;
+    bool    _active = false;
+    uint32_t _lastUpdateMicros = 0;
+  };
+
+} // autodarts
+
+#endif // AutodartsMatch_h_
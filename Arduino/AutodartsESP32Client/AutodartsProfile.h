@@ -0,0 +1,159 @@
+#ifndef AutodartsProfile_h_
+#define AutodartsProfile_h_
+
+#include <Arduino.h>
+#include <string.h>
+
+#ifdef AUTODARTS_PROFILING
+
+// Cycle counter and clock the profile is measured with, both can be defined
+// before the include to profile with another source, e.g. in host tests
+#ifndef AUTODARTS_CYCLE_COUNT
+#define AUTODARTS_CYCLE_COUNT() ESP.getCycleCount()
+#endif
+
+#ifndef AUTODARTS_CPU_MHZ
+#define AUTODARTS_CPU_MHZ() ESP.getCpuFreqMHz()
+#endif
+
+namespace autodarts {
+
+  class ProfileScope;
+
+  // CPU cycles a board spent per phase, both in total and in the current
+  // loop. Scopes nest: cycles of an inner scope are only counted for the
+  // inner phase, e.g. a message callback invoked while polling the socket.
+  // Nesting spans profiles, so a board parsing a message while the cloud
+  // connection is polled is not counted for the cloud as well.
+  class Profile {
+  public:
+    enum Phase : uint8_t {
+      IO,
+      PARSE,
+      CALLBACK,
+      NUM_PHASES,
+    };
+
+    static const char* toCString(Phase phase) {
+      switch (phase) {
+        case IO:       return "I/O";
+        case PARSE:    return "Parse";
+        case CALLBACK: return "Callback";
+        default:       return "Unknown";
+      }
+    }
+
+    void beginLoop() {
+      memset(_loop, 0, sizeof(_loop));
+    }
+
+    uint32_t getLoopCycles(Phase phase) const {
+      return _loop[phase];
+    }
+
+    uint32_t getLoopCycles() const {
+      return _loop[IO] + _loop[PARSE] + _loop[CALLBACK];
+    }
+
+    uint64_t getTotalCycles(Phase phase) const {
+      return _total[phase];
+    }
+
+    uint64_t getTotalCycles() const {
+      return _total[IO] + _total[PARSE] + _total[CALLBACK];
+    }
+
+    uint32_t getMaxCycles(Phase phase) const {
+      return _max[phase];
+    }
+
+    void reset() {
+      memset(_loop, 0, sizeof(_loop));
+      memset(_total, 0, sizeof(_total));
+      memset(_max, 0, sizeof(_max));
+    }
+
+    static uint32_t toMicros(uint64_t cycles) {
+      return cycles / AUTODARTS_CPU_MHZ();
+    }
+
+  private:
+    friend class ProfileScope;
+
+    void add(Phase phase, uint32_t cycles) {
+      _loop[phase]  += cycles;
+      _total[phase] += cycles;
+      if (cycles > _max[phase]) {
+        _max[phase] = cycles;
+      }
+    }
+
+    uint32_t _loop[NUM_PHASES]  = {};
+    uint64_t _total[NUM_PHASES] = {};
+    uint32_t _max[NUM_PHASES]   = {};
+  };
+
+  class ProfileScope {
+  public:
+    ProfileScope(Profile& profile, Profile::Phase phase) :
+      _profile(profile), _phase(phase), _parent(active()), _start(AUTODARTS_CYCLE_COUNT()) {
+      active() = this;
+    }
+
+    ~ProfileScope() {
+      uint32_t elapsed = AUTODARTS_CYCLE_COUNT() - _start;
+      _profile.add(_phase, elapsed - _children);
+      if (_parent) {
+        _parent->_children += elapsed;
+      }
+      active() = _parent;
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+
+  private:
+    // Innermost open scope, profiling is only done on the loop task
+    static ProfileScope*& active() {
+      static ProfileScope* scope = nullptr;
+      return scope;
+    }
+
+    Profile&       _profile;
+    Profile::Phase _phase;
+    ProfileScope*  _parent;
+    uint32_t       _start;
+    uint32_t       _children = 0;
+  };
+
+  // Phase of a profile that spent the most cycles in the current loop
+  struct Hotspot {
+    const Profile* profile = nullptr;
+    Profile::Phase phase   = Profile::IO;
+    uint32_t       cycles  = 0;
+  };
+
+  // Takes over the hotspot if a phase of profile spent more cycles in the
+  // current loop, returns true if it did. Called for every profile of a
+  // loop, the earliest of equal profiles keeps the hotspot.
+  inline bool findHotspot(const Profile& profile, Hotspot& hotspot) {
+    bool found = false;
+    for (uint8_t phase = 0; phase < Profile::NUM_PHASES; phase++) {
+      uint32_t cycles = profile.getLoopCycles(static_cast<Profile::Phase>(phase));
+      if (cycles > hotspot.cycles) {
+        hotspot.profile = &profile;
+        hotspot.phase   = static_cast<Profile::Phase>(phase);
+        hotspot.cycles  = cycles;
+        found = true;
+      }
+    }
+    return found;
+  }
+
+} // autodarts
+
+#define AUTODARTS_PROFILE(profile, phase) autodarts::ProfileScope _profileScope(profile, autodarts::Profile::phase)
+#else
+#define AUTODARTS_PROFILE(profile, phase)
+#endif // AUTODARTS_PROFILING
+
+#endif // AutodartsProfile_h_
@@ -0,0 +1,139 @@
+#ifndef AutodartsQueue_h_
+#define AutodartsQueue_h_
+
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+#include "AutodartsRawJson.h"
+
+namespace autodarts {
+
+  enum class Priority : uint8_t {
+    STATE,      // state, cam_state and unknown messages, never dropped
+    TELEMETRY,  // stats, cam_stats and motion_state, coalesced to the newest
+  };
+
+  // Bounded per-priority message buffers of a board. State messages are kept
+  // in order in a small ring, telemetry keeps only the newest message per
+  // type and camera. Buffers grow to the largest message they held and are
+  // reused, so steady state queuing does not allocate.
+  //
+  // Payloads are copied into the slots. The websocket library owns its
+  // receive buffer and frees it when the event callback returns, so the
+  // queue cannot keep it. This copy is the price of deferring the parse;
+  // the in-place parse still runs on the slot without a second copy.
+  template<uint8_t StateSize, uint8_t NumCameras>
+  class MessageQueueT {
+  public:
+    struct Stats {
+      uint32_t coalesced = 0;
+      uint32_t overflows = 0;
+    };
+
+    // Returns false if the state ring is full, the caller then has to
+    // dispatch the oldest state message first
+    bool push(const char* payload, size_t length) {
+      int8_t slot = telemetrySlot(payload, length);
+      if (slot >= 0) {
+        Message& message = _telemetry[slot];
+        if (message.pending) {
+          _stats.coalesced++;
+        }
+        message.assign(payload, length);
+        return true;
+      }
+
+      if (_stateCount == StateSize) {
+        _stats.overflows++;
+        return false;
+      }
+      _state[(_stateHead + _stateCount) % StateSize].assign(payload, length);
+      _stateCount++;
+      return true;
+    }
+
+    bool isStateFull() const {
+      return _stateCount == StateSize;
+    }
+
+    // Hands the next pending message of the given priority to the callback
+    // with a mutable, terminated buffer
+    template<typename TCallback>
+    bool pop(Priority priority, TCallback callback) {
+      if (priority == Priority::STATE) {
+        if (_stateCount == 0) {
+          return false;
+        }
+        Message& message = _state[_stateHead];
+        _stateHead = (_stateHead + 1) % StateSize;
+        _stateCount--;
+        message.pending = false;
+        callback(message.data.data(), message.length);
+        return true;
+      }
+
+      for (Message& message : _telemetry) {
+        if (message.pending) {
+          message.pending = false;
+          callback(message.data.data(), message.length);
+          return true;
+        }
+      }
+      return false;
+    }
+
+    const Stats& getStats() const {
+      return _stats;
+    }
+
+  private:
+    struct Message {
+      std::vector<char> data;
+      size_t length = 0;
+      bool pending = false;
+
+      void assign(const char* payload, size_t size) {
+        if (data.size() < size + 1) {
+          data.resize(size + 1);
+        }
+        memcpy(data.data(), payload, size);
+        data[size] = '\0';
+        length = size;
+        pending = true;
+      }
+    };
+
+    // Telemetry slots: stats, motion_state, then one per camera. Type and
+    // camera id are read from the top level of the message and its data,
+    // keys nested deeper or inside strings are not matched.
+    static int8_t telemetrySlot(const char* payload, size_t length) {
+      rawjson::Span type;
+      if (!rawjson::findString(payload, length, "type", type)) {
+        return -1;
+      }
+      if (type.equals("stats")) {
+        return 0;
+      }
+      if (type.equals("motion_state")) {
+        return 1;
+      }
+      rawjson::Span data;
+      uint32_t id;
+      if (type.equals("cam_stats") && rawjson::findMember(payload, length, "data", data)
+          && rawjson::findUnsigned(data.data, data.length, "id", id) && id < NumCameras) {
+        return 2 + id;
+      }
+      return -1;
+    }
+
+    Message _state[StateSize];
+    Message _telemetry[2 + NumCameras];
+    uint8_t _stateHead = 0;
+    uint8_t _stateCount = 0;
+    Stats   _stats;
+  };
+
+} // autodarts
+
+#endif // AutodartsQueue_h_
@@ -0,0 +1,153 @@
+#ifndef AutodartsRawJson_h_
+#define AutodartsRawJson_h_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+namespace autodarts {
+
+  // Lookups on raw JSON text without building a document, for routing a
+  // message before it is parsed. Only members of the outermost object are
+  // matched: nested objects, arrays and strings are skipped as a whole, so
+  // a key or value inside them never matches. Keys are compared byte by
+  // byte, escaped keys do not match.
+  namespace rawjson {
+
+    struct Span {
+      const char* data = nullptr;
+      size_t      length = 0;
+
+      bool equals(const char* literal) const {
+        return data && strlen(literal) == length && memcmp(data, literal, length) == 0;
+      }
+    };
+
+    inline const char* skipSpace(const char* it, const char* end) {
+      while (it < end && (*it == ' ' || *it == '\t' || *it == '\r' || *it == '\n')) {
+        it++;
+      }
+      return it;
+    }
+
+    // Returns the end of the string starting at the opening quote, after the
+    // closing quote, or nullptr if it is not terminated
+    inline const char* skipString(const char* it, const char* end) {
+      for (it++; it < end; it++) {
+        if (*it == '\\') {
+          it++;
+        }
+        else if (*it == '"') {
+          return it + 1;
+        }
+      }
+      return nullptr;
+    }
+
+    // Returns the end of the value starting at it, or nullptr if it is cut off
+    inline const char* skipValue(const char* it, const char* end) {
+      if (it >= end) {
+        return nullptr;
+      }
+      if (*it == '"') {
+        return skipString(it, end);
+      }
+      if (*it == '{' || *it == '[') {
+        size_t depth = 0;
+        while (it < end) {
+          if (*it == '"') {
+            it = skipString(it, end);
+            if (!it) {
+              return nullptr;
+            }
+            continue;
+          }
+          if (*it == '{' || *it == '[') {
+            depth++;
+          }
+          else if ((*it == '}' || *it == ']') && --depth == 0) {
+            return it + 1;
+          }
+          it++;
+        }
+        return nullptr;
+      }
+      // Numbers, true, false and null
+      while (it < end && *it != ',' && *it != '}' && *it != ']' && *it != ' ' && *it != '\t' && *it != '\r' && *it != '\n') {
+        it++;
+      }
+      return it;
+    }
+
+    // Span of the value of a member of the outermost object, strings
+    // including their quotes
+    inline bool findMember(const char* payload, size_t length, const char* key, Span& value) {
+      const char* end = payload + length;
+      const char* it = skipSpace(payload, end);
+      if (it >= end || *it != '{') {
+        return false;
+      }
+      size_t keyLength = strlen(key);
+      it = skipSpace(it + 1, end);
+      while (it < end && *it == '"') {
+        const char* keyEnd = skipString(it, end);
+        if (!keyEnd) {
+          return false;
+        }
+        bool matches = static_cast<size_t>(keyEnd - it - 2) == keyLength && memcmp(it + 1, key, keyLength) == 0;
+        it = skipSpace(keyEnd, end);
+        if (it >= end || *it != ':') {
+          return false;
+        }
+        it = skipSpace(it + 1, end);
+        const char* valueEnd = skipValue(it, end);
+        if (!valueEnd) {
+          return false;
+        }
+        if (matches) {
+          value.data = it;
+          value.length = valueEnd - it;
+          return true;
+        }
+        it = skipSpace(valueEnd, end);
+        if (it >= end || *it != ',') {
+          return false;
+        }
+        it = skipSpace(it + 1, end);
+      }
+      return false;
+    }
+
+    // Raw content of a string member of the outermost object, not unescaped
+    inline bool findString(const char* payload, size_t length, const char* key, Span& value) {
+      Span member;
+      if (!findMember(payload, length, key, member) || member.length < 2 || member.data[0] != '"') {
+        return false;
+      }
+      value.data = member.data + 1;
+      value.length = member.length - 2;
+      return true;
+    }
+
+    // Non-negative integer member of the outermost object
+    inline bool findUnsigned(const char* payload, size_t length, const char* key, uint32_t& value) {
+      Span member;
+      if (!findMember(payload, length, key, member) || member.length == 0 || member.length > 9) {
+        return false;
+      }
+      value = 0;
+      for (size_t idx = 0; idx < member.length; idx++) {
+        char c = member.data[idx];
+        if (c < '0' || c > '9') {
+          return false;
+        }
+        value = value * 10 + (c - '0');
+      }
+      return true;
+    }
+
+  } // rawjson
+
+} // autodarts
+
+#endif // AutodartsRawJson_h_
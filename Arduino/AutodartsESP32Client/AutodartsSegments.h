@@ -0,0 +1,169 @@
+#ifndef AutodartsSegments_h_
+#define AutodartsSegments_h_
+
+#include <stdint.h>
+#include <string.h>
+
+namespace autodarts {
+
+  // Maps dart coordinates to dartboard segments without trigonometry on the
+  // hot path. Coordinates are normalised to the outer edge of the double
+  // ring with y pointing towards the 20.
+  namespace segments {
+
+    // Squared ring radii (standard board, 170mm to the outer double wire)
+    constexpr float square(float value) {
+      return value * value;
+    }
+    constexpr float BULL_RADIUS_SQ         = square(6.35f  / 170.0f);
+    constexpr float OUTER_BULL_RADIUS_SQ   = square(15.9f  / 170.0f);
+    constexpr float TRIPLE_INNER_RADIUS_SQ = square(99.0f  / 170.0f);
+    constexpr float TRIPLE_OUTER_RADIUS_SQ = square(107.0f / 170.0f);
+    constexpr float DOUBLE_INNER_RADIUS_SQ = square(162.0f / 170.0f);
+    constexpr float DOUBLE_OUTER_RADIUS_SQ = 1.0f;
+
+    // Sector boundaries repeat every quadrant at 9, 27, 45, 63 and 81 degrees
+    constexpr float SECTOR_TANGENTS[] = {0.15838444f, 0.50952545f, 1.0f, 1.96261051f, 6.31375151f};
+
+    // Sector numbers counter-clockwise, starting at the positive x axis
+    constexpr uint8_t SECTOR_NUMBERS[] = {6, 13, 4, 18, 1, 20, 5, 12, 9, 14, 11, 8, 16, 7, 19, 3, 17, 2, 15, 10};
+
+    inline uint8_t sector(float x, float y) {
+      // Rotate into the first quadrant
+      uint8_t quadrant;
+      float u, v;
+      if (y >= 0) {
+        if (x > 0) { quadrant = 0; u =  x; v =  y; }
+        else       { quadrant = 1; u =  y; v = -x; }
+      }
+      else {
+        if (x < 0) { quadrant = 2; u = -x; v = -y; }
+        else       { quadrant = 3; u = -y; v =  x; }
+      }
+
+      // Count boundaries below the angle, tan(angle) = v / u
+      uint8_t offset = 0;
+      while (offset < 5 && v >= u * SECTOR_TANGENTS[offset]) {
+        offset++;
+      }
+      return SECTOR_NUMBERS[(quadrant * 5 + offset) % 20];
+    }
+
+    // Sets number (0 for a miss, 25 for bull) and multiplier (0 for a miss)
+    inline void classify(float x, float y, int8_t& number, int8_t& multiplier) {
+      float radiusSq = x * x + y * y;
+      if (radiusSq <= BULL_RADIUS_SQ) {
+        number = 25;
+        multiplier = 2;
+      }
+      else if (radiusSq <= OUTER_BULL_RADIUS_SQ) {
+        number = 25;
+        multiplier = 1;
+      }
+      else if (radiusSq > DOUBLE_OUTER_RADIUS_SQ) {
+        number = 0;
+        multiplier = 0;
+      }
+      else {
+        number = sector(x, y);
+        multiplier = (radiusSq >= DOUBLE_INNER_RADIUS_SQ) ? 2
+                   : (radiusSq >= TRIPLE_INNER_RADIUS_SQ && radiusSq <= TRIPLE_OUTER_RADIUS_SQ) ? 3
+                   : 1;
+      }
+    }
+
+  } // segments
+
+
+  // Hit counts per grid cell over the board square [-1, 1]^2 and per
+  // segment. Counters saturate instead of wrapping.
+  template<uint8_t Size>
+  class HeatmapT {
+  public:
+    // 20 numbers times single, double, triple, then outer bull, bull, miss
+    static constexpr uint8_t NUM_SEGMENTS = 63;
+
+    HeatmapT() {
+      reset();
+    }
+
+    void reset() {
+      memset(_cells, 0, sizeof(_cells));
+      memset(_segments, 0, sizeof(_segments));
+      _total = 0;
+    }
+
+    void add(float x, float y, int8_t number, int8_t multiplier) {
+      // Both edges belong to the board, the products can round up to Size
+      // there and just inside, so the outermost cells take them
+      if (x >= -1.0f && x <= 1.0f && y >= -1.0f && y <= 1.0f) {
+        float column = (x + 1.0f) * (Size / 2.0f);
+        float row    = (1.0f - y) * (Size / 2.0f);
+        uint8_t idx  = column < Size - 1 ? static_cast<uint8_t>(column) : Size - 1;
+        uint8_t idy  = row < Size - 1 ? static_cast<uint8_t>(row) : Size - 1;
+        increment(_cells[idy * Size + idx]);
+      }
+      increment(_segments[segmentIndex(number, multiplier)]);
+      _total++;
+    }
+
+    uint16_t getCell(uint8_t row, uint8_t column) const {
+      return _cells[row * Size + column];
+    }
+
+    uint16_t getSegment(int8_t number, int8_t multiplier) const {
+      return _segments[segmentIndex(number, multiplier)];
+    }
+
+    uint32_t getTotal() const {
+      return _total;
+    }
+
+    static constexpr uint8_t getSize() {
+      return Size;
+    }
+
+    // Sparse export: only non-empty cells as [index, count] pairs
+    template<typename TJsonObject>
+    void toJson(TJsonObject& root) const {
+      root["size"]  = Size;
+      root["total"] = _total;
+      auto cells = root.createNestedArray("cells");
+      for (uint16_t idx = 0; idx < Size * Size; idx++) {
+        if (_cells[idx]) {
+          auto cell = cells.createNestedArray();
+          cell.add(idx);
+          cell.add(_cells[idx]);
+        }
+      }
+      auto segments = root.createNestedArray("segments");
+      for (uint8_t idx = 0; idx < NUM_SEGMENTS; idx++) {
+        segments.add(_segments[idx]);
+      }
+    }
+
+  private:
+    static uint8_t segmentIndex(int8_t number, int8_t multiplier) {
+      if (number >= 1 && number <= 20 && multiplier >= 1 && multiplier <= 3) {
+        return (number - 1) * 3 + (multiplier - 1);
+      }
+      if (number == 25) {
+        return multiplier == 2 ? 61 : 60;
+      }
+      return 62;
+    }
+
+    static void increment(uint16_t& counter) {
+      if (counter < UINT16_MAX) {
+        counter++;
+      }
+    }
+
+    uint16_t _cells[Size * Size];
+    uint16_t _segments[NUM_SEGMENTS];
+    uint32_t _total = 0;
+  };
+
+} // autodarts
+
+#endif // AutodartsSegments_h_
@@ -0,0 +1,124 @@
+#ifndef AutodartsTiming_h_
+#define AutodartsTiming_h_
+
+#include <stdint.h>
+#include <string.h>
+
+namespace autodarts {
+
+  // Streaming histogram of durations with power of two bins. Bin 0 holds
+  // durations below FirstBin, every following bin doubles the upper bound
+  // and the last bin is open ended. Only counters are kept, no history.
+  template<uint8_t NumBins, uint16_t FirstBin>
+  class HistogramT {
+    static_assert(NumBins >= 2 && NumBins <= 24, "Histogram supports 2 to 24 bins");
+
+  public:
+    HistogramT() {
+      reset();
+    }
+
+    void reset() {
+      memset(_bins, 0, sizeof(_bins));
+      _count = 0;
+      _sum = 0;
+      _min = UINT32_MAX;
+      _max = 0;
+    }
+
+    void add(uint32_t value) {
+      uint8_t bin = 0;
+      uint32_t bound = FirstBin;
+      while (bin < NumBins - 1 && value >= bound) {
+        bound <<= 1;
+        bin++;
+      }
+      _bins[bin]++;
+      _count++;
+      _sum += value;
+      _min = value < _min ? value : _min;
+      _max = value > _max ? value : _max;
+    }
+
+    uint32_t getCount() const {
+      return _count;
+    }
+
+    uint32_t getMin() const {
+      return _count ? _min : 0;
+    }
+
+    uint32_t getMax() const {
+      return _max;
+    }
+
+    uint32_t getMean() const {
+      return _count ? _sum / _count : 0;
+    }
+
+    uint32_t getBin(uint8_t idx) const {
+      return idx < NumBins ? _bins[idx] : 0;
+    }
+
+    // Exclusive upper bound of a bin, UINT32_MAX for the last one
+    static uint32_t getBinUpperBound(uint8_t idx) {
+      return idx >= NumBins - 1 ? UINT32_MAX : static_cast<uint32_t>(FirstBin) << idx;
+    }
+
+    static constexpr uint8_t getNumBins() {
+      return NumBins;
+    }
+
+    // Percentile interpolated linearly inside the bin holding it, assuming
+    // its values are spread evenly. The bin range is narrowed to the
+    // observed minimum and maximum, so 0 and 100 give exactly those.
+    uint32_t getPercentile(uint8_t percent) const {
+      if (!_count) {
+        return 0;
+      }
+      uint64_t target = (static_cast<uint64_t>(_count) * percent + 99) / 100;
+      uint32_t seen = 0;
+      for (uint8_t idx = 0; idx < NumBins; idx++) {
+        if (_bins[idx] && seen + _bins[idx] >= target) {
+          uint32_t lower = idx ? getBinUpperBound(idx - 1) : 0;
+          uint32_t upper = getBinUpperBound(idx);
+          lower = lower > _min ? lower : _min;
+          upper = upper < _max ? upper : _max;
+          if (upper <= lower) {
+            return lower;
+          }
+          return lower + static_cast<uint64_t>(upper - lower) * (target - seen) / _bins[idx];
+        }
+        seen += _bins[idx];
+      }
+      return _max;
+    }
+
+    template<typename TJsonObject>
+    void toJson(TJsonObject& root) const {
+      root["count"] = _count;
+      root["min"]   = getMin();
+      root["max"]   = _max;
+      root["mean"]  = getMean();
+      root["p50"]   = getPercentile(50);
+      root["p90"]   = getPercentile(90);
+      auto bins = root.createNestedArray("bins");
+      for (uint8_t idx = 0; idx < NumBins; idx++) {
+        bins.add(_bins[idx]);
+      }
+    }
+
+  private:
+    uint32_t _bins[NumBins];
+    uint32_t _count = 0;
+    uint64_t _sum = 0;
+    uint32_t _min = UINT32_MAX;
+    uint32_t _max = 0;
+  };
+
+  // Millisecond histogram from 16ms up to 16s and above
+  typedef HistogramT<12, 16> TimingHistogram;
+
+} // autodarts
+
+#endif // AutodartsTiming_h_
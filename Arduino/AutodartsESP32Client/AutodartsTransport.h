@@ -0,0 +1,307 @@
+#ifndef AutodartsTransport_h_
+#define AutodartsTransport_h_
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <vector>
+
+// Selects the websocket library of the boards. ALTERNATE_WEBSOCKET, the
+// default, uses WebSocketsClient (links2004/arduinoWebSockets), defining
+// AUTODARTS_ARDUINO_WEBSOCKETS instead uses WebsocketsClient
+// (gilmaimon/ArduinoWebsockets). Only the selected library is included,
+// define both to build both adapters, e.g. to compare them.
+#if !defined(ALTERNATE_WEBSOCKET) && !defined(AUTODARTS_ARDUINO_WEBSOCKETS)
+#define ALTERNATE_WEBSOCKET
+#endif
+
+#ifdef ALTERNATE_WEBSOCKET
+#include <WebSocketsClient.h>
+#endif
+#ifdef AUTODARTS_ARDUINO_WEBSOCKETS
+#include <ArduinoWebsockets.h>
+#endif
+
+#include "AutodartsDefines.h"
+
+namespace autodarts {
+
+  // Websocket transport a board receives its events from
+  class Transport {
+  public:
+    enum class Type : uint8_t {
+      CONNECTED,
+      DISCONNECTED,
+      TEXT,
+    };
+
+    // Payload of TEXT events is mutable and only valid during the callback
+    typedef std::function<void(Type type, char* payload, size_t length)> EventCallback;
+
+    virtual ~Transport() = default;
+
+    virtual bool open(const String& host, uint16_t port, const char* path) = 0;
+
+    virtual void close() = 0;
+
+    // Services the connection, returns true if a message was delivered
+    virtual bool poll() = 0;
+
+    void onEvent(EventCallback callback) {
+      _onEventCallback = callback;
+    }
+
+    void setReconnectInterval(uint32_t interval) {
+      _reconnectInterval = interval;
+    }
+
+  protected:
+    EventCallback _onEventCallback = [](Type, char*, size_t){};
+    uint32_t _reconnectInterval = 5000;
+  };
+
+
+#ifdef ALTERNATE_WEBSOCKET
+  // Adapter for WebSocketsClient (links2004/arduinoWebSockets)
+  class WebSocketsTransport : public Transport {
+  public:
+    bool open(const String& host, uint16_t port, const char* path) override {
+      _websocket.begin(host, port, path);
+      _websocket.onEvent([this](WStype_t type, uint8_t * payload, size_t length) {
+        switch(type) {
+          case WStype_CONNECTED: {
+            _onEventCallback(Type::CONNECTED, nullptr, 0);
+            break;
+          }
+          case WStype_DISCONNECTED: {
+            _onEventCallback(Type::DISCONNECTED, nullptr, 0);
+            break;
+          }
+          case WStype_TEXT: {
+            _onEventCallback(Type::TEXT, reinterpret_cast<char*>(payload), length);
+            _delivered = true;
+            break;
+          }
+          case WStype_BIN:
+          case WStype_ERROR:
+          case WStype_FRAGMENT_TEXT_START:
+          case WStype_FRAGMENT_BIN_START:
+          case WStype_FRAGMENT:
+          case WStype_FRAGMENT_FIN:
+          default:
+            break;
+        }
+      });
+      _websocket.setReconnectInterval(_reconnectInterval);
+      return true;
+    }
+
+    void close() override {
+      _websocket.disconnect();
+    }
+
+    bool poll() override {
+      _delivered = false;
+      _websocket.loop();
+      return _delivered;
+    }
+
+  private:
+    WebSocketsClient _websocket;
+    bool _delivered = false;
+  };
+#endif
+
+
+#ifdef AUTODARTS_ARDUINO_WEBSOCKETS
+  // Adapter for WebsocketsClient (gilmaimon/ArduinoWebsockets). Its
+  // connect() blocks for the TCP connect and the handshake, so every attempt
+  // runs on a short-lived task and poll() leaves the client alone until the
+  // attempt is done. Events are reported from poll() and close() only, so
+  // they always reach the board on the loop task.
+  class ArduinoWebsocketsTransport : public Transport {
+  public:
+    ArduinoWebsocketsTransport() {
+      _connection = newConnection();
+    }
+
+    bool open(const String& host, uint16_t port, const char* path) override {
+      close();
+      _connection->host = host;
+      _connection->port = port;
+      _connection->path = path;
+      _enabled = true;
+      return connect();
+    }
+
+    void close() override {
+      _enabled = false;
+      _attempting = false;
+      // An attempt in progress is abandoned, its task closes the socket
+      // once it dropped the last reference to the connection
+      if (_connection->connecting) {
+        _connection = newConnection();
+      }
+      else {
+        _connection->websocket.close();
+      }
+      setConnected(false);
+    }
+
+    bool poll() override {
+      if (_connection->connecting) {
+        return false;
+      }
+      if (_attempting) {
+        _attempting = false;
+        setConnected(_connection->connected);
+      }
+      if (_connected) {
+        bool delivered = _connection->websocket.poll();
+        if (!_connection->websocket.available()) {
+          _lastAttempt = millis();
+          setConnected(false);
+        }
+        return delivered;
+      }
+      // Reconnect like WebSocketsClient does
+      if (_enabled && (millis() - _lastAttempt) >= _reconnectInterval) {
+        connect();
+      }
+      return false;
+    }
+
+  private:
+    // Shared with the task of an attempt, which may outlive the transport.
+    // The task sets connected before it clears connecting, the loop only
+    // touches the connection while connecting is clear.
+    struct Connection {
+      websockets::WebsocketsClient websocket;
+      String   host;
+      String   path;
+      uint16_t port = 0;
+      std::atomic<bool> connecting{false};
+      bool     connected = false;
+    };
+
+    typedef std::shared_ptr<Connection> ConnectionPtr;
+
+    ConnectionPtr newConnection() {
+      ConnectionPtr connection = std::make_shared<Connection>();
+      connection->websocket.onMessage([this](websockets::WebsocketsMessage message) {
+        // The message is our own copy, so its buffer may be handed out mutable
+        websockets::WSString& data = const_cast<websockets::WSString&>(message.rawData());
+        _onEventCallback(Type::TEXT, &data[0], data.size());
+      });
+      if (_connection) {
+        connection->host = _connection->host;
+        connection->port = _connection->port;
+        connection->path = _connection->path;
+      }
+      return connection;
+    }
+
+    bool connect() {
+      _lastAttempt = millis();
+      _connection->connecting = true;
+      ConnectionPtr* connection = new ConnectionPtr(_connection);
+      if (xTaskCreate(&ArduinoWebsocketsTransport::task, "wsconnect", 4096, connection, 1, nullptr) != pdPASS) {
+        LOG_ERROR("Transport", F("Could not create connect task!"));
+        _connection->connecting = false;
+        delete connection;
+        return false;
+      }
+      _attempting = true;
+      return true;
+    }
+
+    static void task(void* parameter) {
+      ConnectionPtr* connection = static_cast<ConnectionPtr*>(parameter);
+      Connection& current = **connection;
+      current.connected = current.websocket.connect(current.host, current.port, current.path);
+      current.connecting = false;
+      delete connection;
+      vTaskDelete(nullptr);
+    }
+
+    void setConnected(bool connected) {
+      if (connected != _connected) {
+        _connected = connected;
+        _onEventCallback(connected ? Type::CONNECTED : Type::DISCONNECTED, nullptr, 0);
+      }
+    }
+
+    ConnectionPtr _connection;
+    uint32_t _lastAttempt = 0;
+    bool     _enabled = false;
+    bool     _attempting = false;
+    bool     _connected = false;
+  };
+#endif
+
+
+  // Delivers injected frames in process without any socket, e.g. to measure
+  // pure parse and dispatch cost
+  class LoopbackTransport : public Transport {
+  public:
+    bool open(const String& host, uint16_t port, const char* path) override {
+      _open = true;
+      _pendingConnect = true;
+      return true;
+    }
+
+    void close() override {
+      if (_open) {
+        _open = false;
+        _frames.clear();
+        _onEventCallback(Type::DISCONNECTED, nullptr, 0);
+      }
+    }
+
+    // Queues a frame for delivery on the next poll
+    void push(const char* payload, size_t length) {
+      _frames.emplace_back(payload, payload + length);
+    }
+
+    bool poll() override {
+      if (!_open) {
+        return false;
+      }
+      if (_pendingConnect) {
+        _pendingConnect = false;
+        _onEventCallback(Type::CONNECTED, nullptr, 0);
+      }
+      if (_frames.empty()) {
+        return false;
+      }
+
+      // Copy into the scratch buffer since receivers parse in place
+      const std::vector<char>& frame = _frames.front();
+      _buffer.assign(frame.begin(), frame.end());
+      _buffer.push_back('\0');
+      _frames.pop_front();
+      _onEventCallback(Type::TEXT, _buffer.data(), _buffer.size() - 1);
+      return true;
+    }
+
+    size_t getNumPending() const {
+      return _frames.size();
+    }
+
+  private:
+    std::deque<std::vector<char>> _frames;
+    std::vector<char> _buffer;
+    bool _open = false;
+    bool _pendingConnect = false;
+  };
+
+
+#ifdef ALTERNATE_WEBSOCKET
+  typedef WebSocketsTransport DefaultTransport;
+#else
+  typedef ArduinoWebsocketsTransport DefaultTransport;
+#endif
+
+} // autodarts
+
+#endif // AutodartsTransport_h_
@@ -0,0 +1,52 @@
+#ifndef HeapHook_h_
+#define HeapHook_h_
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Counts heap allocations of the test binary by interposing malloc and its
+// relatives over the glibc allocator, operator new ends up here as well.
+// The allocator functions are defined here, include this header in a
+// single translation unit only.
+
+extern "C" {
+  void* __libc_malloc(size_t size);
+  void* __libc_calloc(size_t count, size_t size);
+  void* __libc_realloc(void* ptr, size_t size);
+  void  __libc_free(void* ptr);
+}
+
+namespace host {
+
+  // Allocations since the start of the process, tests compare snapshots
+  struct HeapHook {
+    uint32_t allocations = 0;
+  };
+
+  inline HeapHook& heapHook() {
+    static HeapHook value;
+    return value;
+  }
+
+} // host
+
+extern "C" void* malloc(size_t size) {
+  host::heapHook().allocations++;
+  return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t count, size_t size) {
+  host::heapHook().allocations++;
+  return __libc_calloc(count, size);
+}
+
+extern "C" void* realloc(void* ptr, size_t size) {
+  host::heapHook().allocations++;
+  return __libc_realloc(ptr, size);
+}
+
+extern "C" void free(void* ptr) {
+  __libc_free(ptr);
+}
+
+#endif // HeapHook_h_
@@ -0,0 +1,136 @@
+#ifndef MockBoard_h_
+#define MockBoard_h_
+
+// Emits the message mix of AutodartsLoadGenerator.ino into a loopback
+// transport instead of a websocket server. Messages carry a sequence number
+// and the send time on the fake clock like the sketch's, so builds with
+// AUTODARTS_LOAD_TEST count dropped and late events. disconnect() drops the
+// connection like the sketch's scripted disconnects, the client is accepted
+// again on its next poll.
+
+#include <inttypes.h>
+#include <stdio.h>
+
+#include <Arduino.h>
+
+#include "AutodartsTransport.h"
+
+struct MockBoard {
+  // Message intervals in milliseconds, 0 disables the message type
+  struct Intervals {
+    uint32_t state       = 100;
+    uint32_t stats       = 50;
+    uint32_t camState    = 1000;
+    uint32_t camStats    = 50;
+    uint32_t motionState = 0;
+  };
+
+  struct Schedule {
+    uint32_t interval = 0;
+    uint32_t next = 0;
+  };
+
+  autodarts::LoopbackTransport* transport = nullptr;
+  uint32_t seq = 0;
+  uint32_t numSent = 0;
+  uint32_t numLate = 0;
+  int16_t  numThrows = 0;
+  uint8_t  step = 0;
+  Schedule state, stats, camState, camStats, motionState;
+  char     message[384];
+
+  void begin(autodarts::LoopbackTransport* loopback) {
+    begin(loopback, Intervals());
+  }
+
+  void begin(autodarts::LoopbackTransport* loopback, const Intervals& intervals) {
+    uint32_t now = millis();
+    transport = loopback;
+    seq = 0;
+    state.interval       = intervals.state;
+    stats.interval       = intervals.stats;
+    camState.interval    = intervals.camState;
+    camStats.interval    = intervals.camStats;
+    motionState.interval = intervals.motionState;
+    for (Schedule* schedule : {&state, &stats, &camState, &camStats, &motionState}) {
+      schedule->next = now;
+    }
+  }
+
+  // Queues the messages that are due
+  void update() {
+    uint32_t now = millis();
+    if (due(state, now)) {
+      sendState(now);
+    }
+    if (due(stats, now)) {
+      send(snprintf(message, sizeof(message),
+        "{\"seq\":%" PRIu32 ",\"ts\":%" PRIu32 ",\"type\":\"stats\",\"data\":{\"fps\":%" PRIu32 ",\"resolution\":{\"width\":1280,\"height\":720}}}",
+        seq, now, 28 + (now % 5)));
+    }
+    if (due(camState, now)) {
+      send(snprintf(message, sizeof(message),
+        "{\"seq\":%" PRIu32 ",\"ts\":%" PRIu32 ",\"type\":\"cam_state\",\"data\":{\"isOpened\":true,\"isRunning\":true}}",
+        seq, now));
+    }
+    if (due(camStats, now)) {
+      for (uint8_t id = 0; id < AUTODARTS_NUM_CAMERAS; id++) {
+        send(snprintf(message, sizeof(message),
+          "{\"seq\":%" PRIu32 ",\"ts\":%" PRIu32 ",\"type\":\"cam_stats\",\"data\":{\"id\":%u,\"fps\":%" PRIu32 ",\"resolution\":{\"width\":1280,\"height\":720}}}",
+          seq, now, id, 28 + (now % 5)));
+      }
+    }
+    if (due(motionState, now)) {
+      send(snprintf(message, sizeof(message),
+        "{\"seq\":%" PRIu32 ",\"ts\":%" PRIu32 ",\"type\":\"motion_state\",\"data\":{\"motion\":%s}}",
+        seq, now, (now / 1000) % 2 ? "true" : "false"));
+    }
+  }
+
+  // Frames not yet polled by the client are lost, the stream restarts at 0
+  void disconnect() {
+    transport->close();
+    transport->open("127.0.0.1", 3180, "/api/events");
+    seq = 0;
+  }
+
+  // Send time of a message, 0 if it carries none
+  static uint32_t sentAt(const char* payload) {
+    uint32_t sequence, sent;
+    return sscanf(payload, "{\"seq\":%" SCNu32 ",\"ts\":%" SCNu32, &sequence, &sent) == 2 ? sent : 0;
+  }
+
+private:
+  // Late sends are counted when the caller missed a whole interval
+  bool due(Schedule& schedule, uint32_t now) {
+    if (schedule.interval == 0 || (int32_t)(now - schedule.next) < 0) {
+      return false;
+    }
+    if (now - schedule.next >= schedule.interval) {
+      numLate++;
+      schedule.next = now;
+    }
+    schedule.next += schedule.interval;
+    return true;
+  }
+
+  void sendState(uint32_t now) {
+    static const char* events[] = {"Throw detected", "Throw detected", "Throw detected", "Takeout started", "Takeout finished"};
+    uint8_t current = step;
+    step = (step + 1) % 5;
+    numThrows = current < 3 ? current + 1 : (current == 3 ? 3 : 0);
+    send(snprintf(message, sizeof(message),
+      "{\"seq\":%" PRIu32 ",\"ts\":%" PRIu32 ",\"type\":\"state\",\"data\":{\"connected\":true,\"running\":true,\"status\":\"%s\",\"event\":\"%s\",\"numThrows\":%d}}",
+      seq, now, current < 3 ? "Throw" : "Takeout", events[current], numThrows));
+  }
+
+  void send(int length) {
+    if (length > 0 && length < (int)sizeof(message)) {
+      transport->push(message, length);
+      numSent++;
+      seq++;
+    }
+  }
+};
+
+#endif // MockBoard_h_
@@ -0,0 +1,37 @@
+#ifndef SegmentsReference_h_
+#define SegmentsReference_h_
+
+#include <math.h>
+#include <stdint.h>
+
+#include "AutodartsSegments.h"
+
+// Straightforward classification with sqrt and atan2, the reference the
+// lookup in AutodartsSegments.h is checked and benchmarked against
+inline void classifyReference(float x, float y, int8_t& number, int8_t& multiplier) {
+  static const uint8_t numbers[] = {6, 13, 4, 18, 1, 20, 5, 12, 9, 14, 11, 8, 16, 7, 19, 3, 17, 2, 15, 10};
+  double radius = sqrt(static_cast<double>(x) * x + static_cast<double>(y) * y) * 170.0;
+  if (radius <= 6.35) {
+    number = 25;
+    multiplier = 2;
+    return;
+  }
+  if (radius <= 15.9) {
+    number = 25;
+    multiplier = 1;
+    return;
+  }
+  if (radius > 170.0) {
+    number = 0;
+    multiplier = 0;
+    return;
+  }
+  double degrees = atan2(y, x) * 180.0 / M_PI;
+  if (degrees < 0) {
+    degrees += 360.0;
+  }
+  number = numbers[static_cast<int>((degrees + 9.0) / 18.0) % 20];
+  multiplier = radius >= 162.0 ? 2 : (radius >= 99.0 && radius <= 107.0) ? 3 : 1;
+}
+
+#endif // SegmentsReference_h_
@@ -0,0 +1,33 @@
+#ifndef TestUtil_h_
+#define TestUtil_h_
+
+#include <stdio.h>
+
+// Minimal assertions for the host tests, failures are counted and printed
+// with their location, main() returns the result of testResult()
+
+static int testFailures = 0;
+
+#define CHECK(condition) \
+  do { \
+    if (!(condition)) { \
+      printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+      testFailures++; \
+    } \
+  } while (0)
+
+#define CHECK_EQ(actual, expected) \
+  do { \
+    long long actualValue = (actual), expectedValue = (expected); \
+    if (actualValue != expectedValue) { \
+      printf("%s:%d: CHECK_EQ(%s, %s) failed: %lld != %lld\n", __FILE__, __LINE__, #actual, #expected, actualValue, expectedValue); \
+      testFailures++; \
+    } \
+  } while (0)
+
+static inline int testResult(const char* name) {
+  printf("%s: %s\n", name, testFailures ? "FAILED" : "OK");
+  return testFailures ? 1 : 0;
+}
+
+#endif // TestUtil_h_
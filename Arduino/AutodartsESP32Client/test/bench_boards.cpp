@@ -0,0 +1,116 @@
+// Adds 1 to 64 boards to a client, each fed by a mock board with the
+// message mix of the load generator over a loopback transport, and drives
+// them through updateBoards(). The loop runs every LOOP_MS on the fake
+// clock, or later when updateBoards() took longer. Reports the heap per
+// board, percentiles of the updateBoards() time and of the message latency
+// from send to receive, and the first board count whose p99 loop time
+// crosses the budget. The budget defaults to the one of the sketch, pass
+// another one in microseconds, e.g. scaled to the host.
+
+#include <algorithm>
+#include <chrono>
+#include <malloc.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#define LOG_LEVEL LOG_LEVEL_WARNING
+
+#include <Arduino.h>
+
+#include "AutodartsClient.h"
+#include "MockBoard.h"
+
+using namespace autodarts;
+
+static const uint32_t LOOP_MS     = 1;
+static const uint32_t RUN_MS      = 5000;
+static const uint32_t LOOP_BUDGET = 20000;
+static const uint8_t  BOARD_COUNTS[] = {1, 2, 4, 8, 16, 24, 32, 48, 64};
+
+typedef std::chrono::steady_clock Clock;
+
+template<typename T>
+static T percentile(std::vector<T>& values, uint8_t percent) {
+  if (values.empty()) {
+    return 0;
+  }
+  size_t idx = (values.size() - 1) * percent / 100;
+  std::nth_element(values.begin(), values.begin() + idx, values.end());
+  return values[idx];
+}
+
+static size_t heapInUse() {
+  return mallinfo2().uordblks;
+}
+
+// Returns the p99 loop time
+static double run(uint8_t numBoards) {
+  // Reserved up front, so only the boards count against the heap
+  std::vector<double> loops;
+  std::vector<uint32_t> latencies;
+  loops.reserve(RUN_MS / LOOP_MS);
+  latencies.reserve(RUN_MS / 10 * numBoards);
+  std::vector<MockBoard> mocks(numBoards);
+
+  Client client;
+  size_t heapBefore = heapInUse();
+  for (uint8_t idx = 0; idx < numBoards; idx++) {
+    client.addBoard("Board " + String(idx), "board-" + String(idx), "1.0", IPAddress(127, 0, 0, 1), 3180 + idx);
+    LoopbackTransport* transport = new LoopbackTransport;
+    client.getBoard(idx).setTransport(std::unique_ptr<Transport>(transport));
+    client.openBoard(idx);
+    mocks[idx].begin(transport);
+  }
+
+  client.onBoardMessage([&latencies](const String&, const String&, const char* payload, size_t) {
+    latencies.push_back(millis() - MockBoard::sentAt(payload));
+  });
+
+  size_t heapAfter = 0;
+  uint32_t start = millis();
+  while (millis() - start < RUN_MS) {
+    for (MockBoard& mock : mocks) {
+      mock.update();
+    }
+    Clock::time_point begin = Clock::now();
+    client.updateBoards();
+    double elapsed = std::chrono::duration<double, std::micro>(Clock::now() - begin).count();
+    loops.push_back(elapsed);
+    host::advanceMicros(std::max(static_cast<uint32_t>(elapsed), LOOP_MS * 1000));
+
+    // Queues and documents have grown to their working size by now
+    if (!heapAfter && millis() - start >= 1000) {
+      heapAfter = heapInUse();
+    }
+  }
+
+  uint32_t sent = 0;
+  for (const MockBoard& mock : mocks) {
+    sent += mock.numSent;
+  }
+  double p99 = percentile(loops, 99);
+  printf("%3u %9zu %7.1f %7.1f %7.1f %7.1f %8u %6u %6u %6u\n", numBoards, (heapAfter - heapBefore) / numBoards,
+         percentile(loops, 50), percentile(loops, 90), p99, *std::max_element(loops.begin(), loops.end()),
+         sent, percentile(latencies, 50), percentile(latencies, 99), *std::max_element(latencies.begin(), latencies.end()));
+  return p99;
+}
+
+int main(int argc, char** argv) {
+  uint32_t budget = argc > 1 ? strtoul(argv[1], nullptr, 10) : LOOP_BUDGET;
+  printf("loop every %ums for %ums, budget %uus\n", LOOP_MS, RUN_MS, budget);
+  printf("%3s %9s %7s %7s %7s %7s %8s %6s %6s %6s\n", "N", "heap/brd", "p50us", "p90us", "p99us", "maxus", "messages", "p50ms", "p99ms", "maxms");
+  uint8_t crossed = 0;
+  for (uint8_t numBoards : BOARD_COUNTS) {
+    if (run(numBoards) > budget && !crossed) {
+      crossed = numBoards;
+    }
+  }
+  if (crossed) {
+    printf("p99 loop time crosses the budget at %u boards\n", crossed);
+  }
+  else {
+    printf("p99 loop time stays within the budget up to %u boards\n", BOARD_COUNTS[sizeof(BOARD_COUNTS) - 1]);
+  }
+  return 0;
+}
@@ -0,0 +1,60 @@
+// Compares the cost of a table lookup with a brute force search for the
+// same checkout, the search is what the table replaces.
+
+#include <chrono>
+
+#include "AutodartsCheckout.h"
+
+using namespace autodarts;
+
+static const int ITERATIONS = 200;
+
+// Fewest darts to finish on a double, searching trebles down to singles
+static uint32_t search(int16_t remaining) {
+  static const uint8_t multipliers[] = {3, 2, 1};
+  for (uint8_t numDarts = 1; numDarts <= 3; numDarts++) {
+    for (uint8_t finish = 1; finish <= 25; finish = finish == 20 ? 25 : finish + 1) {
+      int16_t rest = remaining - 2 * finish;
+      if (numDarts == 1 && rest == 0) {
+        return checkout::pack(checkout::dart(2, finish));
+      }
+      for (uint8_t m1 : multipliers) {
+        for (uint8_t n1 = 1; numDarts >= 2 && n1 <= 25; n1 = n1 == 20 ? 25 : n1 + 1) {
+          if (n1 == 25 && m1 == 3) {
+            continue;
+          }
+          int16_t rest1 = rest - m1 * n1;
+          if (numDarts == 2 && rest1 == 0) {
+            return checkout::pack(checkout::dart(m1, n1), checkout::dart(2, finish));
+          }
+          if (numDarts == 3 && rest1 > 0 && checkout::single(rest1)) {
+            return checkout::pack(checkout::dart(m1, n1), checkout::single(rest1), checkout::dart(2, finish));
+          }
+        }
+      }
+    }
+  }
+  return 0;
+}
+
+template<typename Function>
+static double nanosPerCall(Function function) {
+  volatile uint32_t sink = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int iteration = 0; iteration < ITERATIONS; iteration++) {
+    for (int16_t remaining = 2; remaining <= 170; remaining++) {
+      sink = sink + function(remaining);
+    }
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  (void)sink;
+  return std::chrono::duration<double, std::nano>(elapsed).count() / (ITERATIONS * 169.0);
+}
+
+int main() {
+  double lookup = nanosPerCall([](int16_t remaining) { return Checkout::lookup(remaining); });
+  double brute  = nanosPerCall(search);
+  printf("lookup: %.1f ns/call\n", lookup);
+  printf("search: %.1f ns/call (%.0fx)\n", brute, brute / lookup);
+  return 0;
+}
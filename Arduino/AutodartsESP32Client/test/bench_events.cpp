@@ -0,0 +1,142 @@
+// Fans board payloads out to more subscribers than the queue holds, over
+// socket pairs with a small send buffer and a send timeout like the client
+// write timeout. One subscriber never reads. Reports the cost of publish()
+// (push), of update() (pop and send), the drops of the slow subscriber and
+// when it is disconnected, and the longest update() against what a single
+// blocking send to the full socket costs.
+
+#include <chrono>
+#include <stdio.h>
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+#include <Arduino.h>
+
+#define WEBSOCKETS_SERVER_CLIENT_MAX 16
+
+#include "AutodartsEventServer.h"
+
+using namespace autodarts;
+
+static const uint16_t PORT         = 3181;
+static const uint8_t  QUEUE_SIZE   = 4;
+static const uint8_t  SEND_BUDGET  = 2;
+static const uint16_t MAX_DROPPED  = 64;
+static const int      SEND_BUFFER  = 4096;
+static const int      SEND_TIMEOUT = 50;
+static const uint32_t ROUNDS       = 2000;
+
+typedef std::chrono::steady_clock Clock;
+
+static double micros(Clock::duration duration) {
+  return std::chrono::duration<double, std::micro>(duration).count();
+}
+
+// Returns the reading end, the other one goes to the server
+static int socketPair(int& serverFd) {
+  int fds[2];
+  socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+  setsockopt(fds[0], SOL_SOCKET, SO_SNDBUF, &SEND_BUFFER, sizeof(SEND_BUFFER));
+  timeval timeout = {0, SEND_TIMEOUT * 1000};
+  setsockopt(fds[0], SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+  serverFd = fds[0];
+  return fds[1];
+}
+
+static void drain(int fd) {
+  char buffer[4096];
+  while (recv(fd, buffer, sizeof(buffer), MSG_DONTWAIT) > 0) {
+  }
+}
+
+// What one synchronous send to a subscriber that stopped reading costs
+static double blockingSend(const std::string& payload) {
+  int serverFd;
+  int reader = socketPair(serverFd);
+  WebSocketsServer server(PORT + 1);
+  server.begin();
+  host::wss::connect(PORT + 1, serverFd);
+  server.loop();
+  double longest = 0;
+  for (int idx = 0; idx < 64; idx++) {
+    auto start = Clock::now();
+    bool sent = server.sendTXT(0, reinterpret_cast<const uint8_t*>(payload.data()), payload.size());
+    longest = std::max(longest, micros(Clock::now() - start));
+    if (!sent) {
+      break;
+    }
+  }
+  close(reader);
+  return longest;
+}
+
+int main() {
+  EventServer events(PORT, QUEUE_SIZE, SEND_BUDGET);
+  events.setMaxDropped(MAX_DROPPED);
+  events.begin();
+
+  std::vector<int> readers;
+  int slowFd = -1;
+  for (uint8_t num = 0; num < WEBSOCKETS_SERVER_CLIENT_MAX; num++) {
+    int serverFd;
+    readers.push_back(socketPair(serverFd));
+    host::wss::connect(PORT, serverFd);
+    if (num == WEBSOCKETS_SERVER_CLIENT_MAX - 1) {
+      slowFd = readers.back();
+    }
+  }
+  events.update();
+  printf("%u subscribers, queue of %u, send budget %u\n", events.getNumSubscribers(), QUEUE_SIZE, SEND_BUDGET);
+
+  std::string payload = "{\"type\":\"state\",\"data\":{\"connected\":true,\"running\":true,\"status\":\"Throw\",\"event\":\"Throw detected\",\"numThrows\":2,\"throws\":[";
+  while (payload.size() < 900) {
+    payload += "{\"segment\":{\"name\":\"T20\",\"number\":20,\"multiplier\":3},\"coords\":{\"x\":0.01,\"y\":0.42}},";
+  }
+  payload += "{}]}}";
+
+  double pushTotal = 0, pushMax = 0, updateTotal = 0, updateMax = 0;
+  uint32_t payloads = 0, disconnectRound = 0;
+  uint8_t subscribers = events.getNumSubscribers();
+  for (uint32_t round = 0; round < ROUNDS; round++) {
+    // Bursts of three payloads every other round, as a throw, its state and
+    // the camera stats, more than one update() sends but less than two
+    for (int burst = 0; round % 2 == 0 && burst < 3; burst++) {
+      auto start = Clock::now();
+      events.publish("Board", "board-1", payload.data(), payload.size());
+      double elapsed = micros(Clock::now() - start);
+      pushTotal += elapsed;
+      pushMax = std::max(pushMax, elapsed);
+      payloads++;
+    }
+    auto start = Clock::now();
+    events.update();
+    double elapsed = micros(Clock::now() - start);
+    updateTotal += elapsed;
+    updateMax = std::max(updateMax, elapsed);
+    if (!disconnectRound && events.getNumSubscribers() < subscribers) {
+      disconnectRound = round;
+    }
+    for (int fd : readers) {
+      if (fd != slowFd) {
+        drain(fd);
+      }
+    }
+  }
+
+  uint32_t dropped = 0;
+  for (uint8_t num = 0; num + 1 < WEBSOCKETS_SERVER_CLIENT_MAX; num++) {
+    dropped += events.getDropped(num);
+  }
+  printf("publish: %8.2fus avg %8.2fus max (%u payloads)\n", pushTotal / payloads, pushMax, payloads);
+  printf("update:  %8.2fus avg %8.2fus max (%u rounds)\n", updateTotal / ROUNDS, updateMax, ROUNDS);
+  printf("drops:   %u by readers, %u by the slow subscriber\n", dropped, events.getDropped(WEBSOCKETS_SERVER_CLIENT_MAX - 1));
+  printf("slow subscriber disconnected in round %u, %u subscribers left\n", disconnectRound, events.getNumSubscribers());
+  printf("blocking send to a full socket: %.2fus (send timeout %ums)\n", blockingSend(payload), SEND_TIMEOUT);
+
+  for (int fd : readers) {
+    close(fd);
+  }
+  return 0;
+}
@@ -0,0 +1,83 @@
+// Replays a tournament night of events through the journal format into a
+// file standing in for flash. Reports write amplification, the longest
+// append (what the loop waits for) and the longest batch write (what the
+// journal task waits for).
+
+#include <chrono>
+#include <random>
+#include <stdio.h>
+#include <unistd.h>
+
+#include "AutodartsJournalFormat.h"
+
+using namespace autodarts;
+
+static const uint16_t BUFFER_SIZE    = 2048;
+static const uint32_t FLUSH_INTERVAL = 10000;
+static const uint32_t SEGMENT_SIZE   = 64 * 1024;
+static const uint16_t FLASH_PAGE     = 256;
+static const uint8_t  NUM_BOARDS     = 8;
+
+typedef std::chrono::steady_clock Clock;
+
+static double micros(Clock::duration duration) {
+  return std::chrono::duration<double, std::micro>(duration).count();
+}
+
+int main() {
+  char path[] = "/tmp/journalXXXXXX";
+  int fd = mkstemp(path);
+  FILE* file = fdopen(fd, "wb");
+  uint8_t header[journal::SEGMENT_HEADER_SIZE];
+  journal::writeSegmentHeader(header, 1);
+  fwrite(header, 1, sizeof(header), file);
+
+  std::mt19937 random(7);
+  std::uniform_int_distribution<uint32_t> gap(50, 4000);
+  journal::BatchT<BUFFER_SIZE> batch;
+  uint32_t now = 0, lastFlush = 0, sequence = 1;
+  uint64_t written = sizeof(header), recordBytes = 0, segmentBytes = sizeof(header);
+  uint32_t records = 0, batches = 0;
+  double maxAppend = 0, maxWrite = 0;
+
+  // Six hours of throws, takeouts and the odd reconnect
+  while (now < 6 * 3600 * 1000u) {
+    now += gap(random) / NUM_BOARDS;
+    auto start = Clock::now();
+    uint16_t size = batch.getSize();
+    batch.append(now, random() % NUM_BOARDS, random() % 100 ? 8 : 0x81);
+    maxAppend = std::max(maxAppend, micros(Clock::now() - start));
+    recordBytes += batch.getSize() - size;
+    records++;
+
+    if (batch.getSize() >= BUFFER_SIZE * 3 / 4 || now - lastFlush >= FLUSH_INTERVAL) {
+      start = Clock::now();
+      const uint8_t* data = batch.finish();
+      if (segmentBytes + batch.getSize() > SEGMENT_SIZE) {
+        fflush(file);
+        rewind(file);
+        journal::writeSegmentHeader(header, ++sequence);
+        fwrite(header, 1, sizeof(header), file);
+        written += sizeof(header);
+        segmentBytes = sizeof(header);
+      }
+      fwrite(data, 1, batch.getSize(), file);
+      fflush(file);
+      fsync(fd);
+      maxWrite = std::max(maxWrite, micros(Clock::now() - start));
+      written += batch.getSize();
+      segmentBytes += batch.getSize();
+      batches++;
+      batch.reset();
+      lastFlush = now;
+    }
+  }
+  fclose(file);
+  unlink(path);
+
+  printf("records: %u in %u batches, %.2f bytes/record\n", records, batches, static_cast<double>(recordBytes) / records);
+  printf("write amplification: %.2f batched, %.1f with one page write per record\n",
+         static_cast<double>(written) / recordBytes, static_cast<double>(FLASH_PAGE) * records / recordBytes);
+  printf("max append: %.2fus, max batch write: %.0fus\n", maxAppend, maxWrite);
+  return 0;
+}
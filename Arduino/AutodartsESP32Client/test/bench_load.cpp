@@ -0,0 +1,121 @@
+// Host counterpart of AutodartsLoadGenerator.ino. Mock boards send the
+// sketch's message mix over loopback transports to a client built with
+// AUTODARTS_LOAD_TEST. They drop the connection every DISCONNECT_MS, and
+// the client is driven through updateBoards() on a 1ms loop of the fake
+// clock. Reports like the sketch every REPORT_MS: messages sent and
+// received, the events the client saw dropped or late, and the longest
+// updateBoards(). Then prints the end-to-end totals.
+//
+// Usage: bench_load [boards] [seconds] [rate]. rate multiplies the message
+// rates of the sketch, raise it and the board count to find the limits of
+// updateBoards(). Socket I/O of the websocket libraries is not part of the
+// figures, bench_transports compares them.
+
+#include <algorithm>
+#include <chrono>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#define AUTODARTS_LOAD_TEST
+#define LOG_LEVEL LOG_LEVEL_WARNING
+
+#include <Arduino.h>
+
+#include "AutodartsClient.h"
+#include "MockBoard.h"
+
+using namespace autodarts;
+
+static const uint32_t LOOP_MS       = 1;
+static const uint32_t DISCONNECT_MS = 30000;
+static const uint32_t REPORT_MS     = 5000;
+
+typedef std::chrono::steady_clock Clock;
+
+int main(int argc, char** argv) {
+  uint8_t  numBoards = argc > 1 ? atoi(argv[1]) : 4;
+  uint32_t runMs     = (argc > 2 ? atoi(argv[2]) : 60) * 1000;
+  float    rate      = argc > 3 ? atof(argv[3]) : 1.0f;
+
+  MockBoard::Intervals intervals;
+  for (uint32_t* interval : {&intervals.state, &intervals.stats, &intervals.camState, &intervals.camStats, &intervals.motionState}) {
+    *interval = *interval ? std::max<uint32_t>(1, *interval / rate) : 0;
+  }
+
+  Client client;
+  std::vector<MockBoard> mocks(numBoards);
+  for (uint8_t idx = 0; idx < numBoards; idx++) {
+    client.addBoard("Board " + String(idx), "board-" + String(idx), "1.0", IPAddress(127, 0, 0, 1), 3180 + idx);
+    LoopbackTransport* transport = new LoopbackTransport;
+    client.getBoard(idx).setTransport(std::unique_ptr<Transport>(transport));
+    client.openBoard(idx);
+    mocks[idx].begin(transport, intervals);
+  }
+  printf("%u boards for %" PRIu32 "s at %.1fx the sketch's rates\n", numBoards, runMs / 1000, rate);
+
+  uint32_t start = millis(), nextReport = start + REPORT_MS, nextDisconnect = start + DISCONNECT_MS;
+  uint32_t reportSent = 0, reportReceived = 0;
+  double maxLoop = 0, reportMaxLoop = 0, totalLoop = 0;
+  Clock::time_point realStart = Clock::now();
+  while (millis() - start < runMs) {
+    for (MockBoard& mock : mocks) {
+      mock.update();
+    }
+    Clock::time_point begin = Clock::now();
+    client.updateBoards();
+    double elapsed = std::chrono::duration<double, std::micro>(Clock::now() - begin).count();
+    totalLoop += elapsed;
+    reportMaxLoop = std::max(reportMaxLoop, elapsed);
+    host::advanceMicros(std::max(static_cast<uint32_t>(elapsed), LOOP_MS * 1000));
+
+    if ((int32_t)(millis() - nextDisconnect) >= 0) {
+      for (MockBoard& mock : mocks) {
+        mock.disconnect();
+      }
+      nextDisconnect += DISCONNECT_MS;
+    }
+
+    if ((int32_t)(millis() - nextReport) >= 0) {
+      uint32_t sent = 0, received = 0, dropped = 0, late = 0;
+      for (uint8_t idx = 0; idx < numBoards; idx++) {
+        sent     += mocks[idx].numSent;
+        received += client.getBoard(idx).getNumMessages();
+        dropped  += client.getBoard(idx).getNumDropped();
+        late     += client.getBoard(idx).getNumLate();
+      }
+      printf("%6" PRIu32 "s: sent %" PRIu32 "/s received %" PRIu32 "/s dropped %" PRIu32 " late %" PRIu32 " max loop %.1fus\n",
+             (millis() - start) / 1000, (sent - reportSent) * 1000 / REPORT_MS, (received - reportReceived) * 1000 / REPORT_MS,
+             dropped, late, reportMaxLoop);
+      reportSent = sent;
+      reportReceived = received;
+      maxLoop = std::max(maxLoop, reportMaxLoop);
+      reportMaxLoop = 0;
+      nextReport += REPORT_MS;
+    }
+  }
+  double realMs = std::chrono::duration<double, std::milli>(Clock::now() - realStart).count();
+
+  uint32_t sent = 0, senderLate = 0;
+  for (const MockBoard& mock : mocks) {
+    sent += mock.numSent;
+    senderLate += mock.numLate;
+  }
+  printf("%-8s %9s %9s %8s %6s\n", "board", "messages", "bytes", "dropped", "late");
+  uint32_t received = 0, dropped = 0, late = 0;
+  for (uint8_t idx = 0; idx < numBoards; idx++) {
+    const Board& board = client.getBoard(idx);
+    printf("%-8s %9" PRIu32 " %9" PRIu32 " %8" PRIu32 " %6" PRIu32 "\n", board.getName().c_str(),
+           board.getNumMessages(), board.getNumBytes(), board.getNumDropped(), board.getNumLate());
+    received += board.getNumMessages();
+    dropped  += board.getNumDropped();
+    late     += board.getNumLate();
+  }
+  printf("sent %" PRIu32 " (%" PRIu32 " late), received %" PRIu32 ", dropped %" PRIu32 ", late %" PRIu32 "\n",
+         sent, senderLate, received, dropped, late);
+  printf("throughput %.0f messages/s of the fake clock, %.0f messages/s of CPU in updateBoards(), max loop %.1fus\n",
+         received * 1000.0 / runMs, received * 1e6 / totalLoop, maxLoop);
+  printf("ran %.0fms for %" PRIu32 "ms of the fake clock\n", realMs, runMs);
+  return 0;
+}
@@ -0,0 +1,42 @@
+// Classification throughput of the tangent lookup against atan2.
+
+#include <chrono>
+#include <random>
+#include <stdio.h>
+#include <vector>
+
+#include "AutodartsSegments.h"
+#include "SegmentsReference.h"
+
+using namespace autodarts;
+
+static const size_t NUM_POINTS = 1 << 20;
+
+template<typename Function>
+static double nanosPerPoint(const std::vector<float>& points, Function classify) {
+  volatile int32_t sink = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t idx = 0; idx < points.size(); idx += 2) {
+    int8_t number, multiplier;
+    classify(points[idx], points[idx + 1], number, multiplier);
+    sink = sink + number * multiplier;
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  (void)sink;
+  return std::chrono::duration<double, std::nano>(elapsed).count() / (points.size() / 2);
+}
+
+int main() {
+  std::mt19937 random(42);
+  std::uniform_real_distribution<float> coordinate(-1.1f, 1.1f);
+  std::vector<float> points(2 * NUM_POINTS);
+  for (float& value : points) {
+    value = coordinate(random);
+  }
+
+  double lookup = nanosPerPoint(points, segments::classify);
+  double trig   = nanosPerPoint(points, classifyReference);
+  printf("lookup: %.1f ns/point (%.1f M/s)\n", lookup, 1000.0 / lookup);
+  printf("atan2:  %.1f ns/point (%.1f M/s)\n", trig, 1000.0 / trig);
+  return 0;
+}
@@ -0,0 +1,127 @@
+// Runs the same boards over each transport side by side. The websocket
+// endpoints take HANDSHAKE_MS to answer the handshake and one of them
+// refuses it, so the boards keep reconnecting to it. Reports how long the
+// boards took to connect, the longest update() of the loop while they
+// connect and reconnect, and the cost of an update() that delivers a frame
+// once they are connected. The loopback shows the parse and dispatch cost
+// without any socket.
+
+#define ALTERNATE_WEBSOCKET
+#define AUTODARTS_ARDUINO_WEBSOCKETS
+#define LOG_LEVEL LOG_LEVEL_WARNING
+
+#include <chrono>
+#include <stdio.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <Arduino.h>
+
+#include "AutodartsBoard.h"
+
+using namespace autodarts;
+
+static const uint8_t  NUM_BOARDS   = 8;
+static const uint32_t HANDSHAKE_MS = 20;
+static const uint16_t RECONNECT_MS = 200;
+static const uint32_t RUN_MS       = 2000;
+static const uint32_t NUM_FRAMES   = 2000;
+
+typedef std::chrono::steady_clock Clock;
+
+static double micros(Clock::duration duration) {
+  return std::chrono::duration<double, std::micro>(duration).count();
+}
+
+static std::string state(int numThrows) {
+  return "{\"type\":\"state\",\"data\":{\"connected\":true,\"running\":true,\"status\":\"Throw\",\"event\":\"Throw detected\",\"numThrows\":" +
+         std::to_string(numThrows) + "}}";
+}
+
+static std::string endpoint(uint8_t idx) {
+  return host::ws::key("127.0.0.1", 3180 + idx, "/api/events");
+}
+
+static void deliver(LoopbackTransport& transport, uint8_t, const std::string& frame) {
+  transport.push(frame.data(), frame.size());
+}
+
+static void deliver(Transport&, uint8_t idx, const std::string& frame) {
+  host::ws::push(endpoint(idx), frame);
+}
+
+// Updates all boards once and returns how long that took
+static double updateAll(std::vector<std::unique_ptr<Board>>& boards) {
+  auto start = Clock::now();
+  for (std::unique_ptr<Board>& board : boards) {
+    board->update();
+  }
+  return micros(Clock::now() - start);
+}
+
+template<typename TTransport>
+static void run(const char* name) {
+  host::ws::reset();
+  for (uint8_t idx = 0; idx < NUM_BOARDS; idx++) {
+    host::ws::with(endpoint(idx), [idx](host::ws::Endpoint& endpoint) {
+      endpoint.handshakeMillis = HANDSHAKE_MS;
+      endpoint.accept = idx + 1 < NUM_BOARDS;
+    });
+  }
+
+  std::vector<std::unique_ptr<Board>> boards;
+  std::vector<TTransport*> transports;
+  for (uint8_t idx = 0; idx < NUM_BOARDS; idx++) {
+    boards.emplace_back(new Board("Board", "board-" + String(idx), "1.0", "127.0.0.1:" + String(3180 + idx)));
+    transports.push_back(new TTransport);
+    boards.back()->setTransport(std::unique_ptr<Transport>(transports.back()));
+    boards.back()->setReconnectInterval(RECONNECT_MS);
+    boards.back()->open();
+  }
+
+  // Connect and keep reconnecting to the refusing endpoint for a while
+  double connectMax = 0;
+  uint32_t start = millis(), connected = 0;
+  while (millis() - start < RUN_MS) {
+    // The fake clock follows real time
+    auto begin = Clock::now();
+    connectMax = std::max(connectMax, updateAll(boards));
+    uint8_t numOpen = 0;
+    for (std::unique_ptr<Board>& board : boards) {
+      numOpen += board->isOpen();
+    }
+    if (!connected && numOpen == NUM_BOARDS - 1) {
+      connected = millis() - start;
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(500));
+    host::advanceMicros(micros(Clock::now() - begin));
+  }
+
+  double frameTotal = 0, frameMax = 0;
+  for (uint32_t frame = 0; frame < NUM_FRAMES; frame++) {
+    uint8_t idx = frame % (NUM_BOARDS - 1);
+    std::string message = state(frame % 3);
+    deliver(*transports[idx], idx, message);
+    auto begin = Clock::now();
+    boards[idx]->update();
+    double elapsed = micros(Clock::now() - begin);
+    frameTotal += elapsed;
+    frameMax = std::max(frameMax, elapsed);
+  }
+
+  uint32_t messages = 0;
+  for (std::unique_ptr<Board>& board : boards) {
+    messages += board->getNumMessages();
+  }
+  printf("%-18s connected in %5ums, longest loop %9.1fus, frame %6.2fus avg %8.1fus max, %u messages\n",
+         name, connected, connectMax, frameTotal / NUM_FRAMES, frameMax, messages);
+}
+
+int main() {
+  printf("%u boards, handshake %ums, one refusing, reconnect every %ums\n", NUM_BOARDS, HANDSHAKE_MS, RECONNECT_MS);
+  run<WebSocketsTransport>("WebSocketsClient");
+  run<ArduinoWebsocketsTransport>("ArduinoWebsockets");
+  run<LoopbackTransport>("Loopback");
+  return 0;
+}
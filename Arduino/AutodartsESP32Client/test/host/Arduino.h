@@ -0,0 +1,114 @@
+#ifndef HostArduino_h_
+#define HostArduino_h_
+
+// Just enough of the Arduino core for the host tests. Time only advances
+// when a test moves the fake clock.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <functional>
+#include <string>
+
+#include "WString.h"
+#include "Print.h"
+#include "Stream.h"
+#include "IPAddress.h"
+#include "freertos/FreeRTOS.h"
+
+namespace host {
+
+  inline uint32_t& clockMicros() {
+    static uint32_t value = 0;
+    return value;
+  }
+
+  inline void advanceMicros(uint32_t micros) {
+    clockMicros() += micros;
+  }
+
+  // Heap figures reported by ESP, tests set them to model the target
+  struct Heap {
+    uint32_t freeHeap    = 200000;
+    uint32_t minFreeHeap = 200000;
+    uint32_t maxAlloc    = 110000;
+  };
+
+  inline Heap& heap() {
+    static Heap value;
+    return value;
+  }
+
+} // host
+
+inline uint32_t micros() {
+  return host::clockMicros();
+}
+
+inline uint32_t millis() {
+  return host::clockMicros() / 1000;
+}
+
+inline void delay(uint32_t ms) {
+  host::advanceMicros(ms * 1000);
+}
+
+inline void yield() {}
+
+using std::min;
+using std::max;
+
+class HardwareSerial : public Stream {
+public:
+  void begin(unsigned long) {}
+
+  int available() override {
+    return 0;
+  }
+
+  int read() override {
+    return -1;
+  }
+
+  int peek() override {
+    return -1;
+  }
+
+  size_t write(uint8_t c) override {
+    return fwrite(&c, 1, 1, stdout);
+  }
+
+  size_t write(const uint8_t* buffer, size_t size) override {
+    return fwrite(buffer, 1, size, stdout);
+  }
+};
+
+static HardwareSerial Serial __attribute__((unused));
+
+class EspClass {
+public:
+  uint32_t getFreeHeap() const {
+    return host::heap().freeHeap;
+  }
+
+  uint32_t getMinFreeHeap() const {
+    return host::heap().minFreeHeap;
+  }
+
+  uint32_t getMaxAllocHeap() const {
+    return host::heap().maxAlloc;
+  }
+
+  uint32_t getCycleCount() const {
+    return host::clockMicros() * 240u;
+  }
+
+  uint32_t getCpuFreqMHz() const {
+    return 240;
+  }
+};
+
+static EspClass ESP __attribute__((unused));
+
+#endif // HostArduino_h_
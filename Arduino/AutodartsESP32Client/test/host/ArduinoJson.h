@@ -0,0 +1,1768 @@
+#ifndef HostArduinoJson_h_
+#define HostArduinoJson_h_
+
+// The part of ArduinoJson 6 the client headers use, with its memory model:
+// a document allocates its pool once, every value, member or element takes
+// a 16 byte slot like on the 32-bit target and copied strings take their
+// length plus one. Parsing a char* input is zero-copy, strings are
+// unescaped in place and point into the input. Neither parsing nor
+// building a document touches the heap.
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <type_traits>
+
+#include <Arduino.h>
+
+namespace host {
+  namespace json {
+
+    static const size_t SLOT_SIZE = 16;
+    static const uint8_t NESTING_LIMIT = 10;
+
+    enum Type : uint8_t {
+      NUL,
+      BOOL,
+      INT,
+      UINT,
+      FLOAT,
+      STRING,
+      ARRAY,
+      OBJECT,
+    };
+
+    struct Node {
+      Type        type = NUL;
+      const char* key = nullptr;
+      Node*       next = nullptr;
+      union {
+        bool        b;
+        int64_t     i;
+        uint64_t    u;
+        double      f;
+        const char* s;
+        struct {
+          Node* head;
+          Node* tail;
+        } c;
+      } v;
+
+      void setNull() {
+        type = NUL;
+      }
+
+      void setContainer(Type container) {
+        type = container;
+        v.c.head = nullptr;
+        v.c.tail = nullptr;
+      }
+
+      size_t size() const {
+        size_t count = 0;
+        if (type == ARRAY || type == OBJECT) {
+          for (const Node* child = v.c.head; child; child = child->next) {
+            count++;
+          }
+        }
+        return count;
+      }
+
+      const Node* member(const char* name) const {
+        if (type != OBJECT || name == nullptr) {
+          return nullptr;
+        }
+        for (const Node* child = v.c.head; child; child = child->next) {
+          if (strcmp(child->key, name) == 0) {
+            return child;
+          }
+        }
+        return nullptr;
+      }
+
+      const Node* element(size_t idx) const {
+        if (type != ARRAY) {
+          return nullptr;
+        }
+        const Node* child = v.c.head;
+        while (child && idx--) {
+          child = child->next;
+        }
+        return child;
+      }
+
+      void append(Node* child) {
+        child->next = nullptr;
+        if (v.c.tail) {
+          v.c.tail->next = child;
+        }
+        else {
+          v.c.head = child;
+        }
+        v.c.tail = child;
+      }
+    };
+
+    // Slots and copied strings share the capacity. Nodes live in their own
+    // array since host nodes are larger than the 16 bytes accounted.
+    class Pool {
+    public:
+      explicit Pool(size_t capacity = 0) {
+        allocate(capacity);
+      }
+
+      ~Pool() {
+        free(_memory);
+      }
+
+      Pool(const Pool&) = delete;
+      Pool& operator=(const Pool&) = delete;
+
+      void swap(Pool& other) {
+        std::swap(_memory, other._memory);
+        std::swap(_nodes, other._nodes);
+        std::swap(_strings, other._strings);
+        std::swap(_capacity, other._capacity);
+        std::swap(_numNodes, other._numNodes);
+        std::swap(_stringSize, other._stringSize);
+        std::swap(_overflowed, other._overflowed);
+      }
+
+      void clear() {
+        _numNodes = 0;
+        _stringSize = 0;
+        _overflowed = false;
+      }
+
+      size_t capacity() const {
+        return _capacity;
+      }
+
+      size_t size() const {
+        return _numNodes * SLOT_SIZE + _stringSize;
+      }
+
+      bool overflowed() const {
+        return _overflowed;
+      }
+
+      Node* allocNode() {
+        if (size() + SLOT_SIZE > _capacity) {
+          _overflowed = true;
+          return nullptr;
+        }
+        Node* node = new (&_nodes[_numNodes++]) Node();
+        return node;
+      }
+
+      const char* copyString(const char* value, size_t length) {
+        char* target = beginString();
+        for (size_t idx = 0; target && idx < length; idx++) {
+          target = appendString(value[idx]) ? target : nullptr;
+        }
+        return target && endString() ? target : nullptr;
+      }
+
+      // Strings of unknown length are built at the end of the used area
+      char* beginString() {
+        _pending = 0;
+        return _strings + _stringSize;
+      }
+
+      bool appendString(char c) {
+        if (size() + _pending + 1 > _capacity) {
+          _overflowed = true;
+          return false;
+        }
+        _strings[_stringSize + _pending++] = c;
+        return true;
+      }
+
+      bool endString() {
+        if (!appendString('\0')) {
+          return false;
+        }
+        _stringSize += _pending;
+        return true;
+      }
+
+    private:
+      void allocate(size_t capacity) {
+        size_t numNodes = capacity / SLOT_SIZE;
+        _memory = static_cast<char*>(malloc(numNodes * sizeof(Node) + capacity + 1));
+        if (!_memory) {
+          return;
+        }
+        _nodes    = reinterpret_cast<Node*>(_memory);
+        _strings  = _memory + numNodes * sizeof(Node);
+        _capacity = capacity;
+      }
+
+      char*  _memory = nullptr;
+      Node*  _nodes = nullptr;
+      char*  _strings = nullptr;
+      size_t _capacity = 0;
+      size_t _numNodes = 0;
+      size_t _stringSize = 0;
+      size_t _pending = 0;
+      bool   _overflowed = false;
+    };
+
+    template<typename T, typename Enable = void>
+    struct Converter;
+
+  } // json
+} // host
+
+class JsonVariantConst;
+class JsonVariant;
+class JsonObjectConst;
+class JsonObject;
+class JsonArrayConst;
+class JsonArray;
+
+class JsonVariantConst {
+public:
+  JsonVariantConst() = default;
+  explicit JsonVariantConst(const host::json::Node* node) : _node(node) {}
+
+  template<typename T>
+  T as() const {
+    return host::json::Converter<T>::as(nullptr, _node);
+  }
+
+  template<typename T>
+  bool is() const {
+    return host::json::Converter<T>::is(_node);
+  }
+
+  template<typename T, typename = typename std::enable_if<!std::is_same<T, bool>::value || true>::type>
+  operator T() const {
+    return as<T>();
+  }
+
+  bool isNull() const {
+    return !_node || _node->type == host::json::NUL;
+  }
+
+  size_t size() const {
+    return _node ? _node->size() : 0;
+  }
+
+  JsonVariantConst operator[](const char* key) const {
+    return JsonVariantConst(_node ? _node->member(key) : nullptr);
+  }
+
+  JsonVariantConst operator[](const String& key) const {
+    return (*this)[key.c_str()];
+  }
+
+  template<typename T>
+  typename std::enable_if<std::is_integral<T>::value, JsonVariantConst>::type operator[](T idx) const {
+    return JsonVariantConst(_node ? _node->element(idx) : nullptr);
+  }
+
+  bool containsKey(const char* key) const {
+    return _node && _node->member(key);
+  }
+
+  template<typename T>
+  T operator|(const T& value) const {
+    return is<T>() ? as<T>() : value;
+  }
+
+  const char* operator|(const char* value) const {
+    return is<const char*>() ? as<const char*>() : value;
+  }
+
+  bool operator==(const char* value) const {
+    const char* string = as<const char*>();
+    return string && value && strcmp(string, value) == 0;
+  }
+
+  bool operator!=(const char* value) const {
+    return !(*this == value);
+  }
+
+  const host::json::Node* node() const {
+    return _node;
+  }
+
+private:
+  const host::json::Node* _node = nullptr;
+};
+
+
+class JsonObjectConst {
+public:
+  JsonObjectConst() = default;
+  explicit JsonObjectConst(const host::json::Node* node) : _node(node && node->type == host::json::OBJECT ? node : nullptr) {}
+
+  JsonVariantConst operator[](const char* key) const {
+    return JsonVariantConst(_node ? _node->member(key) : nullptr);
+  }
+
+  JsonVariantConst operator[](const String& key) const {
+    return (*this)[key.c_str()];
+  }
+
+  bool containsKey(const char* key) const {
+    return _node && _node->member(key);
+  }
+
+  bool isNull() const {
+    return !_node;
+  }
+
+  size_t size() const {
+    return _node ? _node->size() : 0;
+  }
+
+  operator JsonVariantConst() const {
+    return JsonVariantConst(_node);
+  }
+
+  const host::json::Node* node() const {
+    return _node;
+  }
+
+private:
+  const host::json::Node* _node = nullptr;
+};
+
+
+class JsonArrayConst {
+public:
+  class iterator {
+  public:
+    explicit iterator(const host::json::Node* node) : _node(node) {}
+    JsonVariantConst operator*() const { return JsonVariantConst(_node); }
+    iterator& operator++() { _node = _node->next; return *this; }
+    bool operator!=(const iterator& other) const { return _node != other._node; }
+  private:
+    const host::json::Node* _node;
+  };
+
+  JsonArrayConst() = default;
+  explicit JsonArrayConst(const host::json::Node* node) : _node(node && node->type == host::json::ARRAY ? node : nullptr) {}
+
+  template<typename T>
+  typename std::enable_if<std::is_integral<T>::value, JsonVariantConst>::type operator[](T idx) const {
+    return JsonVariantConst(_node ? _node->element(idx) : nullptr);
+  }
+
+  size_t size() const {
+    return _node ? _node->size() : 0;
+  }
+
+  bool isNull() const {
+    return !_node;
+  }
+
+  iterator begin() const {
+    return iterator(_node ? _node->v.c.head : nullptr);
+  }
+
+  iterator end() const {
+    return iterator(nullptr);
+  }
+
+  operator JsonVariantConst() const {
+    return JsonVariantConst(_node);
+  }
+
+  const host::json::Node* node() const {
+    return _node;
+  }
+
+private:
+  const host::json::Node* _node = nullptr;
+};
+
+
+// Writable reference to a value. Members and elements that do not exist
+// yet are only added once something is assigned to them.
+class JsonVariant {
+public:
+  JsonVariant() = default;
+
+  JsonVariant(host::json::Pool* pool, host::json::Node* node) : _pool(pool), _node(node) {}
+
+  JsonVariant(host::json::Pool* pool, host::json::Node* parent, const char* key, bool copyKey) :
+    _pool(pool), _node(const_cast<host::json::Node*>(parent ? parent->member(key) : nullptr)), _parent(parent), _key(key), _copyKey(copyKey) {}
+
+  JsonVariant(host::json::Pool* pool, host::json::Node* parent, size_t idx) :
+    _pool(pool), _node(const_cast<host::json::Node*>(parent ? parent->element(idx) : nullptr)), _parent(parent), _index(idx) {}
+
+  template<typename T>
+  T as() const {
+    return host::json::Converter<T>::as(_pool, _node);
+  }
+
+  template<typename T>
+  bool is() const {
+    return host::json::Converter<T>::is(_node);
+  }
+
+  template<typename T>
+  operator T() const {
+    return as<T>();
+  }
+
+  operator JsonVariantConst() const {
+    return JsonVariantConst(_node);
+  }
+
+  bool isNull() const {
+    return !_node || _node->type == host::json::NUL;
+  }
+
+  size_t size() const {
+    return _node ? _node->size() : 0;
+  }
+
+  template<typename T>
+  T operator|(const T& value) const {
+    return is<T>() ? as<T>() : value;
+  }
+
+  const char* operator|(const char* value) const {
+    return is<const char*>() ? as<const char*>() : value;
+  }
+
+  bool operator==(const char* value) const {
+    return JsonVariantConst(_node) == value;
+  }
+
+  bool containsKey(const char* key) const {
+    return _node && _node->member(key);
+  }
+
+  template<typename T>
+  typename std::enable_if<std::is_arithmetic<T>::value, JsonVariant&>::type operator=(T value) {
+    set(value);
+    return *this;
+  }
+
+  JsonVariant& operator=(const char* value) {
+    set(value);
+    return *this;
+  }
+
+  JsonVariant& operator=(char* value) {
+    set(value);
+    return *this;
+  }
+
+  JsonVariant& operator=(const String& value) {
+    set(value);
+    return *this;
+  }
+
+  JsonVariant& operator=(const JsonVariant& value) {
+    set(JsonVariantConst(value._node));
+    return *this;
+  }
+
+  template<typename T>
+  typename std::enable_if<std::is_arithmetic<T>::value, bool>::type set(T value) {
+    host::json::Node* node = resolve();
+    if (!node) {
+      return false;
+    }
+    if (std::is_same<T, bool>::value) {
+      node->type = host::json::BOOL;
+      node->v.b = value;
+    }
+    else if (std::is_floating_point<T>::value) {
+      node->type = host::json::FLOAT;
+      node->v.f = value;
+    }
+    else if (std::is_signed<T>::value) {
+      node->type = host::json::INT;
+      node->v.i = static_cast<int64_t>(value);
+    }
+    else {
+      node->type = host::json::UINT;
+      node->v.u = static_cast<uint64_t>(value);
+    }
+    return true;
+  }
+
+  // Stored by reference, like string literals
+  bool set(const char* value) {
+    host::json::Node* node = resolve();
+    if (!node) {
+      return false;
+    }
+    if (value) {
+      node->type = host::json::STRING;
+      node->v.s = value;
+    }
+    else {
+      node->setNull();
+    }
+    return true;
+  }
+
+  // Copied into the pool
+  bool set(char* value) {
+    return copy(value, value ? strlen(value) : 0);
+  }
+
+  bool set(const String& value) {
+    return copy(value.c_str(), value.length());
+  }
+
+  bool set(JsonVariantConst value);
+
+  JsonVariant operator[](const char* key) {
+    return JsonVariant(_pool, container(host::json::OBJECT), key, false);
+  }
+
+  JsonVariant operator[](char* key) {
+    return JsonVariant(_pool, container(host::json::OBJECT), key, true);
+  }
+
+  JsonVariant operator[](const String& key) {
+    return JsonVariant(_pool, container(host::json::OBJECT), key.c_str(), true);
+  }
+
+  template<typename T>
+  typename std::enable_if<std::is_integral<T>::value, JsonVariant>::type operator[](T idx) {
+    return JsonVariant(_pool, container(host::json::ARRAY), idx);
+  }
+
+  JsonObject createNestedObject(const char* key);
+  JsonArray createNestedArray(const char* key);
+  JsonObject createNestedObject();
+  JsonArray createNestedArray();
+
+  template<typename T>
+  bool add(const T& value);
+
+  template<typename T>
+  T to();
+
+  host::json::Node* node() const {
+    return _node;
+  }
+
+  host::json::Pool* pool() const {
+    return _pool;
+  }
+
+  // Adds the member or element if it does not exist yet
+  host::json::Node* resolve() {
+    if (_node || !_parent || !_pool) {
+      return _node;
+    }
+    if (_parent->type == host::json::OBJECT) {
+      const char* key = _copyKey ? _pool->copyString(_key, strlen(_key)) : _key;
+      host::json::Node* node = key ? _pool->allocNode() : nullptr;
+      if (node) {
+        node->key = key;
+        _parent->append(node);
+      }
+      _node = node;
+    }
+    else if (_parent->type == host::json::ARRAY) {
+      size_t size = _parent->size();
+      while (size++ <= _index) {
+        host::json::Node* node = _pool->allocNode();
+        if (!node) {
+          return nullptr;
+        }
+        _parent->append(node);
+        _node = node;
+      }
+    }
+    return _node;
+  }
+
+private:
+  bool copy(const char* value, size_t length) {
+    if (!value) {
+      return set(static_cast<const char*>(nullptr));
+    }
+    const char* copied = _pool ? _pool->copyString(value, length) : nullptr;
+    return copied && set(copied);
+  }
+
+  // Turns a null value into an empty container of the given type
+  host::json::Node* container(host::json::Type type) {
+    host::json::Node* node = resolve();
+    if (node && node->type == host::json::NUL) {
+      node->setContainer(type);
+    }
+    return node && node->type == type ? node : nullptr;
+  }
+
+  host::json::Pool* _pool = nullptr;
+  host::json::Node* _node = nullptr;
+  host::json::Node* _parent = nullptr;
+  const char*       _key = nullptr;
+  bool              _copyKey = false;
+  size_t            _index = 0;
+};
+
+
+class JsonObject {
+public:
+  JsonObject() = default;
+  JsonObject(host::json::Pool* pool, host::json::Node* node) :
+    _pool(pool), _node(node && node->type == host::json::OBJECT ? node : nullptr) {}
+
+  JsonVariant operator[](const char* key) const {
+    return JsonVariant(_pool, _node, key, false);
+  }
+
+  JsonVariant operator[](char* key) const {
+    return JsonVariant(_pool, _node, key, true);
+  }
+
+  JsonVariant operator[](const String& key) const {
+    return JsonVariant(_pool, _node, key.c_str(), true);
+  }
+
+  JsonObject createNestedObject(const char* key) const {
+    return (*this)[key].createNestedObject();
+  }
+
+  JsonArray createNestedArray(const char* key) const;
+
+  bool containsKey(const char* key) const {
+    return _node && _node->member(key);
+  }
+
+  bool isNull() const {
+    return !_node;
+  }
+
+  size_t size() const {
+    return _node ? _node->size() : 0;
+  }
+
+  operator JsonObjectConst() const {
+    return JsonObjectConst(_node);
+  }
+
+  operator JsonVariantConst() const {
+    return JsonVariantConst(_node);
+  }
+
+  host::json::Node* node() const {
+    return _node;
+  }
+
+private:
+  host::json::Pool* _pool = nullptr;
+  host::json::Node* _node = nullptr;
+};
+
+
+class JsonArray {
+public:
+  JsonArray() = default;
+  JsonArray(host::json::Pool* pool, host::json::Node* node) :
+    _pool(pool), _node(node && node->type == host::json::ARRAY ? node : nullptr) {}
+
+  template<typename T>
+  bool add(const T& value) const {
+    return JsonVariant(_pool, _node, size()).set(value);
+  }
+
+  bool add(const char* value) const {
+    return JsonVariant(_pool, _node, size()).set(value);
+  }
+
+  bool add(char* value) const {
+    return JsonVariant(_pool, _node, size()).set(value);
+  }
+
+  template<typename T>
+  typename std::enable_if<std::is_integral<T>::value, JsonVariant>::type operator[](T idx) const {
+    return JsonVariant(_pool, _node, idx);
+  }
+
+  JsonObject createNestedObject() const {
+    return JsonVariant(_pool, _node, size()).createNestedObject();
+  }
+
+  JsonArray createNestedArray() const {
+    return JsonVariant(_pool, _node, size()).createNestedArray();
+  }
+
+  size_t size() const {
+    return _node ? _node->size() : 0;
+  }
+
+  bool isNull() const {
+    return !_node;
+  }
+
+  JsonArrayConst::iterator begin() const {
+    return JsonArrayConst(_node).begin();
+  }
+
+  JsonArrayConst::iterator end() const {
+    return JsonArrayConst(_node).end();
+  }
+
+  operator JsonArrayConst() const {
+    return JsonArrayConst(_node);
+  }
+
+  operator JsonVariantConst() const {
+    return JsonVariantConst(_node);
+  }
+
+  host::json::Node* node() const {
+    return _node;
+  }
+
+private:
+  host::json::Pool* _pool = nullptr;
+  host::json::Node* _node = nullptr;
+};
+
+
+inline JsonObject JsonVariant::createNestedObject() {
+  host::json::Node* node = resolve();
+  if (node) {
+    node->setContainer(host::json::OBJECT);
+  }
+  return JsonObject(_pool, node);
+}
+
+inline JsonArray JsonVariant::createNestedArray() {
+  host::json::Node* node = resolve();
+  if (node) {
+    node->setContainer(host::json::ARRAY);
+  }
+  return JsonArray(_pool, node);
+}
+
+inline JsonObject JsonVariant::createNestedObject(const char* key) {
+  return (*this)[key].createNestedObject();
+}
+
+inline JsonArray JsonVariant::createNestedArray(const char* key) {
+  return (*this)[key].createNestedArray();
+}
+
+inline JsonArray JsonObject::createNestedArray(const char* key) const {
+  return (*this)[key].createNestedArray();
+}
+
+template<typename T>
+inline bool JsonVariant::add(const T& value) {
+  host::json::Node* node = container(host::json::ARRAY);
+  return node && JsonVariant(_pool, node, node->size()).set(value);
+}
+
+template<typename T>
+inline T JsonVariant::to() {
+  host::json::Node* node = resolve();
+  if (node) {
+    // Objects and arrays start out empty, not null
+    node->setNull();
+    if (std::is_same<T, JsonObject>::value) {
+      node->setContainer(host::json::OBJECT);
+    }
+    else if (std::is_same<T, JsonArray>::value) {
+      node->setContainer(host::json::ARRAY);
+    }
+  }
+  return JsonVariant(_pool, node).as<T>();
+}
+
+// Deep copy, strings are copied unless they are stored by reference
+inline bool JsonVariant::set(JsonVariantConst value) {
+  const host::json::Node* source = value.node();
+  host::json::Node* node = resolve();
+  if (!node) {
+    return false;
+  }
+  if (!source) {
+    node->setNull();
+    return true;
+  }
+  if (source->type == host::json::OBJECT || source->type == host::json::ARRAY) {
+    node->setContainer(source->type);
+    for (const host::json::Node* child = source->v.c.head; child; child = child->next) {
+      JsonVariant target = source->type == host::json::OBJECT ? JsonVariant(_pool, node, child->key, false)
+                                                              : JsonVariant(_pool, node, node->size());
+      if (!target.set(JsonVariantConst(child))) {
+        return false;
+      }
+    }
+    return true;
+  }
+  const char* key = node->key;
+  host::json::Node* next = node->next;
+  *node = *source;
+  node->key = key;
+  node->next = next;
+  return true;
+}
+
+
+namespace host {
+  namespace json {
+
+    template<typename T>
+    struct Converter<T, typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value>::type> {
+      static T as(Pool*, const Node* node) {
+        if (!node) {
+          return 0;
+        }
+        switch (node->type) {
+          case BOOL:   return node->v.b;
+          case INT:    return static_cast<T>(node->v.i);
+          case UINT:   return static_cast<T>(node->v.u);
+          case FLOAT:  return static_cast<T>(node->v.f);
+          case STRING: return static_cast<T>(strtoll(node->v.s, nullptr, 10));
+          default:     return 0;
+        }
+      }
+
+      static bool is(const Node* node) {
+        if (!node) {
+          return false;
+        }
+        if (node->type == INT) {
+          return node->v.i >= static_cast<int64_t>(std::numeric_limits<T>::min()) &&
+                 (node->v.i < 0 || static_cast<uint64_t>(node->v.i) <= static_cast<uint64_t>(std::numeric_limits<T>::max()));
+        }
+        if (node->type == UINT) {
+          return node->v.u <= static_cast<uint64_t>(std::numeric_limits<T>::max());
+        }
+        return false;
+      }
+    };
+
+    template<>
+    struct Converter<bool> {
+      static bool as(Pool*, const Node* node) {
+        if (!node) {
+          return false;
+        }
+        switch (node->type) {
+          case BOOL:  return node->v.b;
+          case INT:   return node->v.i != 0;
+          case UINT:  return node->v.u != 0;
+          case FLOAT: return node->v.f != 0;
+          default:    return false;
+        }
+      }
+
+      static bool is(const Node* node) {
+        return node && node->type == BOOL;
+      }
+    };
+
+    template<typename T>
+    struct Converter<T, typename std::enable_if<std::is_floating_point<T>::value>::type> {
+      static T as(Pool*, const Node* node) {
+        if (!node) {
+          return 0;
+        }
+        switch (node->type) {
+          case BOOL:   return node->v.b;
+          case INT:    return static_cast<T>(node->v.i);
+          case UINT:   return static_cast<T>(node->v.u);
+          case FLOAT:  return static_cast<T>(node->v.f);
+          case STRING: return static_cast<T>(strtod(node->v.s, nullptr));
+          default:     return 0;
+        }
+      }
+
+      static bool is(const Node* node) {
+        return node && (node->type == INT || node->type == UINT || node->type == FLOAT);
+      }
+    };
+
+    template<>
+    struct Converter<const char*> {
+      static const char* as(Pool*, const Node* node) {
+        return node && node->type == STRING ? node->v.s : nullptr;
+      }
+
+      static bool is(const Node* node) {
+        return node && node->type == STRING;
+      }
+    };
+
+    template<>
+    struct Converter<String> {
+      static String as(Pool*, const Node* node) {
+        return String(Converter<const char*>::as(nullptr, node));
+      }
+
+      static bool is(const Node* node) {
+        return Converter<const char*>::is(node);
+      }
+    };
+
+    template<>
+    struct Converter<JsonVariantConst> {
+      static JsonVariantConst as(Pool*, const Node* node) {
+        return JsonVariantConst(node);
+      }
+
+      static bool is(const Node*) {
+        return true;
+      }
+    };
+
+    template<>
+    struct Converter<JsonVariant> {
+      static JsonVariant as(Pool* pool, const Node* node) {
+        return JsonVariant(pool, const_cast<Node*>(node));
+      }
+
+      static bool is(const Node*) {
+        return true;
+      }
+    };
+
+    template<>
+    struct Converter<JsonObjectConst> {
+      static JsonObjectConst as(Pool*, const Node* node) {
+        return JsonObjectConst(node);
+      }
+
+      static bool is(const Node* node) {
+        return node && node->type == OBJECT;
+      }
+    };
+
+    template<>
+    struct Converter<JsonArrayConst> {
+      static JsonArrayConst as(Pool*, const Node* node) {
+        return JsonArrayConst(node);
+      }
+
+      static bool is(const Node* node) {
+        return node && node->type == ARRAY;
+      }
+    };
+
+    template<>
+    struct Converter<JsonObject> {
+      static JsonObject as(Pool* pool, const Node* node) {
+        return pool ? JsonObject(pool, const_cast<Node*>(node)) : JsonObject();
+      }
+
+      static bool is(const Node* node) {
+        return node && node->type == OBJECT;
+      }
+    };
+
+    template<>
+    struct Converter<JsonArray> {
+      static JsonArray as(Pool* pool, const Node* node) {
+        return pool ? JsonArray(pool, const_cast<Node*>(node)) : JsonArray();
+      }
+
+      static bool is(const Node* node) {
+        return node && node->type == ARRAY;
+      }
+    };
+
+  } // json
+} // host
+
+
+class JsonDocument {
+public:
+  explicit JsonDocument(size_t capacity) : _pool(capacity) {}
+
+  JsonDocument(JsonDocument&& other) : _pool(0) {
+    swap(other);
+  }
+
+  JsonDocument& operator=(JsonDocument&& other) {
+    swap(other);
+    return *this;
+  }
+
+  JsonDocument(const JsonDocument&) = delete;
+  JsonDocument& operator=(const JsonDocument&) = delete;
+
+  size_t capacity() const {
+    return _pool.capacity();
+  }
+
+  size_t memoryUsage() const {
+    return _pool.size();
+  }
+
+  bool overflowed() const {
+    return _pool.overflowed();
+  }
+
+  void clear() {
+    _pool.clear();
+    _root = host::json::Node();
+  }
+
+  bool isNull() const {
+    return _root.type == host::json::NUL;
+  }
+
+  size_t size() const {
+    return _root.size();
+  }
+
+  template<typename T>
+  T as() {
+    return host::json::Converter<T>::as(&_pool, &_root);
+  }
+
+  template<typename T>
+  T as() const {
+    return host::json::Converter<T>::as(nullptr, &_root);
+  }
+
+  template<typename T>
+  bool is() const {
+    return host::json::Converter<T>::is(&_root);
+  }
+
+  template<typename T>
+  T to() {
+    clear();
+    return JsonVariant(&_pool, &_root).to<T>();
+  }
+
+  JsonVariant operator[](const char* key) {
+    return variant()[key];
+  }
+
+  JsonVariant operator[](const String& key) {
+    return variant()[key];
+  }
+
+  JsonVariantConst operator[](const char* key) const {
+    return JsonVariantConst(&_root)[key];
+  }
+
+  template<typename T>
+  typename std::enable_if<std::is_integral<T>::value, JsonVariant>::type operator[](T idx) {
+    return variant()[idx];
+  }
+
+  bool containsKey(const char* key) const {
+    return _root.member(key);
+  }
+
+  JsonObject createNestedObject(const char* key) {
+    return variant().createNestedObject(key);
+  }
+
+  JsonArray createNestedArray(const char* key) {
+    return variant().createNestedArray(key);
+  }
+
+  template<typename T>
+  bool add(const T& value) {
+    return variant().add(value);
+  }
+
+  operator JsonVariantConst() const {
+    return JsonVariantConst(&_root);
+  }
+
+  host::json::Pool& pool() {
+    return _pool;
+  }
+
+  host::json::Node& root() {
+    return _root;
+  }
+
+  const host::json::Node& root() const {
+    return _root;
+  }
+
+private:
+  JsonVariant variant() {
+    return JsonVariant(&_pool, &_root);
+  }
+
+  void swap(JsonDocument& other) {
+    _pool.swap(other._pool);
+    std::swap(_root, other._root);
+  }
+
+  host::json::Pool _pool;
+  host::json::Node _root;
+};
+
+class DynamicJsonDocument : public JsonDocument {
+public:
+  explicit DynamicJsonDocument(size_t capacity) : JsonDocument(capacity) {}
+};
+
+template<size_t Capacity>
+class StaticJsonDocument : public JsonDocument {
+public:
+  StaticJsonDocument() : JsonDocument(Capacity) {}
+};
+
+
+class DeserializationError {
+public:
+  enum Code {
+    Ok,
+    EmptyInput,
+    IncompleteInput,
+    InvalidInput,
+    NoMemory,
+    TooDeep,
+  };
+
+  DeserializationError(Code code = Ok) : _code(code) {}
+
+  Code code() const {
+    return _code;
+  }
+
+  explicit operator bool() const {
+    return _code != Ok;
+  }
+
+  bool operator==(Code code) const {
+    return _code == code;
+  }
+
+  bool operator!=(Code code) const {
+    return _code != code;
+  }
+
+  const char* c_str() const {
+    static const char* names[] = {"Ok", "EmptyInput", "IncompleteInput", "InvalidInput", "NoMemory", "TooDeep"};
+    return names[_code];
+  }
+
+private:
+  Code _code;
+};
+
+namespace DeserializationOption {
+
+  class Filter {
+  public:
+    explicit Filter(const JsonDocument& filter) : _node(&filter.root()) {}
+    explicit Filter(JsonVariantConst filter) : _node(filter.node()) {}
+
+    const host::json::Node* node() const {
+      return _node;
+    }
+
+  private:
+    const host::json::Node* _node;
+  };
+
+} // DeserializationOption
+
+
+namespace host {
+  namespace json {
+
+    // Input of the parser, either a buffer or a stream read one byte at a
+    // time. A stream is not read past the end of the value.
+    class Reader {
+    public:
+      Reader(char* buffer, size_t length) : _it(buffer), _end(buffer + length), _writable(true) {}
+      Reader(const char* buffer, size_t length) : _it(const_cast<char*>(buffer)), _end(buffer + length) {}
+      explicit Reader(Stream& stream) : _stream(&stream) {}
+
+      int peek() {
+        if (_stream) {
+          if (_peeked < 0) {
+            _peeked = _stream->read();
+          }
+          return _peeked;
+        }
+        return _it < _end && *_it ? static_cast<uint8_t>(*_it) : -1;
+      }
+
+      void skip() {
+        if (_stream) {
+          _peeked = -1;
+        }
+        else {
+          _it++;
+        }
+      }
+
+      int read() {
+        int c = peek();
+        if (c >= 0) {
+          skip();
+        }
+        return c;
+      }
+
+      // Zero-copy strings are unescaped into the input behind the reader
+      bool isWritable() const {
+        return _writable;
+      }
+
+      char* position() const {
+        return _it;
+      }
+
+    private:
+      char*       _it = nullptr;
+      const char* _end = nullptr;
+      Stream*     _stream = nullptr;
+      int         _peeked = -1;
+      bool        _writable = false;
+    };
+
+    class Parser {
+    public:
+      Parser(Reader& reader, Pool& pool) : _reader(reader), _pool(pool) {}
+
+      DeserializationError::Code parse(Node* node, const Node* filter) {
+        skipSpace();
+        if (_reader.peek() < 0) {
+          return DeserializationError::EmptyInput;
+        }
+        return value(node, filter ? filter : allowAll(), NESTING_LIMIT);
+      }
+
+    private:
+      static const Node* allowAll() {
+        static Node node;
+        node.type = BOOL;
+        node.v.b = true;
+        return &node;
+      }
+
+      static bool allows(const Node* filter) {
+        return filter && filter->type == BOOL && filter->v.b;
+      }
+
+      void skipSpace() {
+        int c;
+        while ((c = _reader.peek()) == ' ' || c == '\t' || c == '\r' || c == '\n') {
+          _reader.skip();
+        }
+      }
+
+      // Parses a value into node, or skips it if node is null
+      DeserializationError::Code value(Node* node, const Node* filter, uint8_t depth) {
+        skipSpace();
+        int c = _reader.peek();
+        if (c < 0) {
+          return DeserializationError::IncompleteInput;
+        }
+        if (c == '{' || c == '[') {
+          if (depth == 0) {
+            return DeserializationError::TooDeep;
+          }
+          bool allowed = allows(filter) || (filter && filter->type == (c == '{' ? OBJECT : ARRAY));
+          return c == '{' ? object(allowed ? node : nullptr, filter, depth - 1) : array(allowed ? node : nullptr, filter, depth - 1);
+        }
+        node = allows(filter) ? node : nullptr;
+        if (c == '"' || c == '\'') {
+          const char* string = nullptr;
+          DeserializationError::Code err = this->string(node ? &string : nullptr);
+          if (!err && node) {
+            node->type = STRING;
+            node->v.s = string;
+          }
+          return err;
+        }
+        return scalar(node);
+      }
+
+      DeserializationError::Code object(Node* node, const Node* filter, uint8_t depth) {
+        _reader.skip();
+        if (node) {
+          node->setContainer(OBJECT);
+        }
+        skipSpace();
+        if (_reader.peek() == '}') {
+          _reader.skip();
+          return DeserializationError::Ok;
+        }
+        for (;;) {
+          skipSpace();
+          if (_reader.peek() < 0) {
+            return DeserializationError::IncompleteInput;
+          }
+          if (_reader.peek() != '"' && _reader.peek() != '\'') {
+            return DeserializationError::InvalidInput;
+          }
+
+          // Keys are only kept for members the filter lets through
+          const char* key = nullptr;
+          char* pending = _reader.isWritable() ? nullptr : _pool.beginString();
+          DeserializationError::Code err = string(&key, node == nullptr);
+          if (err) {
+            return err;
+          }
+          const Node* memberFilter = allows(filter) ? filter : (filter ? filter->member(key) : nullptr);
+
+          skipSpace();
+          int c = _reader.read();
+          if (c != ':') {
+            return c < 0 ? DeserializationError::IncompleteInput : DeserializationError::InvalidInput;
+          }
+
+          Node* member = nullptr;
+          if (node && memberFilter) {
+            member = const_cast<Node*>(node->member(key));
+            if (!member) {
+              member = _pool.allocNode();
+              if (!member) {
+                return DeserializationError::NoMemory;
+              }
+              member->key = key;
+              node->append(member);
+            }
+          }
+          else if (pending) {
+            rollback(pending);
+          }
+          err = value(member, memberFilter, depth);
+          if (err) {
+            return err;
+          }
+
+          skipSpace();
+          c = _reader.read();
+          if (c == '}') {
+            return DeserializationError::Ok;
+          }
+          if (c != ',') {
+            return c < 0 ? DeserializationError::IncompleteInput : DeserializationError::InvalidInput;
+          }
+        }
+      }
+
+      DeserializationError::Code array(Node* node, const Node* filter, uint8_t depth) {
+        _reader.skip();
+        if (node) {
+          node->setContainer(ARRAY);
+        }
+        const Node* elementFilter = allows(filter) ? filter : (filter ? filter->element(0) : nullptr);
+        skipSpace();
+        if (_reader.peek() == ']') {
+          _reader.skip();
+          return DeserializationError::Ok;
+        }
+        for (;;) {
+          Node* element = nullptr;
+          if (node && elementFilter) {
+            element = _pool.allocNode();
+            if (!element) {
+              return DeserializationError::NoMemory;
+            }
+            node->append(element);
+          }
+          DeserializationError::Code err = value(element, elementFilter, depth);
+          if (err) {
+            return err;
+          }
+
+          skipSpace();
+          int c = _reader.read();
+          if (c == ']') {
+            return DeserializationError::Ok;
+          }
+          if (c != ',') {
+            return c < 0 ? DeserializationError::IncompleteInput : DeserializationError::InvalidInput;
+          }
+        }
+      }
+
+      // Parses a quoted string. Zero-copy input is unescaped in place,
+      // otherwise the string is copied into the pool unless it is skipped.
+      DeserializationError::Code string(const char** result, bool skipCopy = false) {
+        int quote = _reader.read();
+        bool copy = !_reader.isWritable() && result && !skipCopy;
+        char* target = _reader.isWritable() ? _reader.position() : (copy ? _pool.beginString() : nullptr);
+        char* write = target;
+        for (;;) {
+          int c = _reader.read();
+          if (c < 0) {
+            return DeserializationError::IncompleteInput;
+          }
+          if (c == quote) {
+            break;
+          }
+          if (c == '\\') {
+            c = _reader.read();
+            switch (c) {
+              case '"': case '\\': case '/': case '\'': break;
+              case 'b': c = '\b'; break;
+              case 'f': c = '\f'; break;
+              case 'n': c = '\n'; break;
+              case 'r': c = '\r'; break;
+              case 't': c = '\t'; break;
+              case 'u': {
+                uint32_t codepoint;
+                if (!hex(codepoint)) {
+                  return DeserializationError::InvalidInput;
+                }
+                if (codepoint >= 0xd800 && codepoint < 0xdc00) {
+                  uint32_t low;
+                  if (_reader.read() != '\\' || _reader.read() != 'u' || !hex(low)) {
+                    return DeserializationError::InvalidInput;
+                  }
+                  codepoint = 0x10000 + ((codepoint - 0xd800) << 10) + (low - 0xdc00);
+                }
+                char utf8[4];
+                uint8_t size = encode(codepoint, utf8);
+                for (uint8_t idx = 0; idx < size; idx++) {
+                  if (!put(write, copy, utf8[idx])) {
+                    return DeserializationError::NoMemory;
+                  }
+                }
+                continue;
+              }
+              case -1:
+                return DeserializationError::IncompleteInput;
+              default:
+                return DeserializationError::InvalidInput;
+            }
+          }
+          if (!put(write, copy, c)) {
+            return DeserializationError::NoMemory;
+          }
+        }
+        if (_reader.isWritable()) {
+          *write = '\0';
+        }
+        else if (copy && !_pool.endString()) {
+          return DeserializationError::NoMemory;
+        }
+        if (result) {
+          *result = target;
+        }
+        return DeserializationError::Ok;
+      }
+
+      bool put(char*& write, bool copy, int c) {
+        if (_reader.isWritable()) {
+          *write++ = c;
+          return true;
+        }
+        return !copy || _pool.appendString(c);
+      }
+
+      // Drops a key that was copied for a member the filter rejected
+      void rollback(char*) {
+        _pool.beginString();
+      }
+
+      bool hex(uint32_t& value) {
+        value = 0;
+        for (uint8_t idx = 0; idx < 4; idx++) {
+          int c = _reader.read();
+          if      (c >= '0' && c <= '9') value = value * 16 + c - '0';
+          else if (c >= 'a' && c <= 'f') value = value * 16 + c - 'a' + 10;
+          else if (c >= 'A' && c <= 'F') value = value * 16 + c - 'A' + 10;
+          else return false;
+        }
+        return true;
+      }
+
+      static uint8_t encode(uint32_t codepoint, char* utf8) {
+        if (codepoint < 0x80) {
+          utf8[0] = codepoint;
+          return 1;
+        }
+        if (codepoint < 0x800) {
+          utf8[0] = 0xc0 | (codepoint >> 6);
+          utf8[1] = 0x80 | (codepoint & 0x3f);
+          return 2;
+        }
+        if (codepoint < 0x10000) {
+          utf8[0] = 0xe0 | (codepoint >> 12);
+          utf8[1] = 0x80 | ((codepoint >> 6) & 0x3f);
+          utf8[2] = 0x80 | (codepoint & 0x3f);
+          return 3;
+        }
+        utf8[0] = 0xf0 | (codepoint >> 18);
+        utf8[1] = 0x80 | ((codepoint >> 12) & 0x3f);
+        utf8[2] = 0x80 | ((codepoint >> 6) & 0x3f);
+        utf8[3] = 0x80 | (codepoint & 0x3f);
+        return 4;
+      }
+
+      // Numbers, true, false and null
+      DeserializationError::Code scalar(Node* node) {
+        char buffer[64];
+        size_t length = 0;
+        int c;
+        while ((c = _reader.peek()) >= 0 && (isalnum(c) || c == '-' || c == '+' || c == '.')) {
+          if (length == sizeof(buffer) - 1) {
+            return DeserializationError::InvalidInput;
+          }
+          buffer[length++] = c;
+          _reader.skip();
+        }
+        buffer[length] = '\0';
+        if (length == 0) {
+          return c < 0 ? DeserializationError::IncompleteInput : DeserializationError::InvalidInput;
+        }
+
+        Node parsed;
+        if (strcmp(buffer, "true") == 0 || strcmp(buffer, "false") == 0) {
+          parsed.type = BOOL;
+          parsed.v.b = buffer[0] == 't';
+        }
+        else if (strcmp(buffer, "null") == 0) {
+          parsed.type = NUL;
+        }
+        else {
+          char* end;
+          bool integer = strpbrk(buffer, ".eE") == nullptr;
+          errno = 0;
+          if (integer && buffer[0] == '-') {
+            parsed.type = INT;
+            parsed.v.i = strtoll(buffer, &end, 10);
+          }
+          else if (integer) {
+            parsed.type = UINT;
+            parsed.v.u = strtoull(buffer, &end, 10);
+            if (parsed.v.u <= static_cast<uint64_t>(INT64_MAX)) {
+              parsed.type = INT;
+              parsed.v.i = static_cast<int64_t>(parsed.v.u);
+            }
+          }
+          if (!integer || errno == ERANGE) {
+            parsed.type = FLOAT;
+            parsed.v.f = strtod(buffer, &end);
+          }
+          if (*end != '\0') {
+            return DeserializationError::InvalidInput;
+          }
+        }
+        if (node) {
+          node->type = parsed.type;
+          node->v = parsed.v;
+        }
+        return DeserializationError::Ok;
+      }
+
+      Reader& _reader;
+      Pool&   _pool;
+    };
+
+    inline DeserializationError deserialize(JsonDocument& doc, Reader reader, const Node* filter) {
+      doc.clear();
+      Parser parser(reader, doc.pool());
+      DeserializationError::Code err = parser.parse(&doc.root(), filter);
+      return err;
+    }
+
+    // Output of the serializer, counts every byte whether it fits or not
+    class Writer {
+    public:
+      Writer(char* buffer, size_t size) : _buffer(buffer), _size(size) {}
+      explicit Writer(Print* print) : _print(print) {}
+      Writer() = default;
+
+      void put(char c) {
+        if (_print) {
+          _print->write(static_cast<uint8_t>(c));
+        }
+        else if (_buffer && _count + 1 < _size) {
+          _buffer[_count] = c;
+        }
+        _count++;
+      }
+
+      void put(const char* value) {
+        while (*value) {
+          put(*value++);
+        }
+      }
+
+      size_t finish() {
+        if (_buffer && _size) {
+          size_t end = _count < _size ? _count : _size - 1;
+          _buffer[end] = '\0';
+          return end;
+        }
+        return _count;
+      }
+
+    private:
+      char*  _buffer = nullptr;
+      size_t _size = 0;
+      Print* _print = nullptr;
+      size_t _count = 0;
+    };
+
+    inline void writeString(Writer& writer, const char* value) {
+      writer.put('"');
+      for (const char* it = value; *it; it++) {
+        char c = *it;
+        switch (c) {
+          case '"':  writer.put("\\\""); break;
+          case '\\': writer.put("\\\\"); break;
+          case '\b': writer.put("\\b"); break;
+          case '\f': writer.put("\\f"); break;
+          case '\n': writer.put("\\n"); break;
+          case '\r': writer.put("\\r"); break;
+          case '\t': writer.put("\\t"); break;
+          default:
+            if (static_cast<uint8_t>(c) < 0x20) {
+              char escaped[8];
+              snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+              writer.put(escaped);
+            }
+            else {
+              writer.put(c);
+            }
+        }
+      }
+      writer.put('"');
+    }
+
+    inline void indent(Writer& writer, uint8_t level) {
+      writer.put('\r');
+      writer.put('\n');
+      for (uint8_t idx = 0; idx < level; idx++) {
+        writer.put("  ");
+      }
+    }
+
+    inline void write(Writer& writer, const Node* node, bool pretty, uint8_t level = 0) {
+      char buffer[32];
+      switch (node ? node->type : NUL) {
+        case NUL:    writer.put("null"); break;
+        case BOOL:   writer.put(node->v.b ? "true" : "false"); break;
+        case INT:    snprintf(buffer, sizeof(buffer), "%lld", static_cast<long long>(node->v.i)); writer.put(buffer); break;
+        case UINT:   snprintf(buffer, sizeof(buffer), "%llu", static_cast<unsigned long long>(node->v.u)); writer.put(buffer); break;
+        case FLOAT:
+          if (isfinite(node->v.f)) {
+            snprintf(buffer, sizeof(buffer), "%.9g", node->v.f);
+            writer.put(buffer);
+          }
+          else {
+            writer.put("null");
+          }
+          break;
+        case STRING: writeString(writer, node->v.s); break;
+        case ARRAY:
+        case OBJECT: {
+          bool object = node->type == OBJECT;
+          writer.put(object ? '{' : '[');
+          for (const Node* child = node->v.c.head; child; child = child->next) {
+            if (pretty) {
+              indent(writer, level + 1);
+            }
+            if (object) {
+              writeString(writer, child->key);
+              writer.put(pretty ? ": " : ":");
+            }
+            write(writer, child, pretty, level + 1);
+            if (child->next) {
+              writer.put(',');
+            }
+          }
+          if (pretty && node->v.c.head) {
+            indent(writer, level);
+          }
+          writer.put(object ? '}' : ']');
+          break;
+        }
+      }
+    }
+
+    inline const Node* nodeOf(const JsonDocument& doc)  { return &doc.root(); }
+    inline const Node* nodeOf(const JsonVariantConst& v) { return v.node(); }
+    inline const Node* nodeOf(const JsonVariant& v)      { return v.node(); }
+    inline const Node* nodeOf(const JsonObjectConst& v)  { return v.node(); }
+    inline const Node* nodeOf(const JsonObject& v)       { return v.node(); }
+    inline const Node* nodeOf(const JsonArrayConst& v)   { return v.node(); }
+    inline const Node* nodeOf(const JsonArray& v)        { return v.node(); }
+
+  } // json
+} // host
+
+
+inline DeserializationError deserializeJson(JsonDocument& doc, char* input, size_t length) {
+  return host::json::deserialize(doc, host::json::Reader(input, length), nullptr);
+}
+
+inline DeserializationError deserializeJson(JsonDocument& doc, char* input) {
+  return deserializeJson(doc, input, strlen(input));
+}
+
+inline DeserializationError deserializeJson(JsonDocument& doc, const char* input, size_t length) {
+  return host::json::deserialize(doc, host::json::Reader(input, length), nullptr);
+}
+
+inline DeserializationError deserializeJson(JsonDocument& doc, const char* input) {
+  return deserializeJson(doc, input, strlen(input));
+}
+
+inline DeserializationError deserializeJson(JsonDocument& doc, const String& input) {
+  return deserializeJson(doc, input.c_str(), input.length());
+}
+
+inline DeserializationError deserializeJson(JsonDocument& doc, Stream& input) {
+  return host::json::deserialize(doc, host::json::Reader(input), nullptr);
+}
+
+inline DeserializationError deserializeJson(JsonDocument& doc, Stream& input, DeserializationOption::Filter filter) {
+  return host::json::deserialize(doc, host::json::Reader(input), filter.node());
+}
+
+inline DeserializationError deserializeJson(JsonDocument& doc, const char* input, size_t length, DeserializationOption::Filter filter) {
+  return host::json::deserialize(doc, host::json::Reader(input, length), filter.node());
+}
+
+template<typename T>
+size_t serializeJson(const T& source, char* buffer, size_t size) {
+  host::json::Writer writer(buffer, size);
+  host::json::write(writer, host::json::nodeOf(source), false);
+  return writer.finish();
+}
+
+template<typename T>
+size_t serializeJson(const T& source, Print& print) {
+  host::json::Writer writer(&print);
+  host::json::write(writer, host::json::nodeOf(source), false);
+  return writer.finish();
+}
+
+template<typename T>
+size_t serializeJson(const T& source, String& output) {
+  size_t size = measureJson(source);
+  std::string buffer(size + 1, '\0');
+  serializeJson(source, &buffer[0], buffer.size());
+  buffer.resize(size);
+  output = String(buffer);
+  return size;
+}
+
+template<typename T>
+size_t measureJson(const T& source) {
+  host::json::Writer writer;
+  host::json::write(writer, host::json::nodeOf(source), false);
+  return writer.finish();
+}
+
+template<typename T>
+size_t serializeJsonPretty(const T& source, Print& print) {
+  host::json::Writer writer(&print);
+  host::json::write(writer, host::json::nodeOf(source), true);
+  return writer.finish();
+}
+
+#endif // HostArduinoJson_h_
@@ -0,0 +1,138 @@
+#ifndef HostArduinoWebsockets_h_
+#define HostArduinoWebsockets_h_
+
+// WebsocketsClient of gilmaimon/ArduinoWebsockets on the fake endpoints.
+// connect() blocks for the handshake of the endpoint like the library, poll()
+// delivers at most one message. Destroying the client closes it.
+
+#include <functional>
+#include <string>
+
+#include <Arduino.h>
+
+#include "WebsocketEndpoints.h"
+
+namespace websockets {
+
+  typedef std::string WSString;
+
+  enum class WebsocketsEvent {
+    ConnectionOpened,
+    ConnectionClosed,
+    GotPing,
+    GotPong,
+  };
+
+  class WebsocketsMessage {
+  public:
+    explicit WebsocketsMessage(WSString data) : _data(std::move(data)) {}
+
+    const WSString& rawData() const {
+      return _data;
+    }
+
+    String data() const {
+      return String(_data);
+    }
+
+    bool isText() const {
+      return true;
+    }
+
+  private:
+    WSString _data;
+  };
+
+  class WebsocketsClient {
+  public:
+    ~WebsocketsClient() {
+      close();
+    }
+
+    typedef std::function<void(WebsocketsMessage)>              MessageCallback;
+    typedef std::function<void(WebsocketsEvent, String)>        EventCallback;
+
+    bool connect(const String& host, int port, const String& path) {
+      return open(host::ws::key(host.c_str(), port, path.c_str()));
+    }
+
+    // ws://host[:port]/path?query, the query is not part of the endpoint
+    bool connect(const String& url) {
+      std::string value(url.c_str());
+      size_t scheme = value.find("://");
+      bool secure = value.compare(0, 3, "wss") == 0;
+      std::string rest = scheme == std::string::npos ? value : value.substr(scheme + 3);
+      size_t slash = rest.find('/');
+      std::string authority = rest.substr(0, slash);
+      std::string path = slash == std::string::npos ? "/" : rest.substr(slash);
+      path = path.substr(0, path.find('?'));
+      size_t colon = authority.find(':');
+      uint16_t port = colon == std::string::npos ? (secure ? 443 : 80) : atoi(authority.c_str() + colon + 1);
+      return open(host::ws::key(authority.substr(0, colon), port, path));
+    }
+
+    void onMessage(MessageCallback callback) {
+      _onMessage = callback;
+    }
+
+    void onEvent(EventCallback callback) {
+      _onEvent = callback;
+    }
+
+    bool available() const {
+      return _connected;
+    }
+
+    bool send(const String& message) {
+      if (!_connected) {
+        return false;
+      }
+      std::string frame(message.c_str());
+      host::ws::with(_key, [&frame](host::ws::Endpoint& endpoint) { endpoint.sent.push_back(frame); });
+      return true;
+    }
+
+    bool poll() {
+      if (!_connected) {
+        return false;
+      }
+      std::string frame;
+      bool received;
+      if (!host::ws::receive(_key, frame, received)) {
+        close();
+        return false;
+      }
+      if (received) {
+        _onMessage(WebsocketsMessage(std::move(frame)));
+      }
+      return received;
+    }
+
+    void close() {
+      if (_connected) {
+        _connected = false;
+        _onEvent(WebsocketsEvent::ConnectionClosed, String());
+      }
+    }
+
+  private:
+    bool open(const std::string& key) {
+      close();
+      _key = key;
+      if (!host::ws::handshake(_key)) {
+        return false;
+      }
+      _connected = true;
+      _onEvent(WebsocketsEvent::ConnectionOpened, String());
+      return true;
+    }
+
+    MessageCallback _onMessage = [](WebsocketsMessage) {};
+    EventCallback   _onEvent = [](WebsocketsEvent, String) {};
+    std::string     _key;
+    bool            _connected = false;
+  };
+
+} // websockets
+
+#endif // HostArduinoWebsockets_h_
@@ -0,0 +1,112 @@
+#ifndef HostEasyLogger_h_
+#define HostEasyLogger_h_
+
+// EasyLogger macros for the host. The message argument is a stream
+// expression that is pasted behind a line, like the real macros do. Lines
+// are formatted into a fixed buffer without touching the heap and printed
+// to stdout; the last line and a count per level are kept for tests.
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <type_traits>
+
+#include <Arduino.h>
+
+#define LOG_LEVEL_NONE     0
+#define LOG_LEVEL_CRITICAL 1
+#define LOG_LEVEL_ERROR    2
+#define LOG_LEVEL_WARNING  3
+#define LOG_LEVEL_NOTICE   4
+#define LOG_LEVEL_INFO     5
+#define LOG_LEVEL_DEBUG    6
+
+#define LOG_FORMATTING_NOTIME 0
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_DEBUG
+#endif
+
+namespace host {
+
+  struct Log {
+    char     last[256] = "";
+    uint32_t count[LOG_LEVEL_DEBUG + 1] = {};
+    bool     echo = true;
+  };
+
+  inline Log& log() {
+    static Log value;
+    return value;
+  }
+
+  class LogLine {
+  public:
+    LogLine(int level, const char* service) : _level(level) {
+      append("%c %s: ", "?CEWNID"[level], service);
+    }
+
+    ~LogLine() {
+      Log& state = log();
+      memcpy(state.last, _buffer, _length + 1);
+      state.count[_level]++;
+      if (state.echo) {
+        puts(_buffer);
+      }
+    }
+
+    LogLine& operator<<(const char* value) {
+      return append("%s", value ? value : "(null)");
+    }
+
+    LogLine& operator<<(const String& value) {
+      return append("%s", value.c_str());
+    }
+
+    LogLine& operator<<(char value) {
+      return append("%c", value);
+    }
+
+    template<typename T>
+    typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value, LogLine&>::type operator<<(T value) {
+      return std::is_signed<T>::value || std::is_enum<T>::value ? append("%lld", static_cast<long long>(value))
+                                                                : append("%llu", static_cast<unsigned long long>(value));
+    }
+
+    LogLine& operator<<(double value) {
+      return append("%.2f", value);
+    }
+
+  private:
+    LogLine& append(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+      va_list args;
+      va_start(args, format);
+      int length = vsnprintf(_buffer + _length, sizeof(_buffer) - _length, format, args);
+      va_end(args);
+      if (length > 0) {
+        _length = _length + length < sizeof(_buffer) - 1 ? _length + length : sizeof(_buffer) - 1;
+      }
+      return *this;
+    }
+
+    char   _buffer[256];
+    size_t _length = 0;
+    int    _level;
+  };
+
+} // host
+
+#define LOG_AT(level, service, message) \
+  do { \
+    if (LOG_LEVEL >= level) { \
+      host::LogLine(level, service) << message; \
+    } \
+  } while (0)
+
+#define LOG_CRITICAL(service, message) LOG_AT(LOG_LEVEL_CRITICAL, service, message)
+#define LOG_ERROR(service, message)    LOG_AT(LOG_LEVEL_ERROR, service, message)
+#define LOG_WARNING(service, message)  LOG_AT(LOG_LEVEL_WARNING, service, message)
+#define LOG_NOTICE(service, message)   LOG_AT(LOG_LEVEL_NOTICE, service, message)
+#define LOG_INFO(service, message)     LOG_AT(LOG_LEVEL_INFO, service, message)
+#define LOG_DEBUG(service, message)    LOG_AT(LOG_LEVEL_DEBUG, service, message)
+
+#endif // HostEasyLogger_h_
@@ -0,0 +1,158 @@
+#ifndef HostFS_h_
+#define HostFS_h_
+
+// fs::FS on a directory of the host. Paths are relative to the root given
+// to the constructor. A write limit models power loss: once the given
+// number of bytes was written all further writes fail short.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <sys/stat.h>
+#include <memory>
+#include <string>
+
+#include <Arduino.h>
+
+#define FILE_READ   "r"
+#define FILE_WRITE  "w"
+#define FILE_APPEND "a"
+
+namespace fs {
+
+  class FS;
+
+  class File : public Stream {
+  public:
+    File() = default;
+
+    size_t write(uint8_t c) override {
+      return write(&c, 1);
+    }
+
+    size_t write(const uint8_t* buffer, size_t size) override {
+      if (!_file) {
+        return 0;
+      }
+      size_t allowed = size < *_writeLimit ? size : *_writeLimit;
+      *_writeLimit -= allowed;
+      return fwrite(buffer, 1, allowed, _file.get());
+    }
+
+    int available() override {
+      return _file ? static_cast<int>(size() - position()) : 0;
+    }
+
+    int read() override {
+      return _file ? fgetc(_file.get()) : -1;
+    }
+
+    size_t read(uint8_t* buffer, size_t size) {
+      return _file ? fread(buffer, 1, size, _file.get()) : 0;
+    }
+
+    int peek() override {
+      if (!_file) {
+        return -1;
+      }
+      int c = fgetc(_file.get());
+      if (c >= 0) {
+        ungetc(c, _file.get());
+      }
+      return c;
+    }
+
+    void flush() override {
+      if (_file) {
+        fflush(_file.get());
+      }
+    }
+
+    size_t position() const {
+      return _file ? ftell(_file.get()) : 0;
+    }
+
+    size_t size() const {
+      if (!_file) {
+        return 0;
+      }
+      fflush(_file.get());
+      struct stat info;
+      return fstat(fileno(_file.get()), &info) == 0 ? info.st_size : 0;
+    }
+
+    void close() {
+      _file.reset();
+    }
+
+    operator bool() const {
+      return static_cast<bool>(_file);
+    }
+
+  private:
+    friend class FS;
+
+    File(FILE* file, size_t* writeLimit) : _file(file, fclose), _writeLimit(writeLimit) {}
+
+    std::shared_ptr<FILE> _file;
+    size_t*               _writeLimit = nullptr;
+  };
+
+  class FS {
+  public:
+    explicit FS(const std::string& root) : _root(root) {}
+
+    File open(const char* path, const char* mode = FILE_READ) {
+      FILE* file = fopen(resolve(path).c_str(), mode[0] == 'r' ? "rb" : (mode[0] == 'a' ? "ab" : "wb"));
+      return file ? File(file, &_writeLimit) : File();
+    }
+
+    File open(const String& path, const char* mode = FILE_READ) {
+      return open(path.c_str(), mode);
+    }
+
+    bool exists(const char* path) {
+      struct stat info;
+      return stat(resolve(path).c_str(), &info) == 0;
+    }
+
+    bool exists(const String& path) {
+      return exists(path.c_str());
+    }
+
+    bool remove(const char* path) {
+      return ::remove(resolve(path).c_str()) == 0;
+    }
+
+    bool remove(const String& path) {
+      return remove(path.c_str());
+    }
+
+    bool rename(const char* from, const char* to) {
+      return ::rename(resolve(from).c_str(), resolve(to).c_str()) == 0;
+    }
+
+    bool rename(const String& from, const String& to) {
+      return rename(from.c_str(), to.c_str());
+    }
+
+    // Bytes that may still be written before writes fail
+    void setWriteLimit(size_t limit) {
+      _writeLimit = limit;
+    }
+
+    const std::string& getRoot() const {
+      return _root;
+    }
+
+  private:
+    std::string resolve(const char* path) const {
+      return _root + (path[0] == '/' ? "" : "/") + path;
+    }
+
+    std::string _root;
+    size_t      _writeLimit = SIZE_MAX;
+  };
+
+} // fs
+
+#endif // HostFS_h_
@@ -0,0 +1,133 @@
+#ifndef HostHTTPClient_h_
+#define HostHTTPClient_h_
+
+// HTTPClient of the ESP32 core answering from scripted responses keyed by
+// URL. Tests register a response per URL and inspect the requests made.
+// Unknown URLs answer with a connection refused error like the core does.
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Arduino.h"
+#include "Stream.h"
+
+#define HTTPC_ERROR_CONNECTION_REFUSED (-1)
+
+enum t_http_codes {
+  HTTP_CODE_OK                    = 200,
+  HTTP_CODE_NOT_MODIFIED          = 304,
+  HTTP_CODE_BAD_REQUEST           = 400,
+  HTTP_CODE_UNAUTHORIZED          = 401,
+  HTTP_CODE_NOT_FOUND             = 404,
+  HTTP_CODE_INTERNAL_SERVER_ERROR = 500,
+};
+
+namespace host {
+  namespace http {
+
+    struct Response {
+      int                                code = HTTP_CODE_OK;
+      std::string                        body;
+      std::map<std::string, std::string> headers;
+    };
+
+    struct Request {
+      std::string                        method;
+      std::string                        url;
+      std::string                        body;
+      std::map<std::string, std::string> headers;
+    };
+
+    struct Server {
+      std::map<std::string, Response> responses;
+      std::vector<Request>            requests;
+    };
+
+    inline Server& server() {
+      static Server value;
+      return value;
+    }
+
+    inline void serve(const std::string& url, const Response& response) {
+      server().responses[url] = response;
+    }
+
+    inline void reset() {
+      server() = Server();
+    }
+
+  } // http
+} // host
+
+class HTTPClient {
+public:
+  void useHTTP10(bool) {}
+
+  bool begin(const String& url) {
+    _request.url = url.c_str();
+    return true;
+  }
+
+  void addHeader(const String& name, const String& value) {
+    _request.headers[name.c_str()] = value.c_str();
+  }
+
+  void collectHeaders(const char* keys[], size_t count) {
+    _collect.assign(keys, keys + count);
+  }
+
+  int GET() {
+    return send("GET", "");
+  }
+
+  int POST(const String& body) {
+    return send("POST", body.c_str());
+  }
+
+  Stream& getStream() {
+    return _stream;
+  }
+
+  String getString() {
+    return String(_response.body);
+  }
+
+  int getSize() {
+    return _response.body.size();
+  }
+
+  // Only headers named in collectHeaders() are kept, like the core does
+  String header(const char* name) {
+    for (const std::string& key : _collect) {
+      if (key == name) {
+        auto it = _response.headers.find(key);
+        return it != _response.headers.end() ? String(it->second) : String();
+      }
+    }
+    return String();
+  }
+
+  void end() {}
+
+private:
+  int send(const char* method, const std::string& body) {
+    _request.method = method;
+    _request.body = body;
+    host::http::server().requests.push_back(_request);
+    auto it = host::http::server().responses.find(_request.url);
+    if (it == host::http::server().responses.end()) {
+      return HTTPC_ERROR_CONNECTION_REFUSED;
+    }
+    _response = it->second;
+    _stream.assign(_response.body);
+    return _response.code;
+  }
+
+  host::http::Request      _request;
+  host::http::Response     _response;
+  std::vector<std::string> _collect;
+  host::MemoryStream       _stream;
+};
+
+#endif // HostHTTPClient_h_
@@ -0,0 +1,42 @@
+#ifndef HostIPAddress_h_
+#define HostIPAddress_h_
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "WString.h"
+
+// IPv4 address stored in network byte order, like the ESP32 core
+class IPAddress {
+public:
+  IPAddress() : _address(0) {}
+
+  IPAddress(uint32_t address) : _address(address) {}
+
+  IPAddress(uint8_t first, uint8_t second, uint8_t third, uint8_t fourth) {
+    uint8_t* bytes = reinterpret_cast<uint8_t*>(&_address);
+    bytes[0] = first;
+    bytes[1] = second;
+    bytes[2] = third;
+    bytes[3] = fourth;
+  }
+
+  operator uint32_t() const {
+    return _address;
+  }
+
+  uint8_t operator[](int idx) const {
+    return reinterpret_cast<const uint8_t*>(&_address)[idx];
+  }
+
+  String toString() const {
+    char buffer[16];
+    snprintf(buffer, sizeof(buffer), "%u.%u.%u.%u", (*this)[0], (*this)[1], (*this)[2], (*this)[3]);
+    return String(buffer);
+  }
+
+private:
+  uint32_t _address;
+};
+
+#endif // HostIPAddress_h_
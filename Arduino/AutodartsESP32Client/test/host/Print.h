@@ -0,0 +1,78 @@
+#ifndef HostPrint_h_
+#define HostPrint_h_
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <type_traits>
+
+#include "WString.h"
+
+class Print {
+public:
+  virtual ~Print() = default;
+
+  virtual size_t write(uint8_t c) = 0;
+
+  virtual size_t write(const uint8_t* buffer, size_t size) {
+    size_t written = 0;
+    while (written < size && write(buffer[written])) {
+      written++;
+    }
+    return written;
+  }
+
+  size_t write(const char* buffer, size_t size) {
+    return write(reinterpret_cast<const uint8_t*>(buffer), size);
+  }
+
+  size_t print(const char* value) {
+    return write(value, strlen(value));
+  }
+
+  size_t print(const String& value) {
+    return write(value.c_str(), value.length());
+  }
+
+  size_t print(char value) {
+    return write(static_cast<uint8_t>(value));
+  }
+
+  template<typename T>
+  typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, char>::value, size_t>::type print(T value) {
+    char buffer[24];
+    return write(buffer, std::is_signed<T>::value ? snprintf(buffer, sizeof(buffer), "%lld", static_cast<long long>(value))
+                                                  : snprintf(buffer, sizeof(buffer), "%llu", static_cast<unsigned long long>(value)));
+  }
+
+  size_t print(double value, int decimals = 2) {
+    char buffer[64];
+    return write(buffer, snprintf(buffer, sizeof(buffer), "%.*f", decimals, value));
+  }
+
+  template<typename T>
+  size_t println(const T& value) {
+    return print(value) + println();
+  }
+
+  size_t println() {
+    return write("\r\n", 2);
+  }
+
+  size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+    char buffer[256];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    if (length < 0) {
+      return 0;
+    }
+    return write(buffer, static_cast<size_t>(length) < sizeof(buffer) ? length : sizeof(buffer) - 1);
+  }
+
+  virtual void flush() {}
+};
+
+#endif // HostPrint_h_
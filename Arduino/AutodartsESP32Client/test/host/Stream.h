@@ -0,0 +1,116 @@
+#ifndef HostStream_h_
+#define HostStream_h_
+
+#include <string.h>
+#include <string>
+
+#include "Print.h"
+
+// Arduino Stream. Host sources never wait for data, so the timeout of the
+// real stream does not apply: a read of -1 means the source is exhausted.
+class Stream : public Print {
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+
+  void setTimeout(unsigned long) {}
+
+  size_t readBytes(uint8_t* buffer, size_t length) {
+    size_t count = 0;
+    while (count < length) {
+      int c = read();
+      if (c < 0) {
+        break;
+      }
+      buffer[count++] = c;
+    }
+    return count;
+  }
+
+  size_t readBytes(char* buffer, size_t length) {
+    return readBytes(reinterpret_cast<uint8_t*>(buffer), length);
+  }
+
+  bool find(char target) {
+    char terminated[2] = {target, '\0'};
+    return findUntil(terminated, nullptr);
+  }
+
+  bool find(const char* target) {
+    return findUntil(target, nullptr);
+  }
+
+  // Consumes the stream up to and including target, stops early after the
+  // terminator
+  bool findUntil(const char* target, const char* terminator) {
+    size_t targetLength = strlen(target);
+    size_t terminatorLength = terminator ? strlen(terminator) : 0;
+    size_t targetIndex = 0, terminatorIndex = 0;
+    int c;
+    while ((c = read()) >= 0) {
+      targetIndex = c == target[targetIndex] ? targetIndex + 1 : (c == target[0] ? 1 : 0);
+      if (targetIndex == targetLength) {
+        return true;
+      }
+      if (terminatorLength) {
+        terminatorIndex = c == terminator[terminatorIndex] ? terminatorIndex + 1 : (c == terminator[0] ? 1 : 0);
+        if (terminatorIndex == terminatorLength) {
+          return false;
+        }
+      }
+    }
+    return false;
+  }
+
+  String readString() {
+    std::string value;
+    int c;
+    while ((c = read()) >= 0) {
+      value += static_cast<char>(c);
+    }
+    return String(value);
+  }
+};
+
+namespace host {
+
+  // Stream over a fixed string, e.g. a scripted HTTP body
+  class MemoryStream : public Stream {
+  public:
+    MemoryStream(const std::string& data = "") : _data(data) {}
+
+    void assign(const std::string& data) {
+      _data = data;
+      _pos = 0;
+    }
+
+    int available() override {
+      return _data.size() - _pos;
+    }
+
+    int read() override {
+      return _pos < _data.size() ? static_cast<uint8_t>(_data[_pos++]) : -1;
+    }
+
+    int peek() override {
+      return _pos < _data.size() ? static_cast<uint8_t>(_data[_pos]) : -1;
+    }
+
+    size_t write(uint8_t c) override {
+      _data += static_cast<char>(c);
+      return 1;
+    }
+
+    size_t getPosition() const {
+      return _pos;
+    }
+
+  private:
+    std::string _data;
+    size_t _pos = 0;
+  };
+
+} // host
+
+#endif // HostStream_h_
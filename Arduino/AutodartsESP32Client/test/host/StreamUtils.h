@@ -0,0 +1,7 @@
+#ifndef HostStreamUtils_h_
+#define HostStreamUtils_h_
+
+// StreamUtils is included by the client, none of its classes are used on
+// the host
+
+#endif // HostStreamUtils_h_
@@ -0,0 +1,175 @@
+#ifndef HostWString_h_
+#define HostWString_h_
+
+// Arduino String on top of std::string, with the members the client uses
+
+#include <ctype.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+#define F(string_literal) (string_literal)
+
+class String {
+public:
+  String(const char* value = "") : _value(value ? value : "") {}
+  String(const char* value, size_t length) : _value(value ? value : "", value ? length : 0) {}
+  String(const std::string& value) : _value(value) {}
+  explicit String(char value) : _value(1, value) {}
+  explicit String(int value)                { format("%d", value); }
+  explicit String(unsigned int value)       { format("%u", value); }
+  explicit String(long value)               { format("%ld", value); }
+  explicit String(unsigned long value)      { format("%lu", value); }
+  explicit String(long long value)          { format("%lld", value); }
+  explicit String(unsigned long long value) { format("%llu", value); }
+  explicit String(double value, unsigned int decimals = 2) { format("%.*f", decimals, value); }
+
+  const char* c_str() const {
+    return _value.c_str();
+  }
+
+  size_t length() const {
+    return _value.size();
+  }
+
+  bool isEmpty() const {
+    return _value.empty();
+  }
+
+  char operator[](size_t idx) const {
+    return idx < _value.size() ? _value[idx] : '\0';
+  }
+
+  bool equals(const String& other) const {
+    return _value == other._value;
+  }
+
+  bool equals(const char* other) const {
+    return _value == (other ? other : "");
+  }
+
+  bool equalsIgnoreCase(const String& other) const {
+    return _value.size() == other._value.size() && strcasecmp(c_str(), other.c_str()) == 0;
+  }
+
+  bool startsWith(const String& prefix) const {
+    return _value.compare(0, prefix._value.size(), prefix._value) == 0;
+  }
+
+  bool endsWith(const String& suffix) const {
+    return _value.size() >= suffix._value.size() &&
+           _value.compare(_value.size() - suffix._value.size(), suffix._value.size(), suffix._value) == 0;
+  }
+
+  int indexOf(char c, unsigned int from = 0) const {
+    size_t idx = _value.find(c, from);
+    return idx == std::string::npos ? -1 : static_cast<int>(idx);
+  }
+
+  int indexOf(const String& value, unsigned int from = 0) const {
+    size_t idx = _value.find(value._value, from);
+    return idx == std::string::npos ? -1 : static_cast<int>(idx);
+  }
+
+  String substring(unsigned int begin) const {
+    return begin < _value.size() ? String(_value.substr(begin)) : String();
+  }
+
+  String substring(unsigned int begin, unsigned int end) const {
+    if (end > _value.size()) {
+      end = _value.size();
+    }
+    return begin < end ? String(_value.substr(begin, end - begin)) : String();
+  }
+
+  long toInt() const {
+    return strtol(c_str(), nullptr, 10);
+  }
+
+  void trim() {
+    size_t begin = 0, end = _value.size();
+    while (begin < end && isspace(static_cast<unsigned char>(_value[begin]))) {
+      begin++;
+    }
+    while (end > begin && isspace(static_cast<unsigned char>(_value[end - 1]))) {
+      end--;
+    }
+    _value = _value.substr(begin, end - begin);
+  }
+
+  bool reserve(size_t size) {
+    _value.reserve(size);
+    return true;
+  }
+
+  String& operator+=(const String& other) {
+    _value += other._value;
+    return *this;
+  }
+
+  String& operator+=(const char* other) {
+    _value += other ? other : "";
+    return *this;
+  }
+
+  String& operator+=(char c) {
+    _value += c;
+    return *this;
+  }
+
+  bool operator==(const String& other) const {
+    return _value == other._value;
+  }
+
+  bool operator==(const char* other) const {
+    return equals(other);
+  }
+
+  bool operator!=(const String& other) const {
+    return !(*this == other);
+  }
+
+  bool operator!=(const char* other) const {
+    return !equals(other);
+  }
+
+  bool operator<(const String& other) const {
+    return _value < other._value;
+  }
+
+  friend String operator+(const String& lhs, const String& rhs) {
+    return String(lhs._value + rhs._value);
+  }
+
+  friend String operator+(const String& lhs, const char* rhs) {
+    return String(lhs._value + (rhs ? rhs : ""));
+  }
+
+  friend String operator+(const char* lhs, const String& rhs) {
+    return String((lhs ? lhs : "") + rhs._value);
+  }
+
+  friend String operator+(const String& lhs, char rhs) {
+    return String(lhs._value + rhs);
+  }
+
+private:
+  template<typename T>
+  void format(const char* format, T value) {
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), format, value);
+    _value = buffer;
+  }
+
+  void format(const char* format, unsigned int decimals, double value) {
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), format, decimals, value);
+    _value = buffer;
+  }
+
+  std::string _value;
+};
+
+#endif // HostWString_h_
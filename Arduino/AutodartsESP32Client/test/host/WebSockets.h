@@ -0,0 +1,20 @@
+#ifndef HostWebSockets_h_
+#define HostWebSockets_h_
+
+// Declarations shared by the client and server of links2004/arduinoWebSockets
+
+typedef enum {
+  WStype_ERROR,
+  WStype_DISCONNECTED,
+  WStype_CONNECTED,
+  WStype_TEXT,
+  WStype_BIN,
+  WStype_FRAGMENT_TEXT_START,
+  WStype_FRAGMENT_BIN_START,
+  WStype_FRAGMENT,
+  WStype_FRAGMENT_FIN,
+  WStype_PING,
+  WStype_PONG,
+} WStype_t;
+
+#endif // HostWebSockets_h_
@@ -0,0 +1,100 @@
+#ifndef HostWebSocketsClient_h_
+#define HostWebSocketsClient_h_
+
+// WebSocketsClient of links2004/arduinoWebSockets on the fake endpoints.
+// loop() connects when the reconnect interval elapsed and delivers at most
+// one frame, the payload buffer is only valid during the event callback.
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <Arduino.h>
+
+#include "WebSockets.h"
+#include "WebsocketEndpoints.h"
+
+class WebSocketsClient {
+public:
+  typedef std::function<void(WStype_t type, uint8_t* payload, size_t length)> WebSocketClientEvent;
+
+  void begin(const String& host, uint16_t port, const char* path) {
+    _key = host::ws::key(host.c_str(), port, path);
+    _enabled = true;
+    _connected = false;
+    _attempted = false;
+  }
+
+  void onEvent(WebSocketClientEvent callback) {
+    _callback = callback;
+  }
+
+  void setReconnectInterval(unsigned long interval) {
+    _reconnectInterval = interval;
+  }
+
+  void disconnect() {
+    _enabled = false;
+    if (_connected) {
+      _connected = false;
+      _callback(WStype_DISCONNECTED, nullptr, 0);
+    }
+  }
+
+  bool isConnected() const {
+    return _connected;
+  }
+
+  bool sendTXT(const char* payload) {
+    if (!_connected) {
+      return false;
+    }
+    std::string frame(payload);
+    host::ws::with(_key, [&frame](host::ws::Endpoint& endpoint) { endpoint.sent.push_back(frame); });
+    return true;
+  }
+
+  void loop() {
+    if (!_enabled) {
+      return;
+    }
+    if (!_connected) {
+      if (_attempted && millis() - _lastAttempt < _reconnectInterval) {
+        return;
+      }
+      _attempted = true;
+      _lastAttempt = millis();
+      if (host::ws::handshake(_key)) {
+        _connected = true;
+        _callback(WStype_CONNECTED, nullptr, 0);
+      }
+      return;
+    }
+
+    std::string frame;
+    bool received;
+    if (!host::ws::receive(_key, frame, received)) {
+      _connected = false;
+      _lastAttempt = millis();
+      _callback(WStype_DISCONNECTED, nullptr, 0);
+      return;
+    }
+    if (received) {
+      _buffer.assign(frame.begin(), frame.end());
+      _buffer.push_back('\0');
+      _callback(WStype_TEXT, reinterpret_cast<uint8_t*>(_buffer.data()), frame.size());
+    }
+  }
+
+private:
+  WebSocketClientEvent _callback = [](WStype_t, uint8_t*, size_t) {};
+  std::string          _key;
+  std::vector<char>    _buffer;
+  unsigned long        _reconnectInterval = 500;
+  uint32_t             _lastAttempt = 0;
+  bool                 _enabled = false;
+  bool                 _connected = false;
+  bool                 _attempted = false;
+};
+
+#endif // HostWebSocketsClient_h_
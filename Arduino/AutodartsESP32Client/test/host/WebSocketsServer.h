@@ -0,0 +1,139 @@
+#ifndef HostWebSocketsServer_h_
+#define HostWebSocketsServer_h_
+
+// WebSocketsServer of links2004/arduinoWebSockets on sockets handed in by
+// the test. host::wss::connect() queues a subscriber for the server on a
+// port, loop() accepts it. sendTXT() writes the payload with a blocking
+// send bounded by the socket's send timeout, like the synchronous write of
+// the library, so a subscriber that does not read stalls the caller.
+
+#include <errno.h>
+#include <functional>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <Arduino.h>
+
+#include "WebSockets.h"
+#include "WiFiClient.h"
+
+#ifndef WEBSOCKETS_SERVER_CLIENT_MAX
+#define WEBSOCKETS_SERVER_CLIENT_MAX 5
+#endif
+
+namespace host {
+  namespace wss {
+
+    // Sockets waiting to be accepted per server port
+    inline std::map<uint16_t, std::vector<int>>& pending() {
+      static std::map<uint16_t, std::vector<int>> value;
+      return value;
+    }
+
+    inline void connect(uint16_t port, int fd) {
+      pending()[port].push_back(fd);
+    }
+
+  } // wss
+} // host
+
+struct WSclient_t {
+  uint8_t     num = 0;
+  WiFiClient* tcp = nullptr;
+  WiFiClient  socket;
+};
+
+class WebSocketsServer {
+public:
+  typedef std::function<void(uint8_t num, WStype_t type, uint8_t* payload, size_t length)> WebSocketServerEvent;
+
+  WebSocketsServer(uint16_t port) : _port(port) {
+    for (uint8_t num = 0; num < WEBSOCKETS_SERVER_CLIENT_MAX; num++) {
+      _clients[num].num = num;
+    }
+  }
+
+  // Closes the sockets without events, the owner may be gone already
+  virtual ~WebSocketsServer() {
+    for (WSclient_t& client : _clients) {
+      if (client.tcp) {
+        close(client.tcp->fd());
+      }
+    }
+  }
+
+  void begin() {
+    _running = true;
+  }
+
+  void onEvent(WebSocketServerEvent callback) {
+    _callback = callback;
+  }
+
+  // Accepts pending subscribers into free slots, the rest are refused
+  void loop() {
+    if (!_running) {
+      return;
+    }
+    std::vector<int>& pending = host::wss::pending()[_port];
+    for (int fd : pending) {
+      uint8_t num = 0;
+      while (num < WEBSOCKETS_SERVER_CLIENT_MAX && _clients[num].tcp) {
+        num++;
+      }
+      if (num == WEBSOCKETS_SERVER_CLIENT_MAX) {
+        close(fd);
+        continue;
+      }
+      _clients[num].socket = WiFiClient(fd);
+      _clients[num].tcp = &_clients[num].socket;
+      _callback(num, WStype_CONNECTED, nullptr, 0);
+    }
+    pending.clear();
+  }
+
+  void disconnect(uint8_t num) {
+    if (num < WEBSOCKETS_SERVER_CLIENT_MAX && _clients[num].tcp) {
+      close(_clients[num].tcp->fd());
+      _clients[num].tcp = nullptr;
+      _callback(num, WStype_DISCONNECTED, nullptr, 0);
+    }
+  }
+
+  bool sendTXT(uint8_t num, const uint8_t* payload, size_t length) {
+    if (num >= WEBSOCKETS_SERVER_CLIENT_MAX || !_clients[num].tcp) {
+      return false;
+    }
+    size_t sent = 0;
+    while (sent < length) {
+      ssize_t count = send(_clients[num].tcp->fd(), payload + sent, length - sent, MSG_NOSIGNAL);
+      if (count <= 0) {
+        return false;
+      }
+      sent += count;
+    }
+    return true;
+  }
+
+  uint8_t connectedClients() {
+    uint8_t count = 0;
+    for (const WSclient_t& client : _clients) {
+      count += client.tcp != nullptr;
+    }
+    return count;
+  }
+
+protected:
+  WSclient_t _clients[WEBSOCKETS_SERVER_CLIENT_MAX];
+
+private:
+  uint16_t             _port;
+  bool                 _running = false;
+  WebSocketServerEvent _callback = [](uint8_t, WStype_t, uint8_t*, size_t) {};
+};
+
+#endif // HostWebSocketsServer_h_
@@ -0,0 +1,97 @@
+#ifndef HostWebsocketEndpoints_h_
+#define HostWebsocketEndpoints_h_
+
+// Endpoints the fake websocket clients connect to, keyed by host, port and
+// path. Tests queue frames on an endpoint and script its handshake. A
+// handshake delay sleeps for real, so a client connecting on the loop task
+// blocks the loop like the libraries do on the target.
+
+#include <stdint.h>
+#include <chrono>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace host {
+  namespace ws {
+
+    struct Endpoint {
+      bool                    accept = true;
+      uint32_t                handshakeMillis = 0;
+      std::deque<std::string> frames;
+      std::deque<std::string> sent;
+      uint32_t                numConnects = 0;
+      bool                    dropped = false;
+    };
+
+    struct Registry {
+      std::mutex                      mutex;
+      std::map<std::string, Endpoint> endpoints;
+    };
+
+    inline Registry& registry() {
+      static Registry value;
+      return value;
+    }
+
+    inline std::string key(const std::string& host, uint16_t port, const std::string& path) {
+      return host + ":" + std::to_string(port) + path;
+    }
+
+    // Endpoints are created on first use and live until reset()
+    template<typename TFunction>
+    auto with(const std::string& key, TFunction function) -> decltype(function(std::declval<Endpoint&>())) {
+      std::lock_guard<std::mutex> lock(registry().mutex);
+      return function(registry().endpoints[key]);
+    }
+
+    inline void push(const std::string& key, const std::string& frame) {
+      with(key, [&frame](Endpoint& endpoint) { endpoint.frames.push_back(frame); });
+    }
+
+    // Closes the current connection of the endpoint from the server side
+    inline void drop(const std::string& key) {
+      with(key, [](Endpoint& endpoint) { endpoint.dropped = true; });
+    }
+
+    inline void reset() {
+      std::lock_guard<std::mutex> lock(registry().mutex);
+      registry().endpoints.clear();
+    }
+
+    // Runs the handshake, returns false if the endpoint refused it
+    inline bool handshake(const std::string& key) {
+      uint32_t delay = with(key, [](Endpoint& endpoint) { return endpoint.handshakeMillis; });
+      std::this_thread::sleep_for(std::chrono::milliseconds(delay));
+      return with(key, [](Endpoint& endpoint) {
+        if (!endpoint.accept) {
+          return false;
+        }
+        endpoint.numConnects++;
+        endpoint.dropped = false;
+        return true;
+      });
+    }
+
+    // Takes the next frame, returns false if the connection was dropped
+    inline bool receive(const std::string& key, std::string& frame, bool& received) {
+      return with(key, [&frame, &received](Endpoint& endpoint) {
+        received = false;
+        if (endpoint.dropped) {
+          return false;
+        }
+        if (!endpoint.frames.empty()) {
+          frame.swap(endpoint.frames.front());
+          endpoint.frames.pop_front();
+          received = true;
+        }
+        return true;
+      });
+    }
+
+  } // ws
+} // host
+
+#endif // HostWebsocketEndpoints_h_
@@ -0,0 +1,29 @@
+#ifndef HostWiFi_h_
+#define HostWiFi_h_
+
+#include "IPAddress.h"
+
+// Station interface of the ESP32 core, tests set the addresses
+class WiFiClass {
+public:
+  IPAddress localIP() const {
+    return _localIP;
+  }
+
+  IPAddress subnetMask() const {
+    return _subnetMask;
+  }
+
+  void setAddress(const IPAddress& localIP, const IPAddress& subnetMask) {
+    _localIP = localIP;
+    _subnetMask = subnetMask;
+  }
+
+private:
+  IPAddress _localIP{127, 0, 0, 1};
+  IPAddress _subnetMask{255, 255, 255, 0};
+};
+
+static WiFiClass WiFi __attribute__((unused));
+
+#endif // HostWiFi_h_
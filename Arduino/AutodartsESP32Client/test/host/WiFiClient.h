@@ -0,0 +1,18 @@
+#ifndef HostWiFiClient_h_
+#define HostWiFiClient_h_
+
+// TCP client of the ESP32 core reduced to its socket, host tests hand in
+// one end of a socket pair
+class WiFiClient {
+public:
+  WiFiClient(int fd = -1) : _fd(fd) {}
+
+  int fd() const {
+    return _fd;
+  }
+
+private:
+  int _fd;
+};
+
+#endif // HostWiFiClient_h_
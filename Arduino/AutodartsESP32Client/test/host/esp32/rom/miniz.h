@@ -0,0 +1,81 @@
+#ifndef HostMiniz_h_
+#define HostMiniz_h_
+
+// Inflater of the ESP32 ROM (miniz tinfl), backed by zlib inflating raw
+// deflate data. Statuses and the in/out size protocol follow tinfl, the
+// output buffer may be used as a wrapping dictionary like on the target.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <zlib.h>
+
+typedef uint8_t  mz_uint8;
+typedef uint32_t mz_uint32;
+
+#define TINFL_LZ_DICT_SIZE        32768
+#define TINFL_FLAG_HAS_MORE_INPUT 2
+
+typedef enum {
+  TINFL_STATUS_FAILED_CANNOT_MAKE_PROGRESS = -4,
+  TINFL_STATUS_BAD_PARAM                   = -3,
+  TINFL_STATUS_ADLER32_MISMATCH            = -2,
+  TINFL_STATUS_FAILED                      = -1,
+  TINFL_STATUS_DONE                        = 0,
+  TINFL_STATUS_NEEDS_MORE_INPUT            = 1,
+  TINFL_STATUS_HAS_MORE_OUTPUT             = 2,
+} tinfl_status;
+
+struct tinfl_decompressor {
+  z_stream stream;
+  bool     initialized = false;
+  bool     done = false;
+
+  ~tinfl_decompressor() {
+    if (initialized) {
+      inflateEnd(&stream);
+    }
+  }
+};
+
+inline void tinfl_init(tinfl_decompressor* r) {
+  if (r->initialized) {
+    inflateEnd(&r->stream);
+  }
+  r->stream = z_stream();
+  r->initialized = inflateInit2(&r->stream, -MAX_WBITS) == Z_OK;
+  r->done = false;
+}
+
+inline tinfl_status tinfl_decompress(tinfl_decompressor* r, const mz_uint8* pIn_buf_next, size_t* pIn_buf_size,
+                                     mz_uint8* pOut_buf_start, mz_uint8* pOut_buf_next, size_t* pOut_buf_size,
+                                     const mz_uint32 decomp_flags) {
+  if (!r->initialized) {
+    *pIn_buf_size = *pOut_buf_size = 0;
+    return TINFL_STATUS_BAD_PARAM;
+  }
+  if (r->done) {
+    *pIn_buf_size = *pOut_buf_size = 0;
+    return TINFL_STATUS_DONE;
+  }
+  r->stream.next_in   = const_cast<mz_uint8*>(pIn_buf_next);
+  r->stream.avail_in  = *pIn_buf_size;
+  r->stream.next_out  = pOut_buf_next;
+  r->stream.avail_out = *pOut_buf_size;
+  int ret = inflate(&r->stream, Z_NO_FLUSH);
+  *pIn_buf_size -= r->stream.avail_in;
+  *pOut_buf_size -= r->stream.avail_out;
+
+  if (ret == Z_STREAM_END) {
+    r->done = true;
+    return TINFL_STATUS_DONE;
+  }
+  if (ret != Z_OK && ret != Z_BUF_ERROR) {
+    return TINFL_STATUS_FAILED;
+  }
+  if (r->stream.avail_out == 0) {
+    return TINFL_STATUS_HAS_MORE_OUTPUT;
+  }
+  return (decomp_flags & TINFL_FLAG_HAS_MORE_INPUT) ? TINFL_STATUS_NEEDS_MORE_INPUT : TINFL_STATUS_FAILED_CANNOT_MAKE_PROGRESS;
+}
+
+#endif // HostMiniz_h_
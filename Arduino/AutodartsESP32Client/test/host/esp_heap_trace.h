@@ -0,0 +1,67 @@
+#ifndef HostEspHeapTrace_h_
+#define HostEspHeapTrace_h_
+
+#include <stddef.h>
+
+#include "HeapHook.h"
+
+// Standalone heap tracing of the IDF, counting the allocations the malloc
+// hook sees while tracing. Records are not kept, only counted.
+
+typedef int esp_err_t;
+
+#define ESP_OK   0
+#define ESP_FAIL -1
+
+typedef struct {
+  void*  address;
+  size_t size;
+} heap_trace_record_t;
+
+typedef enum {
+  HEAP_TRACE_ALL,
+  HEAP_TRACE_LEAKS,
+} heap_trace_mode_t;
+
+namespace host {
+
+  struct HeapTrace {
+    bool     tracing = false;
+    uint32_t start = 0;
+    uint32_t count = 0;
+  };
+
+  inline HeapTrace& heapTrace() {
+    static HeapTrace value;
+    return value;
+  }
+
+} // host
+
+inline esp_err_t heap_trace_init_standalone(heap_trace_record_t* records, size_t numRecords) {
+  return records && numRecords ? ESP_OK : ESP_FAIL;
+}
+
+inline esp_err_t heap_trace_start(heap_trace_mode_t mode) {
+  host::HeapTrace& trace = host::heapTrace();
+  trace.tracing = true;
+  trace.start = host::heapHook().allocations;
+  return ESP_OK;
+}
+
+inline esp_err_t heap_trace_stop() {
+  host::HeapTrace& trace = host::heapTrace();
+  if (!trace.tracing) {
+    return ESP_FAIL;
+  }
+  trace.tracing = false;
+  trace.count = host::heapHook().allocations - trace.start;
+  return ESP_OK;
+}
+
+inline size_t heap_trace_get_count() {
+  const host::HeapTrace& trace = host::heapTrace();
+  return trace.tracing ? host::heapHook().allocations - trace.start : trace.count;
+}
+
+#endif // HostEspHeapTrace_h_
@@ -0,0 +1,169 @@
+#ifndef HostFreeRTOS_h_
+#define HostFreeRTOS_h_
+
+// The FreeRTOS calls of the client on std::thread. Ticks are milliseconds
+// like the default configuration of the ESP32 core. Deleting another task
+// is deferred until it next blocks in a FreeRTOS call, which is where the
+// client's tasks wait when they are deleted.
+
+#include <stdint.h>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+typedef int           BaseType_t;
+typedef unsigned int  UBaseType_t;
+typedef uint32_t      TickType_t;
+typedef void (*TaskFunction_t)(void*);
+
+#define pdFALSE            0
+#define pdTRUE             1
+#define pdFAIL             0
+#define pdPASS             1
+#define portMAX_DELAY      0xffffffffu
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms)  (ms)
+
+namespace host {
+  namespace rtos {
+
+    struct TaskExit {};
+
+    struct Task {
+      std::mutex              mutex;
+      std::condition_variable changed;
+      uint32_t                notifications = 0;
+      bool                    deleted = false;
+    };
+
+    inline Task*& currentTask() {
+      static thread_local Task* task = nullptr;
+      return task;
+    }
+
+    // Waits until ready() holds, the timeout elapsed or the task is deleted
+    template<typename TReady>
+    bool wait(std::unique_lock<std::mutex>& lock, std::condition_variable& changed, TickType_t ticks, TReady ready) {
+      Task* task = currentTask();
+      auto done = [&] { return ready() || (task && task->deleted); };
+      bool ok = ticks == portMAX_DELAY ? (changed.wait(lock, done), true)
+                                       : changed.wait_for(lock, std::chrono::milliseconds(ticks), done);
+      if (task && task->deleted) {
+        throw TaskExit();
+      }
+      return ok && ready();
+    }
+
+    struct Semaphore {
+      std::mutex              mutex;
+      std::condition_variable changed;
+      uint32_t                count;
+      uint32_t                max;
+    };
+
+  } // rtos
+} // host
+
+typedef host::rtos::Task*      TaskHandle_t;
+typedef host::rtos::Semaphore* SemaphoreHandle_t;
+
+inline BaseType_t xTaskCreate(TaskFunction_t function, const char*, uint32_t, void* parameter, UBaseType_t, TaskHandle_t* handle) {
+  host::rtos::Task* task = new host::rtos::Task;
+  if (handle) {
+    *handle = task;
+  }
+  std::thread([task, function, parameter] {
+    host::rtos::currentTask() = task;
+    try {
+      function(parameter);
+    }
+    catch (const host::rtos::TaskExit&) {
+    }
+    delete task;
+  }).detach();
+  return pdPASS;
+}
+
+inline BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char* name, uint32_t stack, void* parameter, UBaseType_t priority, TaskHandle_t* handle, BaseType_t) {
+  return xTaskCreate(function, name, stack, parameter, priority, handle);
+}
+
+inline TaskHandle_t xTaskGetCurrentTaskHandle() {
+  return host::rtos::currentTask();
+}
+
+inline void vTaskDelete(TaskHandle_t task) {
+  if (task == nullptr || task == host::rtos::currentTask()) {
+    throw host::rtos::TaskExit();
+  }
+  std::lock_guard<std::mutex> lock(task->mutex);
+  task->deleted = true;
+  task->changed.notify_all();
+}
+
+inline void vTaskDelay(TickType_t ticks) {
+  host::rtos::Task* task = host::rtos::currentTask();
+  if (!task) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ticks));
+    return;
+  }
+  std::unique_lock<std::mutex> lock(task->mutex);
+  host::rtos::wait(lock, task->changed, ticks, [] { return false; });
+}
+
+inline uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticks) {
+  host::rtos::Task* task = host::rtos::currentTask();
+  std::unique_lock<std::mutex> lock(task->mutex);
+  host::rtos::wait(lock, task->changed, ticks, [task] { return task->notifications > 0; });
+  uint32_t value = task->notifications;
+  task->notifications = clearOnExit ? 0 : (value ? value - 1 : 0);
+  return value;
+}
+
+inline BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+  std::lock_guard<std::mutex> lock(task->mutex);
+  task->notifications++;
+  task->changed.notify_all();
+  return pdPASS;
+}
+
+inline SemaphoreHandle_t xSemaphoreCreateCounting(uint32_t max, uint32_t initial) {
+  SemaphoreHandle_t semaphore = new host::rtos::Semaphore;
+  semaphore->count = initial;
+  semaphore->max   = max;
+  return semaphore;
+}
+
+inline SemaphoreHandle_t xSemaphoreCreateBinary() {
+  return xSemaphoreCreateCounting(1, 0);
+}
+
+inline SemaphoreHandle_t xSemaphoreCreateMutex() {
+  return xSemaphoreCreateCounting(1, 1);
+}
+
+inline void vSemaphoreDelete(SemaphoreHandle_t semaphore) {
+  delete semaphore;
+}
+
+inline BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks) {
+  std::unique_lock<std::mutex> lock(semaphore->mutex);
+  if (!host::rtos::wait(lock, semaphore->changed, ticks, [semaphore] { return semaphore->count > 0; })) {
+    return pdFALSE;
+  }
+  semaphore->count--;
+  return pdTRUE;
+}
+
+inline BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+  std::lock_guard<std::mutex> lock(semaphore->mutex);
+  if (semaphore->count >= semaphore->max) {
+    return pdFALSE;
+  }
+  semaphore->count++;
+  semaphore->changed.notify_all();
+  return pdTRUE;
+}
+
+#endif // HostFreeRTOS_h_
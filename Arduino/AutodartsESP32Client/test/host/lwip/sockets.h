@@ -0,0 +1,13 @@
+#ifndef HostLwipSockets_h_
+#define HostLwipSockets_h_
+
+// lwIP offers the BSD socket API, on the host the system sockets are used
+// directly, so probes reach real listeners on the loopback interface
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+
+#endif // HostLwipSockets_h_
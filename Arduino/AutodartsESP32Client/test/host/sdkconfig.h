@@ -0,0 +1,8 @@
+#ifndef HostSdkconfig_h_
+#define HostSdkconfig_h_
+
+// IDF configuration of the host build: heap tracing is available, backed
+// by the malloc hook of the tests
+#define CONFIG_HEAP_TRACING_STANDALONE 1
+
+#endif // HostSdkconfig_h_
@@ -0,0 +1,194 @@
+// Drives a board through a loopback transport. Payloads are parsed in place
+// in their queue slot, so the frame handed out by the transport, the
+// message callback and the capture must still see the original bytes, and
+// escaped strings must come out right although they are unescaped over
+// the payload.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#include <Arduino.h>
+
+#include "AutodartsBoard.h"
+#include "TestUtil.h"
+
+using namespace autodarts;
+
+static std::string state(int numThrows, const char* event = "Throw detected") {
+  return "{\"type\":\"state\",\"data\":{\"connected\":true,\"running\":true,\"status\":\"Throw\",\"event\":\"" +
+         std::string(event) + "\",\"numThrows\":" + std::to_string(numThrows) + "}}";
+}
+
+// Opens the board on a loopback transport and returns the transport
+static LoopbackTransport* openLoopback(Board& board) {
+  LoopbackTransport* transport = new LoopbackTransport;
+  board.setTransport(std::unique_ptr<Transport>(transport));
+  CHECK(board.open());
+  board.update();
+  CHECK(board.isOpen());
+  return transport;
+}
+
+// Loopback delivering frames from a buffer the test can inspect afterwards
+class InspectableTransport : public LoopbackTransport {
+public:
+  bool poll() override {
+    if (_frame.empty()) {
+      return LoopbackTransport::poll();
+    }
+    _onEventCallback(Type::TEXT, &_frame[0], _frame.size());
+    _delivered = _frame;
+    _frame.clear();
+    return true;
+  }
+
+  void deliver(const std::string& frame) {
+    _frame = frame;
+  }
+
+  // Frame buffer as the board left it
+  const std::string& getDelivered() const {
+    return _delivered;
+  }
+
+private:
+  std::string _frame;
+  std::string _delivered;
+};
+
+static void checkEscapedStrings() {
+  Board board("Board", "board-id", "1.0", "127.0.0.1:3180");
+  LoopbackTransport* transport = openLoopback(board);
+
+  Event::Code event = Event::Code::UNKNOWN;
+  Status::Code status = Status::Code::UNKNOWN;
+  board.onDetectionEvent([&](const String&, const String&, Status::Code s, Event::Code e) {
+    status = s;
+    event = e;
+  });
+
+  // Escapes shrink the strings while they are unescaped in place, the
+  // following keys and values must not be shifted
+  std::string message = "{\"type\":\"st\\u0061te\",\"data\":{\"status\":\"Takeout in\\u0020progress\","
+                        "\"event\":\"Takeout\\tstarted\",\"numThrows\":3,\"connected\":true}}";
+  transport->push(message.c_str(), message.size());
+  board.update();
+  CHECK(status == Status::Code::TAKEOUT_PROGRESS);
+  CHECK(event == Event::Code::UNKNOWN);
+  CHECK_EQ(board.getDetector().getNumThrows(), 3);
+  CHECK(board.getDetector().isConnected());
+
+  message = "{\"type\":\"state\",\"data\":{\"status\":\"Takeout\",\"event\":\"Takeout \\u0073tarted\",\"numThrows\":0}}";
+  transport->push(message.c_str(), message.size());
+  board.update();
+  CHECK(status == Status::Code::TAKEOUT);
+  CHECK(event == Event::Code::TAKEOUT_STARTED);
+  CHECK_EQ(board.getDetector().getNumThrows(), 0);
+}
+
+static void checkSourceBuffersUntouched() {
+  Board board("Board", "board-id", "1.0", "127.0.0.1:3180");
+  InspectableTransport* transport = new InspectableTransport;
+  board.setTransport(std::unique_ptr<Transport>(transport));
+  CHECK(board.open());
+  board.update();
+
+  std::vector<std::string> seen;
+  board.onBoardMessage([&seen](const String&, const String&, const char* payload, size_t length) {
+    seen.emplace_back(payload, length);
+  });
+
+  fs::FS fs(".");
+  CHECK(board.startCapture(fs, "/test_board.adc"));
+
+  std::string message = "{\"type\":\"state\",\"data\":{\"event\":\"Throw\\u0020detected\",\"numThrows\":1}}";
+  transport->deliver(message);
+  board.update();
+  board.stopCapture();
+
+  // The parse ran on the queue slot, not on the transport frame
+  CHECK(transport->getDelivered() == message);
+  CHECK_EQ(seen.size(), 1);
+  CHECK(seen.size() == 1 && seen[0] == message);
+  CHECK(board.getDetector().getEvent().value() == Event::Code::THROW_DETECTED);
+
+  // The capture holds the original bytes behind the header and two varints
+  fs::File file = fs.open("/test_board.adc", FILE_READ);
+  std::vector<uint8_t> captured(file.size());
+  CHECK_EQ(file.read(captured.data(), captured.size()), captured.size());
+  file.close();
+  fs.remove("/test_board.adc");
+  CHECK(captured.size() == 4 + 2 + message.size());
+  CHECK(captured.size() >= message.size() &&
+        std::string(captured.end() - message.size(), captured.end()) == message);
+}
+
+// With the state ring full, the oldest message is parsed in its slot while
+// the new payload is still pending. Both must arrive unchanged and in order.
+static void checkOverflowKeepsPayload() {
+  Board board("Board", "board-id", "1.0", "127.0.0.1:3180");
+  openLoopback(board);
+
+  std::vector<int> numThrows;
+  board.onDetectionState([&numThrows](const String&, const String&, State, State, int16_t throws) {
+    numThrows.push_back(throws);
+  });
+
+  std::vector<std::string> messages;
+  for (int idx = 0; idx <= AUTODARTS_STATE_QUEUE_SIZE; idx++) {
+    messages.push_back(state(idx));
+  }
+  for (std::string& message : messages) {
+    std::vector<char> buffer(message.begin(), message.end());
+    buffer.push_back('\0');
+    board.receive(buffer.data(), message.size());
+    CHECK(std::string(buffer.data()) == message);
+  }
+  CHECK_EQ(board.getNumOverflows(), 1);
+  CHECK_EQ(numThrows.size(), 1);
+
+  board.dispatch();
+  CHECK_EQ(numThrows.size(), messages.size());
+  for (size_t idx = 0; idx < numThrows.size(); idx++) {
+    CHECK_EQ(numThrows[idx], idx);
+  }
+}
+
+// Swapping the transport while the first one is still connecting closes
+// it and lets the next open() start the new one
+static void checkSwapWhileConnecting() {
+  Board board("Board", "board-id", "1.0", "127.0.0.1:3180");
+  LoopbackTransport* first = new LoopbackTransport;
+  board.setTransport(std::unique_ptr<Transport>(first));
+  CHECK(board.open());
+  CHECK(!board.isOpen());
+
+  LoopbackTransport* second = new LoopbackTransport;
+  board.setTransport(std::unique_ptr<Transport>(second));
+  CHECK(board.open());
+  board.update();
+  CHECK(board.isOpen());
+
+  std::string message = state(2);
+  second->push(message.c_str(), message.size());
+  board.update();
+  CHECK_EQ(board.getNumMessages(), 1);
+  CHECK_EQ(board.getDetector().getNumThrows(), 2);
+
+  // An open board is closed by the swap as well
+  board.setTransport(std::unique_ptr<Transport>(new LoopbackTransport));
+  CHECK(!board.isOpen());
+  CHECK(board.open());
+  board.update();
+  CHECK(board.isOpen());
+}
+
+int main() {
+  checkEscapedStrings();
+  checkSourceBuffersUntouched();
+  checkOverflowKeepsPayload();
+  checkSwapWhileConnecting();
+  return testResult("board");
+}
@@ -0,0 +1,90 @@
+// Feeds cam_stats with ids around the NumCameras boundary to camera systems
+// of different sizes and checks that only ids inside it are stored.
+
+#include <stdio.h>
+#include <string>
+
+#include <Arduino.h>
+
+#include "AutodartsCameras.h"
+#include "TestUtil.h"
+
+using namespace autodarts;
+
+static std::string camStats(const std::string& id, int fps) {
+  return "{\"type\":\"cam_stats\",\"data\":{" + id + "\"fps\":" + std::to_string(fps) +
+         ",\"resolution\":{\"width\":1280,\"height\":720}}}";
+}
+
+template<uint8_t NumCameras>
+static void send(CameraSystemT<NumCameras>& cameras, const std::string& message) {
+  DynamicJsonDocument json(512);
+  CHECK(!deserializeJson(json, message.c_str()));
+  cameras.fromJson(json.as<JsonObjectConst>());
+}
+
+template<uint8_t NumCameras>
+static void send(CameraSystemT<NumCameras>& cameras, int id, int fps) {
+  send(cameras, camStats("\"id\":" + std::to_string(id) + ",", fps));
+}
+
+static void checkBoundary() {
+  String name("Board"), id("board-id");
+  CameraSystemT<2> cameras(name, id);
+  int reported = 0, lastId = -1;
+  cameras.onCameraStats([&](const String&, const String&, int8_t id, int8_t, int16_t, int16_t) {
+    reported++;
+    lastId = id;
+  });
+
+  CHECK(!cameras.hasCamera(0));
+  CHECK(!cameras.getCameraById(0).isValid());
+
+  send(cameras, 0, 30);
+  send(cameras, 1, 25);
+  CHECK_EQ(reported, 2);
+  CHECK_EQ(lastId, 1);
+  CHECK(cameras.hasCamera(0) && cameras.hasCamera(1));
+  CHECK_EQ(cameras.getCameraById(0).getFPS(), 30);
+  CHECK_EQ(cameras[1].getFPS(), 25);
+  CHECK_EQ(cameras[1].getWidth(), 1280);
+  CHECK_EQ(cameras[1].getHeight(), 720);
+
+  // NumCameras itself, negative ids, ids that wrap into range as int8_t
+  // and missing ids are rejected without touching the stored stats
+  uint32_t warnings = host::log().count[LOG_LEVEL_WARNING];
+  send(cameras, 2, 10);
+  send(cameras, -1, 10);
+  send(cameras, 256, 10);
+  send(cameras, 257, 10);
+  send(cameras, camStats("", 10));
+  CHECK_EQ(reported, 2);
+  CHECK_EQ(host::log().count[LOG_LEVEL_WARNING] - warnings, 5);
+  CHECK(!cameras.hasCamera(2));
+  CHECK(!cameras.hasCamera(-1));
+  CHECK(!cameras.getCameraById(2).isValid());
+  CHECK_EQ(cameras.getCameraById(0).getFPS(), 30);
+  CHECK_EQ(cameras.getCameraById(1).getFPS(), 25);
+
+  // Unsigned indices past int8_t do not wrap into range either
+  CHECK(!cameras[255].isValid());
+}
+
+static void checkLargest() {
+  String name("Board"), id("board-id");
+  CameraSystemT<8> cameras(name, id);
+  send(cameras, 7, 15);
+  send(cameras, 8, 15);
+  CHECK(cameras.hasCamera(7));
+  CHECK(!cameras.hasCamera(8));
+  CHECK_EQ(cameras[7].getFPS(), 15);
+  for (int8_t idx = 0; idx < 7; idx++) {
+    CHECK(!cameras.hasCamera(idx));
+  }
+}
+
+int main() {
+  checkBoundary();
+  checkLargest();
+  return testResult("cameras");
+}
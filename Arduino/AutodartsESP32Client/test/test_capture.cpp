@@ -0,0 +1,93 @@
+// Records board traffic to a capture, replays it into a board that is
+// capturing itself and checks that the frames arrive in order with their
+// timing, and are not recorded a second time.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+
+#include <Arduino.h>
+
+#include "AutodartsBoard.h"
+#include "TestUtil.h"
+
+using namespace autodarts;
+
+static std::string state(int numThrows) {
+  return "{\"type\":\"state\",\"data\":{\"connected\":true,\"running\":true,\"status\":\"Throw\",\"event\":\"Throw detected\",\"numThrows\":" +
+         std::to_string(numThrows) + "}}";
+}
+
+static void receive(Board& board, const std::string& message) {
+  std::vector<char> buffer(message.begin(), message.end());
+  buffer.push_back('\0');
+  board.receive(buffer.data(), message.size());
+  board.dispatch();
+}
+
+static void record(fs::FS& fs) {
+  Board board("Board", "board-id", "1.0", "127.0.0.1:3180");
+  host::clockMicros() = 0;
+  CHECK(board.startCapture(fs, "/recorded.adc"));
+  for (int idx = 1; idx <= 3; idx++) {
+    host::advanceMicros(250000);
+    receive(board, state(idx));
+  }
+  board.stopCapture();
+}
+
+static void checkReplay(fs::FS& fs) {
+  Board board("Board", "board-id", "1.0", "127.0.0.1:3180");
+  std::vector<int16_t> numThrows;
+  std::vector<size_t> lengths;
+  board.onDetectionState([&numThrows](const String&, const String&, State, State, int16_t throws) {
+    numThrows.push_back(throws);
+  });
+  board.onBoardMessage([&lengths](const String&, const String&, const char*, size_t length) {
+    lengths.push_back(length);
+  });
+
+  // A capture running on the replaying board only sees live traffic
+  CHECK(board.startCapture(fs, "/live.adc"));
+
+  BoardReplay replay;
+  host::clockMicros() = 0;
+  CHECK(replay.begin(fs, "/recorded.adc"));
+  CHECK(replay.update(board));
+  CHECK_EQ(numThrows.size(), 0);
+
+  host::advanceMicros(250000);
+  CHECK(replay.update(board));
+  CHECK_EQ(numThrows.size(), 1);
+  host::advanceMicros(500000);
+  CHECK(!replay.update(board));
+  CHECK_EQ(replay.getNumFrames(), 3);
+  CHECK_EQ(numThrows.size(), 3);
+  CHECK(numThrows.size() == 3 && numThrows[0] == 1 && numThrows[2] == 3);
+  CHECK_EQ(lengths.size(), 3);
+  CHECK(lengths.size() == 3 && lengths[2] == state(3).size());
+
+  receive(board, state(4));
+  board.stopCapture();
+
+  // Header, then a single frame of the live message
+  fs::File file = fs.open("/live.adc", FILE_READ);
+  CHECK_EQ(file.size(), 4 + 1 + 1 + state(4).size());
+  file.close();
+}
+
+int main() {
+  char root[] = "/tmp/test_capture_XXXXXX";
+  if (!mkdtemp(root)) {
+    return 1;
+  }
+  fs::FS fs(root);
+  record(fs);
+  checkReplay(fs);
+  fs.remove("/recorded.adc");
+  fs.remove("/live.adc");
+  rmdir(root);
+  return testResult("capture");
+}
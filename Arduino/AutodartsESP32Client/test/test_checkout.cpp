@@ -0,0 +1,152 @@
+// Validates the generated checkout tables against a brute force search over
+// all dart combinations for every remaining score from 0 to 170.
+
+#include <string.h>
+#include <vector>
+
+#include "AutodartsCheckout.h"
+#include "TestUtil.h"
+
+using namespace autodarts;
+
+struct Dart {
+  uint8_t multiplier;
+  uint8_t number;
+  int value() const { return multiplier * number; }
+};
+
+static std::vector<Dart> allDarts() {
+  std::vector<Dart> darts;
+  for (uint8_t number = 1; number <= 20; number++) {
+    for (uint8_t multiplier = 1; multiplier <= 3; multiplier++) {
+      darts.push_back({multiplier, number});
+    }
+  }
+  darts.push_back({1, 25});
+  darts.push_back({2, 25});
+  return darts;
+}
+
+static const uint8_t ORDER[] = {20, 16, 8, 18, 12, 10, 4, 2, 1, 14, 6, 13, 19, 17, 15, 11, 9, 7, 5, 3, 25};
+
+static int rankOf(uint8_t number, uint8_t preferred) {
+  if (number == preferred) {
+    return 0;
+  }
+  for (uint8_t idx = 0; idx < sizeof(ORDER); idx++) {
+    if (ORDER[idx] == number) {
+      return idx + 1;
+    }
+  }
+  return 100;
+}
+
+// Fewest darts of any double-out finish, 0 if there is none within three
+// darts. bestRank is the rank of the most preferred double of those finishes.
+static int bruteForce(int remaining, uint8_t preferred, int& bestRank) {
+  static const std::vector<Dart> darts = allDarts();
+  bestRank = 100;
+  for (int numDarts = 1; numDarts <= 3; numDarts++) {
+    for (const Dart& finish : darts) {
+      if (finish.multiplier != 2) {
+        continue;
+      }
+      int rest = remaining - finish.value();
+      bool found = false;
+      if (numDarts == 1) {
+        found = rest == 0;
+      }
+      for (size_t first = 0; numDarts >= 2 && first < darts.size() && !found; first++) {
+        if (numDarts == 2) {
+          found = darts[first].value() == rest;
+          continue;
+        }
+        for (size_t second = 0; second < darts.size() && !found; second++) {
+          found = darts[first].value() + darts[second].value() == rest;
+        }
+      }
+      if (found) {
+        int rank = rankOf(finish.number, preferred);
+        bestRank = rank < bestRank ? rank : bestRank;
+      }
+    }
+    if (bestRank < 100) {
+      return numDarts;
+    }
+  }
+  return 0;
+}
+
+template<uint8_t Preferred>
+static void checkTable() {
+  typedef CheckoutT<Preferred> Table;
+  for (int remaining = 0; remaining <= 170; remaining++) {
+    int bestRank;
+    int minDarts = bruteForce(remaining, Preferred, bestRank);
+    uint32_t entry = Table::lookup(remaining);
+    CHECK_EQ(Table::getNumDarts(entry), minDarts);
+    if (!entry) {
+      continue;
+    }
+
+    int sum = 0;
+    uint8_t numDarts = Table::getNumDarts(entry);
+    for (uint8_t idx = 0; idx < numDarts; idx++) {
+      uint8_t dart = Table::getDart(entry, idx);
+      uint8_t number = Table::getNumber(dart);
+      uint8_t multiplier = Table::getMultiplier(dart);
+      CHECK((number >= 1 && number <= 20 && multiplier >= 1 && multiplier <= 3) || (number == 25 && multiplier >= 1 && multiplier <= 2));
+      sum += number * multiplier;
+    }
+    CHECK_EQ(sum, remaining);
+
+    uint8_t finish = Table::getDart(entry, numDarts - 1);
+    CHECK_EQ(Table::getMultiplier(finish), 2);
+    CHECK_EQ(rankOf(Table::getNumber(finish), Preferred), bestRank);
+
+    // Fewer darts left than needed means no suggestion
+    for (uint8_t dartsLeft = 0; dartsLeft <= 3; dartsLeft++) {
+      CHECK_EQ(Table::lookup(remaining, dartsLeft), dartsLeft >= minDarts ? entry : 0);
+    }
+  }
+}
+
+static void checkBogeyNumbers() {
+  static const int16_t bogeys[] = {159, 162, 163, 165, 166, 168, 169};
+  for (int16_t remaining : bogeys) {
+    CHECK_EQ(Checkout::lookup(remaining), 0);
+  }
+  CHECK_EQ(Checkout::lookup(0), 0);
+  CHECK_EQ(Checkout::lookup(1), 0);
+  CHECK_EQ(Checkout::lookup(171), 0);
+  CHECK_EQ(Checkout::lookup(-2), 0);
+  CHECK(Checkout::lookup(170) != 0);
+  CHECK(Checkout::lookup(167) != 0);
+  CHECK(Checkout::lookup(164) != 0);
+}
+
+static void checkFormat() {
+  char buffer[16];
+  Checkout::format(Checkout::lookup(170), buffer, sizeof(buffer));
+  CHECK(strcmp(buffer, "T20 T20 BULL") == 0);
+  Checkout::format(Checkout::lookup(40), buffer, sizeof(buffer));
+  CHECK(strcmp(buffer, "D20") == 0);
+  Checkout::format(Checkout::lookup(50), buffer, sizeof(buffer));
+  CHECK(strcmp(buffer, "BULL") == 0);
+  Checkout::format(0, buffer, sizeof(buffer));
+  CHECK(strcmp(buffer, "") == 0);
+
+  // Truncated output stays terminated
+  char small[5];
+  Checkout::format(Checkout::lookup(170), small, sizeof(small));
+  CHECK(strlen(small) == sizeof(small) - 1);
+}
+
+int main() {
+  checkTable<20>();
+  checkTable<16>();
+  checkTable<25>();
+  checkBogeyNumbers();
+  checkFormat();
+  return testResult("checkout");
+}
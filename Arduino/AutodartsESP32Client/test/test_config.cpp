@@ -0,0 +1,243 @@
+// Round trips the config store through a directory on the host and checks
+// what load() recovers after a torn temporary file, a corrupted payload and
+// a file of an older, smaller layout. Also checks which boards and
+// credentials are rejected instead of being truncated.
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <Arduino.h>
+
+#include "AutodartsConfig.h"
+#include "TestUtil.h"
+
+using namespace autodarts;
+
+static const char* PATH = "/autodarts.cfg";
+static const char* TEMP = "/autodarts.cfg.tmp";
+
+// File header as written by Config
+struct Header {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t size;
+  uint32_t crc;
+};
+
+struct TestBoard {
+  String name, id, version, url;
+
+  const String& getName() const { return name; }
+  const String& getId() const { return id; }
+  const String& getVersion() const { return version; }
+  const String& getUrl() const { return url; }
+};
+
+typedef std::vector<std::unique_ptr<TestBoard>> Boards;
+
+static void addBoard(Boards& boards, const std::string& id, const std::string& url) {
+  boards.emplace_back(new TestBoard{String("Board ") + String(id), String(id), String("1.0"), String(url)});
+}
+
+static std::string readFile(fs::FS& fs, const char* path) {
+  fs::File file = fs.open(path, FILE_READ);
+  std::string data(file.size(), '\0');
+  file.read(reinterpret_cast<uint8_t*>(&data[0]), data.size());
+  return data;
+}
+
+static void writeFile(fs::FS& fs, const char* path, const std::string& data) {
+  fs::File file = fs.open(path, FILE_WRITE);
+  file.write(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+}
+
+static Config makeConfig() {
+  Config config(PATH);
+  CHECK(config.setCredentials("player@example.com", "secret"));
+  config.data().reconnectInterval = 2500;
+  config.data().aliveTimeout = 20000;
+  Boards boards;
+  addBoard(boards, "id-1", "192.168.1.10:3180");
+  addBoard(boards, "id-2", "192.168.1.11:3180");
+  CHECK(config.setBoards(boards));
+  return config;
+}
+
+// Loads and reports how long it took, the fake clock does not advance
+static bool load(Config& config, fs::FS& fs) {
+  auto start = std::chrono::steady_clock::now();
+  bool ok = config.load(fs);
+  auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+  printf("load: %s in %lldus\n", ok ? "ok" : "failed", static_cast<long long>(elapsed.count()));
+  return ok;
+}
+
+static void checkRoundTrip(fs::FS& fs) {
+  Config config = makeConfig();
+  CHECK(config.save(fs));
+  CHECK(fs.exists(PATH));
+  CHECK(!fs.exists(TEMP));
+
+  Config loaded(PATH);
+  CHECK(load(loaded, fs));
+  CHECK(strcmp(loaded.data().username, "player@example.com") == 0);
+  CHECK(strcmp(loaded.data().password, "secret") == 0);
+  CHECK_EQ(loaded.data().reconnectInterval, 2500);
+  CHECK_EQ(loaded.data().aliveTimeout, 20000);
+  CHECK_EQ(loaded.data().numBoards, 2);
+  CHECK(strcmp(loaded.data().boards[1].id, "id-2") == 0);
+  CHECK(strcmp(loaded.data().boards[1].url, "192.168.1.11:3180") == 0);
+}
+
+static void checkTornTemp(fs::FS& fs) {
+  Config config = makeConfig();
+  CHECK(config.save(fs));
+  std::string saved = readFile(fs, PATH);
+
+  // Power lost while the temporary file was written: the old file wins
+  config.data().aliveTimeout = 30000;
+  fs.setWriteLimit(sizeof(Header) + 20);
+  CHECK(!config.save(fs));
+  fs.setWriteLimit(SIZE_MAX);
+  CHECK(!fs.exists(TEMP));
+  writeFile(fs, TEMP, saved.substr(0, saved.size() / 2));
+
+  Config loaded(PATH);
+  CHECK(load(loaded, fs));
+  CHECK_EQ(loaded.data().aliveTimeout, 20000);
+
+  // Power lost between removing the old file and renaming the new one
+  fs.remove(TEMP);
+  CHECK(fs.rename(PATH, TEMP));
+  Config recovered(PATH);
+  CHECK(load(recovered, fs));
+  CHECK_EQ(recovered.data().aliveTimeout, 20000);
+
+  // Only a torn temporary file left: nothing is loaded, defaults stay
+  writeFile(fs, TEMP, saved.substr(0, sizeof(Header) + 8));
+  Config empty(PATH);
+  CHECK(!load(empty, fs));
+  CHECK_EQ(empty.data().aliveTimeout, 10000);
+  CHECK_EQ(empty.data().numBoards, 0);
+  fs.remove(TEMP);
+}
+
+static void checkBadCrc(fs::FS& fs) {
+  Config config = makeConfig();
+  CHECK(config.save(fs));
+  std::string saved = readFile(fs, PATH);
+
+  std::string corrupted = saved;
+  corrupted[sizeof(Header) + 3] ^= 0x01;
+  writeFile(fs, PATH, corrupted);
+  uint32_t errors = host::log().count[LOG_LEVEL_ERROR];
+  Config loaded(PATH);
+  CHECK(!load(loaded, fs));
+  CHECK(host::log().count[LOG_LEVEL_ERROR] > errors);
+  CHECK_EQ(loaded.data().numBoards, 0);
+
+  // A header claiming more than the payload holds is rejected as well
+  Header header;
+  memcpy(&header, saved.data(), sizeof(header));
+  header.size = sizeof(Config::Data) + 1;
+  std::string oversized = saved;
+  memcpy(&oversized[0], &header, sizeof(header));
+  writeFile(fs, PATH, oversized);
+  CHECK(!load(loaded, fs));
+
+  // The intact temporary file of an interrupted save takes over
+  writeFile(fs, PATH, corrupted);
+  writeFile(fs, TEMP, saved);
+  CHECK(load(loaded, fs));
+  CHECK_EQ(loaded.data().numBoards, 2);
+  fs.remove(TEMP);
+}
+
+// Writes the leading size bytes of data as a file of an older layout
+static void writeLayout(fs::FS& fs, const Config::Data& data, size_t size) {
+  Header header;
+  header.magic   = Config::MAGIC;
+  header.version = Config::VERSION;
+  header.size    = size;
+  header.crc     = crc32(reinterpret_cast<const uint8_t*>(&data), size);
+  std::string file(reinterpret_cast<const char*>(&header), sizeof(header));
+  file.append(reinterpret_cast<const char*>(&data), size);
+  writeFile(fs, PATH, file);
+}
+
+static void checkOlderLayout(fs::FS& fs) {
+  Config config = makeConfig();
+  Config::Data data = config.data();
+
+  // Fields past the stored size keep their defaults
+  writeLayout(fs, data, offsetof(Config::Data, aliveTimeout));
+  Config loaded(PATH);
+  CHECK(load(loaded, fs));
+  CHECK(strcmp(loaded.data().username, "player@example.com") == 0);
+  CHECK_EQ(loaded.data().reconnectInterval, 2500);
+  CHECK_EQ(loaded.data().aliveTimeout, 10000);
+  CHECK_EQ(loaded.data().numBoards, 0);
+
+  // A layout holding a single board cannot count two
+  writeLayout(fs, data, offsetof(Config::Data, boards) + sizeof(Config::CachedBoard));
+  Config oneBoard(PATH);
+  CHECK(load(oneBoard, fs));
+  CHECK_EQ(oneBoard.data().numBoards, 1);
+  CHECK(strcmp(oneBoard.data().boards[0].id, "id-1") == 0);
+}
+
+static void checkRejected() {
+  Config config(PATH);
+  uint32_t warnings = host::log().count[LOG_LEVEL_WARNING];
+
+  // Boards with an id or url that would be truncated are skipped
+  Boards boards;
+  addBoard(boards, std::string(sizeof(Config::CachedBoard::id), 'x'), "192.168.1.10:3180");
+  addBoard(boards, "id-1", "board-with-a-very-long-host-name.local.example.com:3180");
+  addBoard(boards, std::string(sizeof(Config::CachedBoard::id) - 1, 'y'), std::string(sizeof(Config::CachedBoard::url) - 1, 'z'));
+  CHECK(config.setBoards(boards));
+  CHECK_EQ(config.data().numBoards, 1);
+  CHECK(config.data().boards[0].id[0] == 'y');
+  CHECK_EQ(host::log().count[LOG_LEVEL_WARNING] - warnings, 2);
+
+  // Only MAX_BOARDS are cached, the rest is reported
+  boards.clear();
+  for (int idx = 0; idx < Config::MAX_BOARDS + 2; idx++) {
+    addBoard(boards, "id-" + std::to_string(idx), "192.168.1." + std::to_string(idx) + ":3180");
+  }
+  warnings = host::log().count[LOG_LEVEL_WARNING];
+  CHECK(config.setBoards(boards));
+  CHECK_EQ(config.data().numBoards, Config::MAX_BOARDS);
+  CHECK(strcmp(config.data().boards[Config::MAX_BOARDS - 1].id, "id-7") == 0);
+  CHECK_EQ(host::log().count[LOG_LEVEL_WARNING] - warnings, 1);
+  CHECK(!config.setBoards(boards));
+
+  // Credentials are rejected as a whole
+  CHECK(config.setCredentials("player", "secret"));
+  CHECK(!config.setCredentials("player", std::string(sizeof(Config::Data::password), 'p').c_str()));
+  CHECK(!config.setCredentials(std::string(sizeof(Config::Data::username), 'u').c_str(), "secret"));
+  CHECK(strcmp(config.data().username, "player") == 0);
+  CHECK(strcmp(config.data().password, "secret") == 0);
+}
+
+int main() {
+  char root[] = "/tmp/test_config_XXXXXX";
+  if (!mkdtemp(root)) {
+    return 1;
+  }
+  fs::FS fs(root);
+  checkRoundTrip(fs);
+  checkTornTemp(fs);
+  checkBadCrc(fs);
+  checkOlderLayout(fs);
+  checkRejected();
+  fs.remove(PATH);
+  rmdir(root);
+  return testResult("config");
+}
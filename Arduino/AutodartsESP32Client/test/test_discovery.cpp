@@ -0,0 +1,189 @@
+// Runs Discovery::update() against listeners on the loopback /24. One host
+// answers the upgrade with 101, one with 404, one never answers and one
+// sends its status line in two parts. All other hosts refuse. Then probes
+// again with so few file descriptors left that socket() fails and checks
+// that no host is skipped. The listeners run in a child process, so its
+// descriptors do not count against the limit.
+
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <poll.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <Arduino.h>
+
+#include "AutodartsDiscovery.h"
+#include "TestUtil.h"
+
+using namespace autodarts;
+
+enum class Answer {
+  UPGRADE,
+  NOT_FOUND,
+  SILENT,
+  SPLIT,
+};
+
+struct Listener {
+  uint8_t host;
+  Answer  answer;
+  int     fd;
+};
+
+static int listenOn(uint8_t host, uint16_t& port) {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  int reuse = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+  sockaddr_in address = {};
+  address.sin_family      = AF_INET;
+  address.sin_port        = htons(port);
+  address.sin_addr.s_addr = htonl(0x7f000000 | host);
+  if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 || listen(fd, 16) < 0) {
+    close(fd);
+    return -1;
+  }
+  socklen_t length = sizeof(address);
+  getsockname(fd, reinterpret_cast<sockaddr*>(&address), &length);
+  port = ntohs(address.sin_port);
+  return fd;
+}
+
+static void sendText(int fd, const char* text) {
+  send(fd, text, strlen(text), MSG_NOSIGNAL);
+}
+
+// Answers every connection of the listeners, runs until killed
+static void serve(std::vector<Listener>& listeners) {
+  std::vector<int> silent;
+  for (;;) {
+    std::vector<pollfd> fds;
+    for (const Listener& listener : listeners) {
+      fds.push_back({listener.fd, POLLIN, 0});
+    }
+    poll(fds.data(), fds.size(), -1);
+    for (size_t idx = 0; idx < fds.size(); idx++) {
+      if (!(fds[idx].revents & POLLIN)) {
+        continue;
+      }
+      int client = accept(listeners[idx].fd, nullptr, nullptr);
+      if (client < 0) {
+        continue;
+      }
+      char request[512];
+      recv(client, request, sizeof(request), 0);
+      switch (listeners[idx].answer) {
+        case Answer::UPGRADE:
+          sendText(client, "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\n\r\n");
+          break;
+        case Answer::NOT_FOUND:
+          sendText(client, "HTTP/1.1 404 Not Found\r\n\r\n");
+          break;
+        case Answer::SILENT:
+          silent.push_back(client);
+          continue;
+        case Answer::SPLIT:
+          sendText(client, "HTTP/1.1 1");
+          std::this_thread::sleep_for(std::chrono::milliseconds(50));
+          sendText(client, "01 Switching Protocols\r\n\r\n");
+          break;
+      }
+      close(client);
+    }
+  }
+}
+
+// Updates until done, the fake clock follows real time
+static uint32_t discover(Discovery& discovery, std::vector<uint8_t>& found) {
+  uint32_t start = millis();
+  for (int idx = 0; idx < 5000 && discovery.update(); idx++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    host::advanceMicros(1000);
+  }
+  CHECK(!discovery.isRunning());
+  return millis() - start;
+}
+
+static void checkProbes(uint16_t port) {
+  Discovery discovery;
+  std::vector<uint8_t> found;
+  discovery.onBoardFound([&found, port](const IPAddress& address, uint16_t boardPort) {
+    CHECK_EQ(boardPort, port);
+    found.push_back(address[3]);
+  });
+  CHECK(discovery.begin(IPAddress(127, 0, 0, 1), IPAddress(255, 255, 255, 0), port, 8, 300));
+  uint32_t elapsed = discover(discovery, found);
+
+  // 101 in one part and in two, neither the 404 nor the silent host
+  CHECK_EQ(discovery.getNumFound(), 2);
+  CHECK(found.size() == 2 && found[0] == 2 && found[1] == 5);
+
+  // The silent host held its probe until the timeout
+  CHECK(elapsed >= 300);
+  printf("probed 127.0.0.0/24 in %ums\n", elapsed);
+}
+
+static void checkNoSockets(uint16_t port) {
+  // Leave room for two probe sockets only, the rest fail in socket()
+  int maxFd = 0;
+  for (int fd = 0; fd < 1024; fd++) {
+    if (fcntl(fd, F_GETFD) >= 0) {
+      maxFd = fd;
+    }
+  }
+  rlimit limit;
+  getrlimit(RLIMIT_NOFILE, &limit);
+  rlimit lowered = limit;
+  lowered.rlim_cur = maxFd + 3;
+  CHECK(setrlimit(RLIMIT_NOFILE, &lowered) == 0);
+
+  Discovery discovery;
+  std::vector<uint8_t> found;
+  discovery.onBoardFound([&found](const IPAddress& address, uint16_t) {
+    found.push_back(address[3]);
+  });
+  CHECK(discovery.begin(IPAddress(127, 0, 0, 1), IPAddress(255, 255, 255, 0), port, 8, 300));
+  discover(discovery, found);
+  setrlimit(RLIMIT_NOFILE, &limit);
+
+  // Hosts that found no socket were retried, not skipped
+  CHECK(found.size() == 2 && found[0] == 2 && found[1] == 5);
+}
+
+int main() {
+  uint16_t port = 0;
+  std::vector<Listener> listeners = {
+    {2, Answer::UPGRADE, -1},
+    {3, Answer::NOT_FOUND, -1},
+    {4, Answer::SILENT, -1},
+    {5, Answer::SPLIT, -1},
+  };
+  for (Listener& listener : listeners) {
+    listener.fd = listenOn(listener.host, port);
+    if (listener.fd < 0) {
+      printf("discovery: could not listen on 127.0.0.%u\n", listener.host);
+      return 1;
+    }
+  }
+
+  pid_t server = fork();
+  if (server == 0) {
+    serve(listeners);
+    _exit(0);
+  }
+  for (const Listener& listener : listeners) {
+    close(listener.fd);
+  }
+
+  checkProbes(port);
+  checkNoSockets(port);
+
+  kill(server, SIGKILL);
+  waitpid(server, nullptr, 0);
+  return testResult("discovery");
+}
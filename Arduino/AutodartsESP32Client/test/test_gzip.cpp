@@ -0,0 +1,173 @@
+// Inflates gzip bodies built with zlib through GzipStream and checks that
+// a corrupted or truncated trailer and data fail the body, as does a
+// window that cannot be allocated. Then refreshes boards through the
+// client, gzip encoded and conditional, and checks that only a complete
+// listing keeps its validators for the 304 path.
+
+#include <stdio.h>
+#include <new>
+#include <string>
+#include <zlib.h>
+
+#include <Arduino.h>
+
+#include "AutodartsClient.h"
+#include "TestUtil.h"
+
+using namespace autodarts;
+
+static const char* BOARDS =
+  "[{\"id\":\"id-1\",\"name\":\"Board 1\",\"ip\":\"192.168.1.10:3180\",\"version\":\"1.0\",\"owner\":\"someone\"},"
+  "{\"id\":\"id-2\",\"name\":\"Board 2\",\"ip\":\"192.168.1.11:3180\",\"version\":\"1.0\",\"owner\":\"someone\"}]";
+
+// Large nothrow allocations fail while set, as on a fragmented heap
+static bool failLargeAllocations = false;
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+  if (failLargeAllocations && size >= TINFL_LZ_DICT_SIZE) {
+    return nullptr;
+  }
+  return malloc(size);
+}
+
+static std::string gzip(const std::string& data) {
+  z_stream stream = z_stream();
+  deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY);
+  std::string compressed(deflateBound(&stream, data.size()), '\0');
+  stream.next_in   = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+  stream.avail_in  = data.size();
+  stream.next_out  = reinterpret_cast<Bytef*>(&compressed[0]);
+  stream.avail_out = compressed.size();
+  deflate(&stream, Z_FINISH);
+  compressed.resize(stream.total_out);
+  deflateEnd(&stream);
+  return compressed;
+}
+
+// Reads the whole body, then verifies it like the client does
+static bool inflate(const std::string& body, std::string& data) {
+  host::MemoryStream source(body);
+  GzipStream stream(source);
+  data.clear();
+  int c;
+  while ((c = stream.read()) >= 0) {
+    data += static_cast<char>(c);
+  }
+  return stream.finish();
+}
+
+static void checkInflate() {
+  // Larger than the window, so it wraps
+  std::string data;
+  for (int idx = 0; data.size() < 3 * TINFL_LZ_DICT_SIZE; idx++) {
+    data += "{\"seq\":" + std::to_string(idx * 7919 % 100003) + "},";
+  }
+  std::string body = gzip(data);
+  std::string inflated;
+  CHECK(inflate(body, inflated));
+  CHECK(inflated == data);
+
+  // finish() checks the trailer of a body the consumer stopped reading
+  host::MemoryStream source(body);
+  GzipStream stream(source);
+  CHECK(stream.find("},"));
+  CHECK(stream.finish());
+  CHECK_EQ(stream.getDecompressedBytes(), data.size());
+  CHECK_EQ(stream.getCompressedBytes(), body.size());
+}
+
+static void checkCorrupted() {
+  std::string data = BOARDS;
+  std::string body = gzip(data);
+  std::string inflated;
+  uint32_t errors = host::log().count[LOG_LEVEL_ERROR];
+
+  // CRC of the trailer
+  std::string crc = body;
+  crc[crc.size() - 8] ^= 0x01;
+  CHECK(!inflate(crc, inflated));
+  CHECK(inflated == data);
+  CHECK(strstr(host::log().last, "trailer mismatch") != nullptr);
+
+  // Size of the trailer
+  std::string size = body;
+  size[size.size() - 1] ^= 0x01;
+  CHECK(!inflate(size, inflated));
+
+  // Truncated trailer
+  CHECK(!inflate(body.substr(0, body.size() - 3), inflated));
+  CHECK(strstr(host::log().last, "Truncated gzip trailer") != nullptr);
+
+  // Truncated data
+  CHECK(!inflate(body.substr(0, body.size() / 2), inflated));
+
+  // Not gzip at all
+  CHECK(!inflate(data, inflated));
+  CHECK(inflated.empty());
+  CHECK_EQ(host::log().count[LOG_LEVEL_ERROR] - errors, 5);
+}
+
+static void checkAllocationFailure() {
+  host::MemoryStream source(gzip(BOARDS));
+  failLargeAllocations = true;
+  GzipStream stream(source);
+  failLargeAllocations = false;
+  CHECK(stream.hasError());
+  CHECK_EQ(stream.available(), 0);
+  CHECK_EQ(stream.read(), -1);
+  CHECK(!stream.finish());
+}
+
+static void serveBoards(int code, const std::string& body, const char* etag) {
+  host::http::Response response;
+  response.code = code;
+  response.body = body;
+  response.headers["Content-Encoding"] = "gzip";
+  response.headers["ETag"] = etag;
+  host::http::serve(AUTODARTS_API_BOARDS_URL, response);
+}
+
+static std::string lastIfNoneMatch() {
+  return host::http::server().requests.back().headers["If-None-Match"];
+}
+
+static void checkConditionalRefresh() {
+  host::http::Response token;
+  token.body = "{\"access_token\":\"token\",\"expires_in\":300}";
+  host::http::serve(AUTODARTS_AUTH_KEYCLOAK_URL, token);
+
+  // A corrupted listing fails and its validators are not kept
+  Client client;
+  std::string body = gzip(BOARDS);
+  std::string corrupted = body;
+  corrupted[corrupted.size() - 8] ^= 0x01;
+  serveBoards(HTTP_CODE_OK, corrupted, "\"v1\"");
+  CHECK_EQ(client.autoDetectBoards("player", "secret"), HTTP_CODE_INTERNAL_SERVER_ERROR);
+  CHECK(lastIfNoneMatch().empty());
+
+  // A complete listing keeps them
+  serveBoards(HTTP_CODE_OK, body, "\"v1\"");
+  CHECK_EQ(client.autoDetectBoards("player", "secret"), HTTP_CODE_OK);
+  CHECK(lastIfNoneMatch().empty());
+  CHECK_EQ(client.getNumBoards(), 2);
+
+  // Unchanged boards answer 304 without a body
+  serveBoards(HTTP_CODE_NOT_MODIFIED, "", "\"v1\"");
+  CHECK_EQ(client.autoDetectBoards("player", "secret"), HTTP_CODE_NOT_MODIFIED);
+  CHECK(lastIfNoneMatch() == "\"v1\"");
+  CHECK_EQ(client.getNumBoards(), 2);
+
+  // Forcing an update drops the validators
+  serveBoards(HTTP_CODE_OK, body, "\"v2\"");
+  CHECK_EQ(client.autoDetectBoards("player", "secret", true), HTTP_CODE_OK);
+  CHECK(lastIfNoneMatch().empty());
+  CHECK_EQ(client.getNumBoards(), 2);
+}
+
+int main() {
+  checkInflate();
+  checkCorrupted();
+  checkAllocationFailure();
+  checkConditionalRefresh();
+  return testResult("gzip");
+}
@@ -0,0 +1,123 @@
+// Hooks malloc and checks that a warmed up board receives and dispatches
+// without touching the heap: message callback, capture, queue push, parse
+// and the detector callbacks. Built with AUTODARTS_HEAP_AUDIT, so the
+// board's own audit is checked against the hook as well.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+
+#include "HeapHook.h"
+
+#include <Arduino.h>
+
+#include "AutodartsBoard.h"
+#include "TestUtil.h"
+
+using namespace autodarts;
+
+// Messages as received, with room for the terminator the transport adds
+static std::vector<std::vector<char>> makeMessages() {
+  std::vector<std::string> messages = {
+    "{\"type\":\"state\",\"data\":{\"connected\":true,\"running\":true,\"status\":\"Throw\",\"event\":\"Throw detected\",\"numThrows\":1,"
+      "\"throws\":[{\"segment\":{\"number\":20,\"multiplier\":3},\"coords\":{\"x\":0.01,\"y\":-0.6}}]}}",
+    "{\"type\":\"stats\",\"data\":{\"fps\":30,\"resolution\":{\"width\":1280,\"height\":720}}}",
+    "{\"type\":\"cam_stats\",\"data\":{\"id\":1,\"fps\":30,\"resolution\":{\"width\":1280,\"height\":720}}}",
+    "{\"type\":\"state\",\"data\":{\"connected\":true,\"running\":true,\"status\":\"Takeout\",\"event\":\"Takeout started\",\"numThrows\":0}}",
+  };
+  std::vector<std::vector<char>> buffers;
+  for (const std::string& message : messages) {
+    buffers.emplace_back(message.begin(), message.end());
+    buffers.back().push_back('\0');
+  }
+  return buffers;
+}
+
+static void receiveAll(Board& board, std::vector<std::vector<char>>& messages) {
+  for (std::vector<char>& message : messages) {
+    board.receive(message.data(), message.size() - 1);
+  }
+  board.dispatch();
+}
+
+static void setCallbacks(Board& board, uint32_t& numCallbacks) {
+  board.onBoardMessage([&numCallbacks](const String&, const String&, const char*, size_t) { numCallbacks++; });
+  board.onDetectionState([&numCallbacks](const String&, const String&, State, State, int16_t) { numCallbacks++; });
+  board.onDetectionEvent([&numCallbacks](const String&, const String&, Status::Code, Event::Code) { numCallbacks++; });
+  board.onDetectionStats([&numCallbacks](const String&, const String&, int8_t, int16_t, int16_t) { numCallbacks++; });
+  board.onCameraStats([&numCallbacks](const String&, const String&, int8_t, int8_t, int16_t, int16_t) { numCallbacks++; });
+  board.onThrow([&numCallbacks](const String&, const String&, const Throw&, int16_t) { numCallbacks++; });
+}
+
+static void checkSteadyState(fs::FS& fs) {
+  Board board("Board", "board-id", "1.0", "127.0.0.1:3180");
+  uint32_t numCallbacks = 0;
+  setCallbacks(board, numCallbacks);
+  CHECK(board.startCapture(fs, "/heap.adc"));
+  std::vector<std::vector<char>> messages = makeMessages();
+
+  // Warming up may allocate: queue slots grow to the largest message they
+  // see, which takes a full turn of the state ring, and the capture gets
+  // its stdio buffer
+  for (int round = 0; round < AUTODARTS_STATE_QUEUE_SIZE; round++) {
+    receiveAll(board, messages);
+  }
+  uint32_t warmup = board.getNumHeapAllocations();
+
+  uint32_t allocations = host::heapHook().allocations;
+  uint32_t callbacks = numCallbacks;
+  for (int round = 0; round < 1000; round++) {
+    receiveAll(board, messages);
+  }
+  CHECK_EQ(host::heapHook().allocations - allocations, 0);
+  CHECK_EQ(board.getNumHeapAllocations() - warmup, 0);
+  CHECK(numCallbacks - callbacks >= 1000 * messages.size());
+  board.stopCapture();
+  fs.remove("/heap.adc");
+}
+
+// A callback that allocates is caught by the hook and by the board's audit,
+// also when it runs from the overflow dispatch nested in receive()
+static void checkAllocatingCallback() {
+  Board board("Board", "board-id", "1.0", "127.0.0.1:3180");
+  std::vector<std::vector<char>> messages = makeMessages();
+  for (int round = 0; round < AUTODARTS_STATE_QUEUE_SIZE; round++) {
+    receiveAll(board, messages);
+  }
+
+  std::vector<std::string> events;
+  events.reserve(1);
+  board.onDetectionState([&events](const String&, const String&, State, State, int16_t numThrows) {
+    events.push_back(std::string(64, 'x'));
+  });
+  uint32_t audited = board.getNumHeapAllocations();
+  uint32_t allocations = host::heapHook().allocations;
+  board.receive(messages[0].data(), messages[0].size() - 1);
+  board.dispatch();
+  CHECK(host::heapHook().allocations - allocations > 0);
+  CHECK_EQ(board.getNumHeapAllocations() - audited, 1);
+
+  // Overflow: the receive audit counts the nested dispatch once
+  for (int idx = 0; idx < AUTODARTS_STATE_QUEUE_SIZE; idx++) {
+    board.receive(messages[3].data(), messages[3].size() - 1);
+  }
+  audited = board.getNumHeapAllocations();
+  board.receive(messages[3].data(), messages[3].size() - 1);
+  CHECK_EQ(board.getNumOverflows(), 1);
+  CHECK_EQ(board.getNumHeapAllocations() - audited, 1);
+  board.dispatch();
+}
+
+int main() {
+  char root[] = "/tmp/test_heap_XXXXXX";
+  if (!mkdtemp(root)) {
+    return 1;
+  }
+  fs::FS fs(root);
+  checkSteadyState(fs);
+  checkAllocatingCallback();
+  rmdir(root);
+  return testResult("heap");
+}
@@ -0,0 +1,152 @@
+// Round trips records through the journal format, including deltas whose
+// varint bytes look like batch markers, and checks that the decoder
+// resyncs after corrupted and torn batches.
+
+#include <string.h>
+#include <vector>
+
+#include "AutodartsJournalFormat.h"
+#include "TestUtil.h"
+
+using namespace autodarts;
+
+typedef journal::BatchT<256> Batch;
+
+struct Segment {
+  std::vector<uint8_t> data;
+
+  void add(Batch& batch) {
+    const uint8_t* bytes = batch.finish();
+    data.insert(data.end(), bytes, bytes + batch.getSize());
+    batch.reset();
+  }
+};
+
+static std::vector<journal::Record> decodeAll(const std::vector<uint8_t>& data, journal::DecodeStats& stats) {
+  std::vector<journal::Record> records;
+  stats = journal::decode(data.data(), data.size(), [&records](const journal::Record& record) {
+    records.push_back(record);
+  });
+  return records;
+}
+
+static bool equal(const journal::Record& a, const journal::Record& b) {
+  return a.millis == b.millis && a.handle == b.handle && a.code == b.code;
+}
+
+static std::vector<journal::Record> makeRecords() {
+  // 255ms encodes as 0xFF 0x01, the old format read 0xFF as a batch start
+  static const uint32_t deltas[] = {0, 1, 127, 128, 255, 0xFF7F, 16383, 16384, 2097151, 1u << 28, 0xFFFFFFFFu, 3, 4095};
+  std::vector<journal::Record> records;
+  uint32_t millis = 0xFFFFFF00u; // wraps around
+  uint8_t idx = 0;
+  for (int round = 0; round < 20; round++) {
+    for (uint32_t delta : deltas) {
+      millis += delta;
+      records.push_back({millis, static_cast<uint8_t>(idx % 7), static_cast<uint8_t>(idx % 2 ? 0xFF : 0xA5)});
+      idx++;
+    }
+  }
+  return records;
+}
+
+static void encode(const std::vector<journal::Record>& records, Segment& segment, std::vector<size_t>& batchStarts) {
+  Batch batch;
+  for (const journal::Record& record : records) {
+    if (!batch.append(record.millis, record.handle, record.code)) {
+      batchStarts.push_back(segment.data.size());
+      segment.add(batch);
+      CHECK(batch.append(record.millis, record.handle, record.code));
+    }
+  }
+  batchStarts.push_back(segment.data.size());
+  segment.add(batch);
+}
+
+static void checkRoundTrip() {
+  std::vector<journal::Record> records = makeRecords();
+  Segment segment;
+  std::vector<size_t> batchStarts;
+  encode(records, segment, batchStarts);
+  CHECK(batchStarts.size() > 3);
+
+  journal::DecodeStats stats;
+  std::vector<journal::Record> decoded = decodeAll(segment.data, stats);
+  CHECK_EQ(stats.batches, batchStarts.size());
+  CHECK_EQ(stats.records, records.size());
+  CHECK_EQ(stats.skippedBytes, 0);
+  CHECK_EQ(decoded.size(), records.size());
+  for (size_t idx = 0; idx < decoded.size() && idx < records.size(); idx++) {
+    CHECK(equal(decoded[idx], records[idx]));
+  }
+}
+
+static void checkCorruption() {
+  std::vector<journal::Record> records = makeRecords();
+  Segment segment;
+  std::vector<size_t> batchStarts;
+  encode(records, segment, batchStarts);
+
+  // Flip a record byte of the second batch, only that batch is lost
+  std::vector<uint8_t> corrupted = segment.data;
+  corrupted[batchStarts[1] + journal::BATCH_HEADER_SIZE + 3] ^= 0x10;
+  journal::DecodeStats stats;
+  std::vector<journal::Record> decoded = decodeAll(corrupted, stats);
+  CHECK_EQ(stats.batches, batchStarts.size() - 1);
+  CHECK(decoded.size() < records.size());
+  CHECK(equal(decoded.back(), records.back()));
+  CHECK(equal(decoded.front(), records.front()));
+
+  // A torn write at the end keeps all complete batches
+  std::vector<uint8_t> torn(segment.data.begin(), segment.data.begin() + batchStarts.back() + 20);
+  decoded = decodeAll(torn, stats);
+  CHECK_EQ(stats.batches, batchStarts.size() - 1);
+  CHECK_EQ(stats.skippedBytes, 20);
+
+  // Garbage in front of a batch is skipped
+  std::vector<uint8_t> garbage = {journal::BATCH_MARKER, 0x05, 0x00, 0x01, 0x00, 0xFF, 0xFF};
+  garbage.insert(garbage.end(), segment.data.begin(), segment.data.end());
+  decoded = decodeAll(garbage, stats);
+  CHECK_EQ(stats.records, records.size());
+  CHECK_EQ(stats.skippedBytes, 7);
+}
+
+static void checkBatchLimits() {
+  journal::BatchT<journal::BATCH_HEADER_SIZE + 3 * journal::MAX_RECORD_SIZE> batch;
+  CHECK(batch.isEmpty());
+  CHECK(batch.append(0, 1, 2));
+  CHECK(batch.append(0xFFFFFFFFu, 1, 2));
+  CHECK(batch.append(5, 1, 2));
+  // Three small records leave room for a fourth only if it fits worst case
+  CHECK_EQ(batch.getCount(), 3);
+  uint16_t size = batch.getSize();
+  bool appended = batch.append(6, 1, 2);
+  CHECK(appended == (size + journal::MAX_RECORD_SIZE <= journal::BATCH_HEADER_SIZE + 3 * journal::MAX_RECORD_SIZE));
+  batch.reset();
+  CHECK(batch.isEmpty());
+  CHECK_EQ(batch.getSize(), journal::BATCH_HEADER_SIZE);
+}
+
+static void checkSegmentHeader() {
+  uint8_t header[journal::SEGMENT_HEADER_SIZE];
+  journal::writeSegmentHeader(header, 0x12345678);
+  uint32_t sequence = 0;
+  CHECK(journal::readSegmentHeader(header, sizeof(header), sequence));
+  CHECK_EQ(sequence, 0x12345678);
+  CHECK(!journal::readSegmentHeader(header, sizeof(header) - 1, sequence));
+  header[0] ^= 1;
+  CHECK(!journal::readSegmentHeader(header, sizeof(header), sequence));
+
+  CHECK(journal::isNewer(2, 1));
+  CHECK(!journal::isNewer(1, 2));
+  CHECK(!journal::isNewer(7, 7));
+  CHECK(journal::isNewer(0, 0xFFFFFFFFu));
+}
+
+int main() {
+  checkRoundTrip();
+  checkCorruption();
+  checkBatchLimits();
+  checkSegmentHeader();
+  return testResult("journal");
+}
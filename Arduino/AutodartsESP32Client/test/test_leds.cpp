@@ -0,0 +1,174 @@
+// Runs the LED engine against a GPIO stand-in on a fake clock: effect
+// levels, per-board event mapping and frame jitter under a simulated
+// websocket load.
+
+#include <algorithm>
+#include <random>
+#include <stdio.h>
+#include <vector>
+
+#include "AutodartsLeds.h"
+#include "TestUtil.h"
+
+using namespace autodarts;
+
+// GPIO stand-in, records every level written with the time it was written
+struct Write {
+  uint32_t micros;
+  uint8_t  channel;
+  uint8_t  level;
+};
+static std::vector<Write> writes;
+static uint8_t levels[4];
+
+static void writePin(uint8_t channel, uint8_t level) {
+  writes.push_back({micros(), channel, level});
+  levels[channel] = level;
+}
+
+typedef LedEngineT<4, 2> Leds;
+
+// Steps the clock in 1ms increments and renders
+static void run(Leds& leds, uint32_t durationMs) {
+  for (uint32_t ms = 0; ms < durationMs; ms++) {
+    host::advanceMicros(1000);
+    leds.update();
+  }
+}
+
+static void checkEffects() {
+  Leds leds(writePin);
+  leds.begin();
+  CHECK_EQ(writes.size(), 4);
+  for (uint8_t channel = 0; channel < 4; channel++) {
+    CHECK_EQ(levels[channel], 0);
+  }
+
+  leds.play(0, Effect::ON);
+  leds.play(1, Effect::FLASH, 200);
+  leds.play(2, Effect::BLINK, 200, true);
+  run(leds, 30);
+  CHECK_EQ(levels[0], 255);
+  CHECK(levels[1] > 0 && levels[1] < 255);
+  CHECK_EQ(levels[2], 255);
+
+  // Flash decays monotonically and ends dark
+  uint8_t previous = levels[1];
+  bool monotonic = true;
+  for (int step = 0; step < 20; step++) {
+    run(leds, 10);
+    monotonic = monotonic && levels[1] <= previous;
+    previous = levels[1];
+  }
+  CHECK(monotonic);
+  CHECK_EQ(levels[1], 0);
+
+  // Blink repeats every 200ms, half on and half off
+  uint32_t on = 0, off = 0;
+  for (int step = 0; step < 1000; step++) {
+    run(leds, 1);
+    levels[2] ? on++ : off++;
+  }
+  CHECK(on > 400 && on < 600);
+  CHECK(off > 400 && off < 600);
+  CHECK_EQ(leds.getLevel(0), 255);
+  CHECK_EQ(leds.getLevel(9), 0);
+}
+
+static void checkEventsPerBoard() {
+  Leds leds(writePin);
+  leds.begin();
+  leds.mapEvent(Event::Code::THROW_DETECTED, 3, Effect::FLASH, 100);
+  run(leds, 20);
+
+  // Board A throws, its repeated state must not restart the flash
+  leds.onEvent("board-a", Event::Code::THROW_DETECTED);
+  run(leds, 40);
+  uint8_t fading = levels[3];
+  CHECK(fading > 0 && fading < 255);
+  leds.onEvent("board-a", Event::Code::THROW_DETECTED);
+  run(leds, 20);
+  CHECK(levels[3] < fading);
+
+  // Another board in a different state does not reset board A
+  leds.onEvent("board-b", Event::Code::STARTED);
+  leds.onEvent("board-a", Event::Code::THROW_DETECTED);
+  run(leds, 1);
+  CHECK(levels[3] < fading);
+
+  // Board B's first throw starts the flash on its own
+  run(leds, 100);
+  CHECK_EQ(levels[3], 0);
+  leds.onEvent("board-b", Event::Code::THROW_DETECTED);
+  run(leds, 20);
+  CHECK(levels[3] > 0);
+
+  // A third board evicts the least recently seen one
+  run(leds, 100);
+  leds.onEvent("board-c", Event::Code::THROW_DETECTED);
+  leds.onEvent("board-b", Event::Code::THROW_DETECTED);
+  run(leds, 100);
+  leds.onEvent("board-a", Event::Code::THROW_DETECTED);
+  run(leds, 20);
+  CHECK(levels[3] > 0);
+}
+
+struct Jitter {
+  uint32_t p50, p99, max;
+  uint32_t frames, missed, slots;
+};
+
+// The loop services websockets for a random time before each update(), with
+// occasional long stalls as caused by a TLS handshake or a large message
+static Jitter measureJitter(uint32_t maxBusyMicros, uint32_t stallMicros, uint32_t seed) {
+  std::mt19937 random(seed);
+  std::uniform_int_distribution<uint32_t> busy(50, maxBusyMicros);
+  std::uniform_int_distribution<uint32_t> percent(0, 99);
+
+  Leds leds(writePin);
+  leds.begin();
+  uint32_t start = micros();
+  const uint32_t period = 20000;
+  std::vector<uint32_t> lateness;
+  for (int loop = 0; loop < 50000; loop++) {
+    host::advanceMicros(percent(random) < 1 ? stallMicros : busy(random));
+    uint32_t now = micros();
+    if (leds.update()) {
+      lateness.push_back((now - start) % period);
+    }
+  }
+  uint32_t slots = (micros() - start) / period;
+  std::sort(lateness.begin(), lateness.end());
+  Jitter jitter;
+  jitter.p50    = lateness[lateness.size() / 2];
+  jitter.p99    = lateness[lateness.size() * 99 / 100];
+  jitter.max    = leds.getStats().maxJitterMicros;
+  jitter.frames = leds.getStats().frames;
+  jitter.missed = leds.getStats().missedFrames;
+  jitter.slots  = slots;
+  CHECK_EQ(jitter.frames, lateness.size());
+  // Every frame slot is either rendered or counted as missed
+  CHECK(jitter.frames + jitter.missed >= slots && jitter.frames + jitter.missed <= slots + 1);
+  return jitter;
+}
+
+static void checkJitter() {
+  Jitter idle = measureJitter(1000, 1000, 1);
+  Jitter busy = measureJitter(8000, 45000, 2);
+  printf("idle loop:  p50 %uus p99 %uus max %uus, %u frames %u missed\n", idle.p50, idle.p99, idle.max, idle.frames, idle.missed);
+  printf("ws load:    p50 %uus p99 %uus max %uus, %u frames %u missed\n", busy.p50, busy.p99, busy.max, busy.frames, busy.missed);
+
+  // Frames are late by at most one loop iteration, never early
+  CHECK(idle.max <= 1000);
+  CHECK_EQ(idle.missed, 0);
+  CHECK(busy.max <= 45000);
+  CHECK(busy.p50 <= 8000);
+  CHECK(busy.missed > 0);
+}
+
+int main() {
+  checkEffects();
+  checkEventsPerBoard();
+  checkJitter();
+  return testResult("leds");
+}
@@ -0,0 +1,222 @@
+// Plays X01 legs through Match::applyThrow and checks busts, the out modes
+// and the turn and leg order. Also fetches matches through the client from
+// a scripted matches URL and checks that tracked matches stay put while
+// more boards are tracked.
+
+#include <stdio.h>
+#include <string>
+
+#include <Arduino.h>
+
+#include "AutodartsClient.h"
+#include "TestUtil.h"
+
+using namespace autodarts;
+
+static const char* MATCHES_URL = "http://127.0.0.1:8080/gs/v0/matches";
+
+static Throw dart(int8_t number, int8_t multiplier) {
+  Throw dart;
+  dart.number = number;
+  dart.multiplier = multiplier;
+  return dart;
+}
+
+static std::string matchJson(const char* id, const char* boardId, const char* scores, int player, const char* outMode = "Double") {
+  return std::string("{\"id\":\"") + id + "\",\"settings\":{\"baseScore\":501,\"outMode\":\"" + outMode + "\"},"
+         "\"players\":[{\"name\":\"Alice\",\"boardId\":\"" + boardId + "\"},{\"name\":\"Bob\",\"boardId\":\"" + boardId + "\"}],"
+         "\"gameScores\":" + scores + ",\"scores\":[{\"legs\":1},{\"legs\":0}],\"player\":" + std::to_string(player) + ",\"finished\":false}";
+}
+
+static Match makeMatch(const char* scores, int player, const char* outMode = "Double") {
+  DynamicJsonDocument doc(1024);
+  std::string json = matchJson("match-1", "board-1", scores, player, outMode);
+  CHECK(!deserializeJson(doc, json.c_str()));
+  Match match("board-1");
+  match.fromJson(doc.as<JsonObjectConst>());
+  return match;
+}
+
+static void checkFromJson() {
+  Match match = makeMatch("[170,32]", 1);
+  CHECK(match.isActive());
+  CHECK(match.getId() == "match-1");
+  CHECK_EQ(match.getNumPlayers(), 2);
+  CHECK(match.getPlayer(0).name == "Alice");
+  CHECK_EQ(match.getPlayer(0).remaining, 170);
+  CHECK_EQ(match.getPlayer(0).legs, 1);
+  CHECK_EQ(match.getCurrentPlayer(), 1);
+  CHECK_EQ(match.getRemaining(), 32);
+  CHECK(match.getOutMode() == Match::OutMode::DOUBLE);
+  CHECK(match.getCheckout() != 0);
+
+  // A current player past the players leaves the match inactive
+  Match stale = makeMatch("[170,32]", 2);
+  CHECK(!stale.isActive());
+  CHECK_EQ(stale.getRemaining(), 0);
+
+  CHECK(makeMatch("[170,32]", 0, "Straight").getOutMode() == Match::OutMode::STRAIGHT);
+  CHECK(makeMatch("[170,32]", 0, "Master").getOutMode() == Match::OutMode::MASTER);
+  CHECK_EQ(makeMatch("[170,32]", 0, "Straight").getCheckout(), 0);
+}
+
+static void checkTurns() {
+  Match match = makeMatch("[501,501]", 0);
+  match.applyThrow(dart(20, 3));
+  match.applyThrow(dart(20, 3));
+  CHECK_EQ(match.getDartsThrown(), 2);
+  CHECK_EQ(match.getRemaining(), 381);
+  match.applyThrow(dart(0, 0));
+  CHECK_EQ(match.getPlayer(0).remaining, 381);
+
+  // Three darts pass the turn on
+  CHECK_EQ(match.getCurrentPlayer(), 1);
+  CHECK_EQ(match.getDartsThrown(), 0);
+  CHECK_EQ(match.getRemaining(), 501);
+  match.applyThrow(dart(19, 3));
+  match.applyThrow(dart(19, 1));
+  match.applyThrow(dart(25, 2));
+  CHECK_EQ(match.getCurrentPlayer(), 0);
+  CHECK_EQ(match.getPlayer(1).remaining, 501 - 57 - 19 - 50);
+}
+
+static void checkBusts() {
+  // Below zero: the turn is reset and passed on
+  Match match = makeMatch("[40,501]", 0);
+  match.applyThrow(dart(10, 1));
+  CHECK_EQ(match.getRemaining(), 30);
+  match.applyThrow(dart(20, 2));
+  CHECK_EQ(match.getPlayer(0).remaining, 40);
+  CHECK_EQ(match.getCurrentPlayer(), 1);
+
+  // Zero without a double
+  match = makeMatch("[40,501]", 0);
+  match.applyThrow(dart(20, 1));
+  match.applyThrow(dart(20, 1));
+  CHECK_EQ(match.getPlayer(0).remaining, 40);
+  CHECK_EQ(match.getCurrentPlayer(), 1);
+
+  // One left cannot be finished on a double
+  match = makeMatch("[40,501]", 0);
+  match.applyThrow(dart(13, 3));
+  CHECK_EQ(match.getPlayer(0).remaining, 40);
+  CHECK_EQ(match.getCurrentPlayer(), 1);
+
+  // Straight out may leave one and finish on a single
+  match = makeMatch("[40,501]", 0, "Straight");
+  match.applyThrow(dart(13, 3));
+  CHECK_EQ(match.getRemaining(), 1);
+  match.applyThrow(dart(1, 1));
+  CHECK_EQ(match.getPlayer(0).legs, 2);
+
+  // Master out finishes on a treble
+  match = makeMatch("[60,501]", 0, "Master");
+  match.applyThrow(dart(20, 3));
+  CHECK_EQ(match.getPlayer(0).legs, 2);
+}
+
+static void checkLegs() {
+  Match match = makeMatch("[501,40]", 1);
+  match.applyThrow(dart(20, 2));
+  CHECK_EQ(match.getPlayer(1).legs, 1);
+
+  // Scores reset and the next player starts the new leg
+  CHECK_EQ(match.getPlayer(0).remaining, 501);
+  CHECK_EQ(match.getPlayer(1).remaining, 501);
+  CHECK_EQ(match.getCurrentPlayer(), 0);
+  CHECK_EQ(match.getDartsThrown(), 0);
+
+  // The starter rotates from leg to leg, not with the winner
+  match.applyThrow(dart(0, 0));
+  match.applyThrow(dart(0, 0));
+  match.applyThrow(dart(0, 0));
+  CHECK_EQ(match.getCurrentPlayer(), 1);
+  for (int idx = 0; idx < 3; idx++) {
+    match.applyThrow(dart(20, 3));
+  }
+  for (int idx = 0; idx < 3; idx++) {
+    match.applyThrow(dart(0, 0));
+  }
+  CHECK_EQ(match.getCurrentPlayer(), 1);
+  CHECK_EQ(match.getPlayer(1).remaining, 501 - 180);
+  match.applyThrow(dart(20, 3));
+  match.applyThrow(dart(20, 3));
+  match.applyThrow(dart(20, 3));
+  for (int idx = 0; idx < 3; idx++) {
+    match.applyThrow(dart(0, 0));
+  }
+  match.applyThrow(dart(20, 3));
+  match.applyThrow(dart(19, 3));
+  CHECK_EQ(match.getRemaining(), 24);
+  CHECK(match.getCheckout() != 0);
+  match.applyThrow(dart(12, 2));
+  CHECK_EQ(match.getPlayer(1).legs, 2);
+  CHECK_EQ(match.getCurrentPlayer(), 1);
+}
+
+static void serveMatches(const std::string& matches) {
+  host::http::Response response;
+  response.body = "[" + matches + "]";
+  host::http::serve(MATCHES_URL, response);
+}
+
+static void checkRequestMatch() {
+  Client client;
+  Client::Token token("token", millis() + 60000);
+  serveMatches(matchJson("other", "board-2", "[501,501]", 0) + "," + matchJson("match-1", "board-1", "[170,32]", 1));
+
+  Match match("board-1");
+  CHECK_EQ(client.requestMatch(match, token, MATCHES_URL), HTTP_CODE_OK);
+  CHECK(host::http::server().requests.back().url == MATCHES_URL);
+  CHECK(host::http::server().requests.back().headers["Authorization"] == "Bearer token");
+  CHECK(match.getId() == "match-1");
+  CHECK_EQ(match.getRemaining(), 32);
+
+  Match missing("board-3");
+  CHECK_EQ(client.requestMatch(missing, token, MATCHES_URL), HTTP_CODE_NOT_FOUND);
+  CHECK(!missing.isActive());
+}
+
+static void checkTrackedMatchesStay() {
+  host::http::Response token;
+  token.body = "{\"access_token\":\"token\",\"expires_in\":300}";
+  host::http::serve(AUTODARTS_AUTH_KEYCLOAK_URL, token);
+  host::http::Response boards;
+  boards.code = HTTP_CODE_NOT_MODIFIED;
+  host::http::serve(AUTODARTS_API_BOARDS_URL, boards);
+
+  Client client;
+  std::string matches;
+  for (int idx = 0; idx < 8; idx++) {
+    std::string id = "board-" + std::to_string(idx);
+    CHECK(client.addBoard(String("Board"), String(id), String("1.0"), String("127.0.0.1:" + std::to_string(3180 + idx))));
+    matches += (idx ? "," : "") + matchJson(("match-" + id).c_str(), id.c_str(), "[501,501]", 0);
+  }
+  serveMatches(matches);
+  CHECK_EQ(client.autoDetectBoards("player", "secret"), HTTP_CODE_NOT_MODIFIED);
+
+  CHECK_EQ(client.trackMatch(0, MATCHES_URL), HTTP_CODE_OK);
+  const Match* first = client.getMatch(0);
+  CHECK(first != nullptr);
+  for (uint8_t idx = 1; idx < 8; idx++) {
+    CHECK_EQ(client.trackMatch(idx, MATCHES_URL), HTTP_CODE_OK);
+  }
+  CHECK(client.getMatch(0) == first);
+  CHECK(first->getId() == "match-board-0");
+  CHECK(client.getMatch(7)->getId() == "match-board-7");
+
+  // Untracking another board keeps the match in place as well
+  client.untrackMatch(3);
+  CHECK(client.getMatch(3) == nullptr);
+  CHECK(client.getMatch(0) == first);
+}
+
+int main() {
+  checkFromJson();
+  checkTurns();
+  checkBusts();
+  checkLegs();
+  checkRequestMatch();
+  checkTrackedMatchesStay();
+  return testResult("match");
+}
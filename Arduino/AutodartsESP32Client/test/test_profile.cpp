@@ -0,0 +1,124 @@
+// Runs an intentionally slow callback inside profiled scopes and checks
+// that its cycles are blamed on the callback phase of its own board, not on
+// the I/O that invoked it.
+
+#include <stdio.h>
+#include <functional>
+
+#include <Arduino.h>
+
+// Cycles follow the fake clock of the host core at 240MHz
+#define AUTODARTS_PROFILING
+#define AUTODARTS_CYCLE_COUNT() (host::clockMicros() * 240u)
+#define AUTODARTS_CPU_MHZ() 240u
+
+#include "AutodartsClient.h"
+#include "AutodartsProfile.h"
+#include "TestUtil.h"
+
+using namespace autodarts;
+
+static void slowCallback() {
+  host::advanceMicros(5000);
+}
+
+// Polls a socket for 100us, then dispatches a message to a callback
+static void poll(Profile& profile, const std::function<void()>& callback) {
+  AUTODARTS_PROFILE(profile, IO);
+  host::advanceMicros(100);
+  {
+    AUTODARTS_PROFILE(profile, CALLBACK);
+    callback();
+  }
+}
+
+static void checkNestedCallback() {
+  Profile profile;
+  profile.beginLoop();
+  poll(profile, slowCallback);
+
+  CHECK_EQ(Profile::toMicros(profile.getLoopCycles(Profile::IO)), 100);
+  CHECK_EQ(Profile::toMicros(profile.getLoopCycles(Profile::CALLBACK)), 5000);
+  CHECK_EQ(Profile::toMicros(profile.getLoopCycles(Profile::PARSE)), 0);
+  CHECK_EQ(Profile::toMicros(profile.getLoopCycles()), 5100);
+
+  // Loop cycles restart, totals and maxima are kept
+  profile.beginLoop();
+  poll(profile, [] { host::advanceMicros(10); });
+  CHECK_EQ(Profile::toMicros(profile.getLoopCycles(Profile::CALLBACK)), 10);
+  CHECK_EQ(Profile::toMicros(profile.getTotalCycles(Profile::CALLBACK)), 5010);
+  CHECK_EQ(Profile::toMicros(profile.getMaxCycles(Profile::CALLBACK)), 5000);
+  CHECK_EQ(Profile::toMicros(profile.getTotalCycles()), 5210);
+}
+
+// A shared connection is polled under its own profile and dispatches to
+// boards, as in cloud mode. The slow board must be blamed, not the poll.
+static void checkNestingAcrossProfiles() {
+  Profile cloud, fast, slow;
+  cloud.beginLoop();
+  fast.beginLoop();
+  slow.beginLoop();
+  {
+    AUTODARTS_PROFILE(cloud, IO);
+    host::advanceMicros(50);
+    {
+      AUTODARTS_PROFILE(fast, PARSE);
+      host::advanceMicros(200);
+    }
+    {
+      AUTODARTS_PROFILE(slow, PARSE);
+      host::advanceMicros(300);
+    }
+    {
+      AUTODARTS_PROFILE(slow, CALLBACK);
+      slowCallback();
+    }
+  }
+
+  CHECK_EQ(Profile::toMicros(cloud.getLoopCycles()), 50);
+  CHECK_EQ(Profile::toMicros(fast.getLoopCycles(Profile::PARSE)), 200);
+  CHECK_EQ(Profile::toMicros(slow.getLoopCycles(Profile::PARSE)), 300);
+  CHECK_EQ(Profile::toMicros(slow.getLoopCycles(Profile::CALLBACK)), 5000);
+
+  // Same search as the loop budget warning of the client
+  Hotspot hotspot;
+  CHECK(findHotspot(cloud, hotspot));
+  CHECK(findHotspot(fast, hotspot));
+  CHECK(findHotspot(slow, hotspot));
+  CHECK(!findHotspot(fast, hotspot));
+  const Profile* worst = hotspot.profile;
+  Profile::Phase worstPhase = hotspot.phase;
+  CHECK_EQ(Profile::toMicros(hotspot.cycles), 5000);
+  CHECK(worst == &slow);
+  CHECK(worstPhase == Profile::CALLBACK);
+}
+
+// The client's loop budget warning names the board and phase found by
+// findHotspot()
+static void checkLoopBudgetWarning() {
+  Client client;
+  client.setLoopBudget(1000);
+  CHECK(client.addBoard(String("Fast"), String("fast-id"), String("1.0"), String("127.0.0.1:3180")));
+  CHECK(client.addBoard(String("Slow"), String("slow-id"), String("1.0"), String("127.0.0.1:3181")));
+  client.getBoard(1).onDetectionState([](const String&, const String&, State, State, int16_t) {
+    slowCallback();
+  });
+
+  char message[] = "{\"type\":\"state\",\"data\":{\"numThrows\":1}}";
+  client.getBoard(0).receive(message, strlen(message));
+  char slowMessage[] = "{\"type\":\"state\",\"data\":{\"numThrows\":1}}";
+  client.getBoard(1).receive(slowMessage, strlen(slowMessage));
+
+  uint32_t warnings = host::log().count[LOG_LEVEL_WARNING];
+  client.updateBoards();
+  CHECK_EQ(client.getNumBudgetOverruns(), 1);
+  CHECK_EQ(host::log().count[LOG_LEVEL_WARNING] - warnings, 1);
+  CHECK(strstr(host::log().last, "Slow spent 5000us in Callback") != nullptr);
+}
+
+int main() {
+  checkNestedCallback();
+  checkNestingAcrossProfiles();
+  checkLoopBudgetWarning();
+  return testResult("profile");
+}
@@ -0,0 +1,199 @@
+// Floods a board queue with telemetry and checks that state messages keep
+// their order and a bounded latency, while telemetry is coalesced.
+
+#include <stdio.h>
+#include <string.h>
+#include <deque>
+#include <string>
+
+#include <Arduino.h>
+
+#include "AutodartsBoard.h"
+#include "TestUtil.h"
+
+using namespace autodarts;
+
+typedef MessageQueueT<4, 3> Queue;
+
+static bool push(Queue& queue, const std::string& message) {
+  return queue.push(message.c_str(), message.size());
+}
+
+static std::string state(int seq) {
+  return "{\"seq\":" + std::to_string(seq) + ",\"type\":\"state\",\"data\":{\"event\":\"Throw detected\"}}";
+}
+
+static std::string stats(int seq) {
+  return "{\"seq\":" + std::to_string(seq) + ",\"type\":\"stats\",\"data\":{\"fps\":30}}";
+}
+
+static std::string camStats(int seq, int id) {
+  return "{\"seq\":" + std::to_string(seq) + ",\"type\": \"cam_stats\",\"data\":{\"id\": " + std::to_string(id) + ",\"fps\":30}}";
+}
+
+static int seqOf(const char* payload) {
+  return atoi(strstr(payload, "\"seq\":") + 6);
+}
+
+static void checkClassesAndCoalescing() {
+  Queue queue;
+  CHECK(push(queue, stats(1)));
+  CHECK(push(queue, stats(2)));
+  CHECK(push(queue, camStats(3, 0)));
+  CHECK(push(queue, camStats(4, 2)));
+  CHECK(push(queue, camStats(5, 2)));
+  CHECK(push(queue, state(6)));
+  CHECK(push(queue, "{\"seq\":7,\"type\":\"cam_state\"}"));
+  // Unknown camera ids are not coalesced
+  CHECK(push(queue, camStats(8, 7)));
+  CHECK_EQ(queue.getStats().coalesced, 2);
+
+  std::string popped;
+  auto record = [&popped](char* payload, size_t length) {
+    CHECK_EQ(strlen(payload), length);
+    popped += std::to_string(seqOf(payload)) + " ";
+  };
+  while (queue.pop(Priority::STATE, record)) {}
+  CHECK(popped == "6 7 8 ");
+  popped.clear();
+  while (queue.pop(Priority::TELEMETRY, record)) {}
+  CHECK(popped == "2 3 5 ");
+}
+
+static void checkStateOverflow() {
+  Queue queue;
+  for (int seq = 0; seq < 4; seq++) {
+    CHECK(push(queue, state(seq)));
+  }
+  CHECK(queue.isStateFull());
+  CHECK(!push(queue, state(4)));
+  CHECK_EQ(queue.getStats().overflows, 1);
+}
+
+// A board receiving into a full state ring dispatches the oldest message
+// and queues the new one, nothing is lost or reordered
+static void checkBoardOverflow() {
+  Board board("Board", "board-id", "1.0", "127.0.0.1:3180");
+  std::vector<int16_t> dispatched;
+  board.onDetectionState([&dispatched](const String&, const String&, State, State, int16_t numThrows) {
+    dispatched.push_back(numThrows);
+  });
+
+  for (int seq = 0; seq <= AUTODARTS_STATE_QUEUE_SIZE; seq++) {
+    std::string message = "{\"type\":\"state\",\"data\":{\"numThrows\":" + std::to_string(seq) + "}}";
+    board.receive(&message[0], message.size());
+  }
+  CHECK_EQ(board.getNumOverflows(), 1);
+  CHECK_EQ(dispatched.size(), 1);
+
+  board.dispatch();
+  CHECK_EQ(dispatched.size(), AUTODARTS_STATE_QUEUE_SIZE + 1);
+  for (size_t idx = 0; idx < dispatched.size(); idx++) {
+    CHECK_EQ(dispatched[idx], idx);
+  }
+}
+
+// Type and camera id are only taken from the top level and from data, the
+// same keys nested deeper or inside strings do not classify a message
+static void checkAnchoredKeys() {
+  Queue queue;
+  std::string popped;
+  auto record = [&popped](char* payload, size_t) {
+    popped += std::to_string(seqOf(payload)) + " ";
+  };
+
+  // Members in any order, and with spaces
+  CHECK(push(queue, "{\"seq\":1,\"data\":{\"id\":1,\"fps\":30}, \"type\" : \"cam_stats\"}"));
+  CHECK(push(queue, "{\"seq\":2,\"data\":{\"fps\":30,\"id\" : 1},\"type\":\"cam_stats\"}"));
+  CHECK_EQ(queue.getStats().coalesced, 1);
+
+  // State messages carrying telemetry lookalikes stay state messages
+  CHECK(push(queue, "{\"seq\":3,\"data\":{\"type\":\"stats\"},\"type\":\"state\"}"));
+  CHECK(push(queue, "{\"seq\":4,\"note\":\"\\\"type\\\":\\\"stats\\\"\",\"type\":\"state\"}"));
+  CHECK(push(queue, "{\"seq\":5,\"data\":{\"event\":\"Throw detected\"}}"));
+
+  // Camera ids nested deeper, inside strings, beyond NumCameras or with a
+  // valid leading digit are not coalesced
+  CHECK(push(queue, "{\"seq\":6,\"type\":\"cam_stats\",\"data\":{\"camera\":{\"id\":0}}}"));
+  while (queue.pop(Priority::STATE, record)) {}
+  CHECK(popped == "3 4 5 6 ");
+  popped.clear();
+  CHECK(push(queue, "{\"seq\":7,\"type\":\"cam_stats\",\"data\":{\"name\":\"\\\"id\\\":0\",\"id\":12}}"));
+  CHECK(push(queue, "{\"seq\":8,\"type\":\"cam_stats\",\"data\":{\"id\":12}}"));
+  CHECK_EQ(queue.getStats().coalesced, 1);
+  while (queue.pop(Priority::STATE, record)) {}
+  CHECK(popped == "7 8 ");
+  popped.clear();
+  while (queue.pop(Priority::TELEMETRY, record)) {}
+  CHECK(popped == "2 ");
+}
+
+// Simulated loop: every parse costs 1ms. Each iteration receives a burst of
+// telemetry from all cameras and a state message every fourth iteration,
+// then dispatches state before telemetry like Client::updateBoards().
+// Returns the worst latency from receiving to dispatching a state message.
+static uint32_t floodLatency(uint16_t burst, bool prioritized, uint32_t& dispatched) {
+  Queue queue;
+  std::deque<std::string> fifo;
+  uint32_t now = 0, worst = 0;
+  uint32_t received[1000] = {};
+  int seq = 0;
+  dispatched = 0;
+
+  auto parse = [&](char* payload, size_t) {
+    now++;
+    dispatched++;
+    if (strstr(payload, "\"state\"")) {
+      uint32_t latency = now - received[seqOf(payload) % 1000];
+      worst = latency > worst ? latency : worst;
+    }
+  };
+
+  for (int loop = 0; loop < 400; loop++) {
+    for (uint16_t idx = 0; idx < burst; idx++) {
+      std::string message = idx % 4 == 0 ? stats(seq++) : camStats(seq++, idx % 3);
+      prioritized ? (void)push(queue, message) : fifo.push_back(message);
+    }
+    if (loop % 4 == 0) {
+      received[seq % 1000] = now;
+      std::string message = state(seq++);
+      prioritized ? (void)push(queue, message) : fifo.push_back(message);
+    }
+
+    if (prioritized) {
+      while (queue.pop(Priority::STATE, parse)) {}
+      while (queue.pop(Priority::TELEMETRY, parse)) {}
+    }
+    else {
+      while (!fifo.empty()) {
+        std::string message = fifo.front();
+        fifo.pop_front();
+        parse(&message[0], message.size());
+      }
+    }
+  }
+  return worst;
+}
+
+static void checkFloodLatency() {
+  for (uint16_t burst : {4, 16, 64, 256}) {
+    uint32_t prioritizedCount, fifoCount;
+    uint32_t prioritized = floodLatency(burst, true, prioritizedCount);
+    uint32_t fifo = floodLatency(burst, false, fifoCount);
+    printf("burst %3u: state latency %u ms prioritized (%u parses), %u ms in order (%u parses)\n",
+           burst, prioritized, prioritizedCount, fifo, fifoCount);
+    // State is parsed first in the loop after it arrived, whatever the flood
+    CHECK_EQ(prioritized, 1);
+    // Telemetry work per loop is bounded by the slots
+    CHECK(prioritizedCount <= 400 * (2 + 3) + 100);
+  }
+}
+
+int main() {
+  checkClassesAndCoalescing();
+  checkStateOverflow();
+  checkBoardOverflow();
+  checkAnchoredKeys();
+  checkFloodLatency();
+  return testResult("queue");
+}
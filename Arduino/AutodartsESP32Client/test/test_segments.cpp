@@ -0,0 +1,143 @@
+// Checks segments::classify() against an atan2 reference and the heatmap
+// accumulator.
+
+#include <math.h>
+#include <random>
+
+#include "AutodartsSegments.h"
+#include "SegmentsReference.h"
+#include "TestUtil.h"
+
+using namespace autodarts;
+
+// Distance to the closest sector or ring boundary, in board millimetres
+static double boundaryDistance(float x, float y) {
+  static const double rings[] = {6.35, 15.9, 99.0, 107.0, 162.0, 170.0};
+  double radius = sqrt(static_cast<double>(x) * x + static_cast<double>(y) * y) * 170.0;
+  double distance = 1e9;
+  for (double ring : rings) {
+    distance = fmin(distance, fabs(radius - ring));
+  }
+  double degrees = atan2(y, x) * 180.0 / M_PI + 9.0;
+  double offset = fmod(fmod(degrees, 18.0) + 18.0, 18.0);
+  double arc = fmin(offset, 18.0 - offset) * M_PI / 180.0 * radius;
+  return fmin(distance, arc);
+}
+
+static void checkKnownPoints() {
+  int8_t number, multiplier;
+  segments::classify(0.0f, 0.0f, number, multiplier);
+  CHECK_EQ(number, 25);
+  CHECK_EQ(multiplier, 2);
+  segments::classify(0.0f, 0.07f, number, multiplier);
+  CHECK_EQ(number, 25);
+  CHECK_EQ(multiplier, 1);
+  segments::classify(0.0f, 0.3f, number, multiplier);
+  CHECK_EQ(number, 20);
+  CHECK_EQ(multiplier, 1);
+  segments::classify(0.0f, 0.6f, number, multiplier);
+  CHECK_EQ(number, 20);
+  CHECK_EQ(multiplier, 3);
+  segments::classify(0.0f, -0.98f, number, multiplier);
+  CHECK_EQ(number, 3);
+  CHECK_EQ(multiplier, 2);
+  segments::classify(0.98f, 0.0f, number, multiplier);
+  CHECK_EQ(number, 6);
+  CHECK_EQ(multiplier, 2);
+  segments::classify(-0.5f, 0.0f, number, multiplier);
+  CHECK_EQ(number, 11);
+  CHECK_EQ(multiplier, 1);
+  segments::classify(0.8f, 0.8f, number, multiplier);
+  CHECK_EQ(number, 0);
+  CHECK_EQ(multiplier, 0);
+}
+
+// Float rounding may only disagree within a hair of a wire
+static void checkAgainstReference() {
+  std::mt19937 random(1234);
+  std::uniform_real_distribution<float> coordinate(-1.1f, 1.1f);
+  uint32_t mismatches = 0;
+  for (uint32_t idx = 0; idx < 1000000; idx++) {
+    float x = coordinate(random);
+    float y = coordinate(random);
+    int8_t number, multiplier, refNumber, refMultiplier;
+    segments::classify(x, y, number, multiplier);
+    classifyReference(x, y, refNumber, refMultiplier);
+    if (number != refNumber || multiplier != refMultiplier) {
+      mismatches++;
+      CHECK(boundaryDistance(x, y) < 1e-3);
+    }
+  }
+  CHECK(mismatches < 10);
+
+  // Every sector and ring on a polar grid away from the wires
+  for (int sector = 0; sector < 20; sector++) {
+    for (double radius : {3.0, 10.0, 50.0, 103.0, 130.0, 166.0, 180.0}) {
+      double angle = (sector * 18.0 + 4.0) * M_PI / 180.0;
+      float x = cos(angle) * radius / 170.0;
+      float y = sin(angle) * radius / 170.0;
+      int8_t number, multiplier, refNumber, refMultiplier;
+      segments::classify(x, y, number, multiplier);
+      classifyReference(x, y, refNumber, refMultiplier);
+      CHECK_EQ(number, refNumber);
+      CHECK_EQ(multiplier, refMultiplier);
+    }
+  }
+}
+
+static void checkHeatmap() {
+  HeatmapT<16> heatmap;
+  heatmap.add(0.0f, 0.6f, 20, 3);
+  heatmap.add(0.0f, 0.6f, 20, 3);
+  heatmap.add(0.0f, 0.0f, 25, 2);
+  heatmap.add(1.5f, 0.0f, 0, 0);
+  CHECK_EQ(heatmap.getTotal(), 4);
+  CHECK_EQ(heatmap.getSegment(20, 3), 2);
+  CHECK_EQ(heatmap.getSegment(25, 2), 1);
+  CHECK_EQ(heatmap.getSegment(0, 0), 1);
+  CHECK_EQ(heatmap.getSegment(20, 1), 0);
+  // y = 0.6 lies in row (1 - 0.6) * 8 = 3, x = 0 in column 8
+  CHECK_EQ(heatmap.getCell(3, 8), 2);
+  CHECK_EQ(heatmap.getCell(8, 8), 1);
+
+  // The board edges fall into the outermost cells, also where the cell
+  // index rounds up to the size just inside the edge
+  HeatmapT<16> edges;
+  edges.add(0.0f, -1.0f, 3, 2);
+  edges.add(0.0f, 1.0f, 20, 2);
+  edges.add(0.99999994f, 0.0f, 6, 2);
+  edges.add(-1.0f, 0.0f, 11, 2);
+  edges.add(1.0f, -0.99999994f, 0, 0);
+  CHECK_EQ(edges.getCell(15, 8), 1);
+  CHECK_EQ(edges.getCell(0, 8), 1);
+  CHECK_EQ(edges.getCell(8, 15), 1);
+  CHECK_EQ(edges.getCell(8, 0), 1);
+  CHECK_EQ(edges.getCell(15, 15), 1);
+  uint32_t cells = 0;
+  for (uint8_t row = 0; row < 16; row++) {
+    for (uint8_t column = 0; column < 16; column++) {
+      cells += edges.getCell(row, column);
+    }
+  }
+  CHECK_EQ(cells, 5);
+
+  // Counters saturate
+  HeatmapT<2> small;
+  for (uint32_t idx = 0; idx < 70000; idx++) {
+    small.add(0.5f, 0.5f, 1, 1);
+  }
+  CHECK_EQ(small.getCell(0, 1), UINT16_MAX);
+  CHECK_EQ(small.getSegment(1, 1), UINT16_MAX);
+  CHECK_EQ(small.getTotal(), 70000);
+
+  heatmap.reset();
+  CHECK_EQ(heatmap.getTotal(), 0);
+  CHECK_EQ(heatmap.getCell(3, 8), 0);
+}
+
+int main() {
+  checkKnownPoints();
+  checkAgainstReference();
+  checkHeatmap();
+  return testResult("segments");
+}
@@ -0,0 +1,111 @@
+// Checks when the client renders its aggregate snapshot: only after a board
+// changed, not on every request. Adds boards until the snapshot document
+// has to grow and checks that it stops at AUTODARTS_SNAPSHOT_MAX_SIZE,
+// which this test lowers, keeping the last snapshot.
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+
+#include <Arduino.h>
+
+#define AUTODARTS_SNAPSHOT_MAX_SIZE 8192
+
+#include "AutodartsClient.h"
+#include "TestUtil.h"
+
+using namespace autodarts;
+
+static void receive(Client& client, uint8_t idx, std::string message) {
+  client.getBoard(idx).receive(&message[0], message.size());
+  client.updateBoards();
+}
+
+static void addBoard(Client& client, int idx) {
+  std::string id = "board-" + std::to_string(idx);
+  CHECK(client.addBoard(String("Board ") + String(idx), String(id), String("1.0"), String("127.0.0.1:" + std::to_string(3180 + idx))));
+  for (int camera = 0; camera < AUTODARTS_NUM_CAMERAS; camera++) {
+    receive(client, client.getNumBoards() - 1,
+            "{\"type\":\"cam_stats\",\"data\":{\"id\":" + std::to_string(camera) + ",\"fps\":30,\"resolution\":{\"width\":1280,\"height\":720}}}");
+  }
+}
+
+static void checkDirtyAndRender() {
+  Client client;
+  addBoard(client, 0);
+  size_t length = 0;
+  uint32_t version = 0;
+  const char* snapshot = client.getSnapshot(&length, &version);
+  CHECK_EQ(version, 1);
+  CHECK_EQ(strlen(snapshot), length);
+
+  // Unchanged boards serve the cached snapshot
+  CHECK(client.getSnapshot(nullptr, &version) == snapshot);
+  CHECK_EQ(version, 1);
+  client.updateBoards();
+  client.getSnapshot(nullptr, &version);
+  CHECK_EQ(version, 1);
+
+  // A state message renders the next version
+  receive(client, 0, "{\"type\":\"state\",\"data\":{\"connected\":true,\"running\":true,\"status\":\"Throw\",\"event\":\"Throw detected\",\"numThrows\":2}}");
+  snapshot = client.getSnapshot(&length, &version);
+  CHECK_EQ(version, 2);
+  DynamicJsonDocument doc(4096);
+  CHECK(!deserializeJson(doc, snapshot, length));
+  CHECK_EQ(doc["version"].as<int>(), 2);
+  CHECK_EQ(doc["boards"].size(), 1);
+  CHECK_EQ(doc["boards"][0]["detector"]["numThrows"].as<int>(), 2);
+  CHECK_EQ(doc["boards"][0]["cameras"]["stats"].size(), AUTODARTS_NUM_CAMERAS);
+
+  // Adding and deleting boards renders as well
+  addBoard(client, 1);
+  client.getSnapshot(nullptr, &version);
+  CHECK_EQ(version, 3);
+  client.deleteBoard(1);
+  client.getSnapshot(nullptr, &version);
+  CHECK_EQ(version, 4);
+  CHECK_EQ(client.getSnapshotVersion(), 4);
+}
+
+static void checkBoundedGrowth() {
+  Client client;
+  uint32_t warnings = host::log().count[LOG_LEVEL_WARNING];
+  uint32_t errors = host::log().count[LOG_LEVEL_ERROR];
+  size_t length = 0;
+  uint32_t version = 0;
+
+  // The initial 4KB document holds a few boards, the next ones grow it once
+  int numBoards = 0;
+  std::string last;
+  while (host::log().count[LOG_LEVEL_ERROR] == errors && numBoards < 64) {
+    addBoard(client, numBoards++);
+    const char* snapshot = client.getSnapshot(&length, &version);
+    if (host::log().count[LOG_LEVEL_ERROR] == errors) {
+      last.assign(snapshot, length);
+      CHECK_EQ(version, numBoards);
+    }
+  }
+  CHECK(numBoards < 64);
+  CHECK_EQ(host::log().count[LOG_LEVEL_WARNING] - warnings, 1);
+  CHECK(strstr(host::log().last, "8192") != nullptr);
+
+  // Past the maximum the last snapshot is kept and not rendered again
+  const char* snapshot = client.getSnapshot(&length, &version);
+  CHECK_EQ(version, numBoards - 1);
+  CHECK(std::string(snapshot, length) == last);
+  errors = host::log().count[LOG_LEVEL_ERROR];
+  client.getSnapshot();
+  CHECK_EQ(host::log().count[LOG_LEVEL_ERROR], errors);
+
+  // Once boards are gone the document fits again
+  client.deleteBoard(numBoards - 1);
+  client.getSnapshot(&length, &version);
+  CHECK_EQ(version, numBoards);
+  CHECK_EQ(host::log().count[LOG_LEVEL_ERROR], errors);
+}
+
+int main() {
+  checkDirtyAndRender();
+  checkBoundedGrowth();
+  return testResult("snapshot");
+}
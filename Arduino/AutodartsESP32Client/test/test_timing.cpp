@@ -0,0 +1,183 @@
+// Checks the bin edges and interpolated percentiles of the timing
+// histogram, then drives a detector through a visit, a takeout and a manual
+// reset on the fake clock and checks which durations it records.
+
+#include <stdio.h>
+#include <string>
+
+#include <Arduino.h>
+
+#include "AutodartsDetector.h"
+#include "TestUtil.h"
+
+using namespace autodarts;
+
+// Bins [0, 16), [16, 32), [32, 64) and [64, inf)
+typedef HistogramT<4, 16> Histogram;
+
+static void checkBinEdges() {
+  Histogram histogram;
+  CHECK_EQ(Histogram::getBinUpperBound(0), 16);
+  CHECK_EQ(Histogram::getBinUpperBound(2), 64);
+  CHECK_EQ(Histogram::getBinUpperBound(3), UINT32_MAX);
+
+  // Below the first bound, including zero, everything lands in bin 0
+  histogram.add(0);
+  histogram.add(15);
+  CHECK_EQ(histogram.getBin(0), 2);
+
+  // Bounds are exclusive
+  histogram.add(16);
+  histogram.add(31);
+  histogram.add(32);
+  histogram.add(63);
+  CHECK_EQ(histogram.getBin(1), 2);
+  CHECK_EQ(histogram.getBin(2), 2);
+
+  // The last bin is open ended
+  histogram.add(64);
+  histogram.add(UINT32_MAX);
+  CHECK_EQ(histogram.getBin(3), 2);
+  CHECK_EQ(histogram.getBin(4), 0);
+
+  CHECK_EQ(histogram.getCount(), 8);
+  CHECK_EQ(histogram.getMin(), 0);
+  CHECK_EQ(histogram.getMax(), UINT32_MAX);
+}
+
+static void checkPercentiles() {
+  Histogram histogram;
+  CHECK_EQ(histogram.getPercentile(50), 0);
+
+  // A single value is every percentile
+  histogram.add(40);
+  CHECK_EQ(histogram.getPercentile(0), 40);
+  CHECK_EQ(histogram.getPercentile(50), 40);
+  CHECK_EQ(histogram.getPercentile(100), 40);
+
+  // Four values spread over [32, 64) interpolate inside the bin, which is
+  // narrowed to the observed range [33, 60]
+  histogram.reset();
+  histogram.add(33);
+  histogram.add(40);
+  histogram.add(50);
+  histogram.add(60);
+  CHECK_EQ(histogram.getPercentile(0), 33);
+  CHECK_EQ(histogram.getPercentile(25), 33 + 27 * 1 / 4);
+  CHECK_EQ(histogram.getPercentile(50), 33 + 27 * 2 / 4);
+  CHECK_EQ(histogram.getPercentile(75), 33 + 27 * 3 / 4);
+  CHECK_EQ(histogram.getPercentile(100), 60);
+
+  // Bin 0 spans [10, 16) from the minimum, the open ended last bin ends
+  // at the maximum
+  histogram.reset();
+  for (int idx = 0; idx < 9; idx++) {
+    histogram.add(10);
+  }
+  histogram.add(1000);
+  CHECK_EQ(histogram.getPercentile(10), 10 + 6 * 1 / 9);
+  CHECK_EQ(histogram.getPercentile(50), 10 + 6 * 5 / 9);
+  CHECK_EQ(histogram.getPercentile(90), 16);
+  CHECK_EQ(histogram.getPercentile(95), 1000);
+  CHECK_EQ(histogram.getPercentile(100), 1000);
+
+  // Percentiles never decrease
+  histogram.reset();
+  for (uint32_t value = 1; value < 500; value += 7) {
+    histogram.add(value);
+  }
+  uint32_t previous = 0;
+  for (uint8_t percent = 0; percent <= 100; percent++) {
+    uint32_t value = histogram.getPercentile(percent);
+    CHECK(value >= previous);
+    CHECK(value >= histogram.getMin() && value <= histogram.getMax());
+    previous = value;
+  }
+}
+
+static void checkReset() {
+  Histogram histogram;
+  histogram.add(5);
+  histogram.add(100);
+  histogram.reset();
+  CHECK_EQ(histogram.getCount(), 0);
+  CHECK_EQ(histogram.getMin(), 0);
+  CHECK_EQ(histogram.getMax(), 0);
+  CHECK_EQ(histogram.getMean(), 0);
+  CHECK_EQ(histogram.getPercentile(90), 0);
+  for (uint8_t idx = 0; idx < Histogram::getNumBins(); idx++) {
+    CHECK_EQ(histogram.getBin(idx), 0);
+  }
+
+  // The minimum starts over as well
+  histogram.add(70);
+  CHECK_EQ(histogram.getMin(), 70);
+  CHECK_EQ(histogram.getMean(), 70);
+}
+
+// Sends a state message at the given time in milliseconds
+static void state(Detector& detector, uint32_t ms, const char* status, const char* event, int numThrows) {
+  host::clockMicros() = ms * 1000;
+  char message[256];
+  snprintf(message, sizeof(message),
+           "{\"type\":\"state\",\"data\":{\"connected\":true,\"running\":true,\"status\":\"%s\",\"event\":\"%s\",\"numThrows\":%d}}",
+           status, event, numThrows);
+  DynamicJsonDocument json(1024);
+  CHECK(!deserializeJson(json, message));
+  detector.fromJson(json.as<JsonObjectConst>());
+}
+
+static void checkDetectorTimings() {
+  String name("Board"), id("board-id");
+  Detector detector(name, id);
+  const Detector::Timings& timings = detector.getTimings();
+
+  // Throws present on the first state do not start an interval
+  state(detector, 1000, "Throw", "Started", 0);
+  state(detector, 2000, "Throw", "Throw detected", 1);
+  CHECK_EQ(timings.throwInterval.getCount(), 0);
+  state(detector, 3500, "Throw", "Throw detected", 2);
+  state(detector, 5000, "Throw", "Throw detected", 3);
+  CHECK_EQ(timings.throwInterval.getCount(), 2);
+  CHECK_EQ(timings.throwInterval.getMin(), 1500);
+  CHECK_EQ(timings.throwInterval.getMax(), 1500);
+
+  // The takeout is timed from its first start, repeated starts are ignored
+  state(detector, 6000, "Takeout", "Takeout started", 3);
+  state(detector, 7000, "Takeout", "Takeout started", 3);
+  state(detector, 9000, "Throw", "Takeout finished", 0);
+  CHECK_EQ(timings.takeoutDuration.getCount(), 1);
+  CHECK_EQ(timings.takeoutDuration.getMax(), 3000);
+
+  // The first throw of the next visit does not count the takeout
+  state(detector, 10000, "Throw", "Throw detected", 1);
+  CHECK_EQ(timings.throwInterval.getCount(), 2);
+
+  // A manual reset is timed until the board left STARTING and the throw
+  // after it starts a new interval
+  state(detector, 11000, "Starting", "Manual reset", 0);
+  state(detector, 12000, "Starting", "Manual reset", 0);
+  CHECK_EQ(timings.resetRecovery.getCount(), 0);
+  state(detector, 13500, "Throw", "Started", 0);
+  CHECK_EQ(timings.resetRecovery.getCount(), 1);
+  CHECK_EQ(timings.resetRecovery.getMax(), 2500);
+
+  state(detector, 14000, "Throw", "Throw detected", 1);
+  CHECK_EQ(timings.throwInterval.getCount(), 2);
+  state(detector, 14800, "Throw", "Throw detected", 2);
+  CHECK_EQ(timings.throwInterval.getCount(), 3);
+  CHECK_EQ(timings.throwInterval.getMin(), 800);
+
+  detector.resetTimings();
+  CHECK_EQ(timings.throwInterval.getCount(), 0);
+  CHECK_EQ(timings.takeoutDuration.getCount(), 0);
+  CHECK_EQ(timings.resetRecovery.getCount(), 0);
+}
+
+int main() {
+  checkBinEdges();
+  checkPercentiles();
+  checkReset();
+  checkDetectorTimings();
+  return testResult("timing");
+}
@@ -0,0 +1,122 @@
+// Connects the ArduinoWebsockets transport to endpoints with a slow
+// handshake. The attempt runs off the loop, so open() and poll() return
+// right away and the events arrive from poll() on the calling thread. An
+// attempt abandoned by close() or by destroying the transport reports
+// nothing.
+
+#define AUTODARTS_ARDUINO_WEBSOCKETS
+
+#include <stdio.h>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <Arduino.h>
+
+#include "AutodartsTransport.h"
+#include "TestUtil.h"
+
+using namespace autodarts;
+
+static const uint32_t HANDSHAKE_MS = 200;
+
+typedef std::chrono::steady_clock Clock;
+
+struct Recorder {
+  std::vector<Transport::Type> types;
+  std::vector<std::string>     frames;
+  bool                         otherThread = false;
+
+  void attach(Transport& transport) {
+    std::thread::id loop = std::this_thread::get_id();
+    transport.onEvent([this, loop](Transport::Type type, char* payload, size_t length) {
+      otherThread |= std::this_thread::get_id() != loop;
+      types.push_back(type);
+      if (type == Transport::Type::TEXT) {
+        frames.emplace_back(payload, length);
+      }
+    });
+  }
+};
+
+static uint32_t elapsedMillis(Clock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start).count();
+}
+
+// Polls until the transport reported count events, returns the longest poll
+static uint32_t pollUntil(Transport& transport, Recorder& recorder, size_t count) {
+  uint32_t longest = 0;
+  Clock::time_point start = Clock::now();
+  while (recorder.types.size() < count && elapsedMillis(start) < 5 * HANDSHAKE_MS) {
+    Clock::time_point poll = Clock::now();
+    transport.poll();
+    longest = std::max(longest, elapsedMillis(poll));
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    host::advanceMicros(1000);
+  }
+  return longest;
+}
+
+static void checkConnectOffLoop() {
+  std::string key = host::ws::key("127.0.0.1", 3180, "/api/events");
+  host::ws::with(key, [](host::ws::Endpoint& endpoint) { endpoint.handshakeMillis = HANDSHAKE_MS; });
+  ArduinoWebsocketsTransport transport;
+  transport.setReconnectInterval(100);
+  Recorder recorder;
+  recorder.attach(transport);
+
+  Clock::time_point start = Clock::now();
+  CHECK(transport.open("127.0.0.1", 3180, "/api/events"));
+  CHECK(!transport.poll());
+  CHECK(elapsedMillis(start) < HANDSHAKE_MS / 2);
+  CHECK(recorder.types.empty());
+
+  CHECK(pollUntil(transport, recorder, 1) < HANDSHAKE_MS / 2);
+  CHECK(recorder.types.size() == 1 && recorder.types[0] == Transport::Type::CONNECTED);
+  CHECK(elapsedMillis(start) >= HANDSHAKE_MS);
+
+  host::ws::push(key, "{\"type\":\"state\"}");
+  CHECK(transport.poll());
+  CHECK(recorder.frames.size() == 1 && recorder.frames[0] == "{\"type\":\"state\"}");
+
+  // A dropped connection is reported and reconnected off the loop as well
+  host::ws::drop(key);
+  CHECK(pollUntil(transport, recorder, 4) < HANDSHAKE_MS / 2);
+  CHECK(recorder.types.size() == 4 && recorder.types[2] == Transport::Type::DISCONNECTED);
+  CHECK(recorder.types[3] == Transport::Type::CONNECTED);
+  CHECK_EQ(host::ws::with(key, [](host::ws::Endpoint& endpoint) { return endpoint.numConnects; }), 2);
+
+  transport.close();
+  CHECK(recorder.types.size() == 5 && recorder.types[4] == Transport::Type::DISCONNECTED);
+  CHECK(!recorder.otherThread);
+}
+
+static void checkAbandonedAttempt() {
+  std::string key = host::ws::key("127.0.0.1", 3181, "/api/events");
+  host::ws::with(key, [](host::ws::Endpoint& endpoint) { endpoint.handshakeMillis = HANDSHAKE_MS; });
+
+  // Closed while connecting, the late handshake is not reported
+  ArduinoWebsocketsTransport transport;
+  Recorder recorder;
+  recorder.attach(transport);
+  CHECK(transport.open("127.0.0.1", 3181, "/api/events"));
+  transport.close();
+  std::this_thread::sleep_for(std::chrono::milliseconds(HANDSHAKE_MS * 3 / 2));
+  CHECK(!transport.poll());
+  CHECK(recorder.types.empty());
+
+  // Destroyed while connecting, the attempt finishes on its own
+  {
+    ArduinoWebsocketsTransport gone;
+    CHECK(gone.open("127.0.0.1", 3181, "/api/events"));
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(HANDSHAKE_MS * 3 / 2));
+  CHECK_EQ(host::ws::with(key, [](host::ws::Endpoint& endpoint) { return endpoint.numConnects; }), 2);
+}
+
+int main() {
+  checkConnectOffLoop();
+  checkAbandonedAttempt();
+  return testResult("transport");
+}
@@ -0,0 +1,179 @@
+// Synthetic load generator for AutodartsESP32Client.
+//
+// Runs NUM_BOARDS websocket servers on consecutive ports starting at
+// BASE_PORT, each speaking the /api/events protocol of a local board. Build
+// the client with AUTODARTS_LOAD_TEST defined and add the boards with
+// Client::addBoard(name, id, version, IPAddress, BASE_PORT + i). Every
+// message carries a sequence number and the sender time, so the client can
+// count dropped and late events.
+//
+// The sketch measures the client on the device, over WiFi and the
+// websocket library. Without a device, bench_load of the client's host
+// tests sends the same messages over loopback transports and reports the
+// same figures for updateBoards() alone.
+
+#include <inttypes.h>
+#include <WiFi.h>
+#include <WebSocketsServer.h>
+
+#define WIFI_SSID     "your-ssid"
+#define WIFI_PASSWORD "your-password"
+
+// Every server needs a listening socket plus one per client, keep within
+// CONFIG_LWIP_MAX_SOCKETS
+#define NUM_BOARDS   4
+#define NUM_CAMERAS  3
+#define BASE_PORT    3180
+
+// Message intervals in milliseconds, 0 disables the message type
+#define STATE_INTERVAL        100
+#define STATS_INTERVAL        50
+#define CAM_STATE_INTERVAL    1000
+#define CAM_STATS_INTERVAL    50
+#define MOTION_STATE_INTERVAL 0
+
+// Disconnect all clients of a board every n milliseconds, 0 disables
+#define DISCONNECT_INTERVAL   30000
+#define REPORT_INTERVAL       5000
+
+struct Schedule {
+  uint32_t interval;
+  uint32_t next;
+};
+
+struct MockBoard {
+  WebSocketsServer* server;
+  uint32_t seq;
+  uint32_t numSent;
+  uint32_t numLate;
+  uint32_t nextDisconnect;
+  int16_t  numThrows;
+  uint8_t  step;
+  Schedule state, stats, camState, camStats, motionState;
+};
+
+MockBoard boards[NUM_BOARDS];
+uint32_t nextReport = 0;
+char message[384];
+
+void send(MockBoard& board, int length) {
+  if (length > 0 && length < (int)sizeof(message)) {
+    board.server->broadcastTXT(message, length);
+    board.numSent++;
+    board.seq++;
+  }
+}
+
+// Returns true if a message is due, late sends are counted when the loop
+// missed a whole interval
+bool due(MockBoard& board, Schedule& schedule, uint32_t now) {
+  if (schedule.interval == 0 || (int32_t)(now - schedule.next) < 0) {
+    return false;
+  }
+  if (now - schedule.next >= schedule.interval) {
+    board.numLate++;
+    schedule.next = now;
+  }
+  schedule.next += schedule.interval;
+  return true;
+}
+
+void sendState(MockBoard& board, uint32_t now) {
+  static const char* events[] = {"Throw detected", "Throw detected", "Throw detected", "Takeout started", "Takeout finished"};
+  uint8_t step = board.step;
+  board.step = (board.step + 1) % 5;
+  board.numThrows = step < 3 ? step + 1 : (step == 3 ? 3 : 0);
+  send(board, snprintf(message, sizeof(message),
+    "{\"seq\":%" PRIu32 ",\"ts\":%" PRIu32 ",\"type\":\"state\",\"data\":{\"connected\":true,\"running\":true,\"status\":\"%s\",\"event\":\"%s\",\"numThrows\":%d}}",
+    board.seq, now, step < 3 ? "Throw" : "Takeout", events[step], board.numThrows));
+}
+
+void sendStats(MockBoard& board, uint32_t now) {
+  send(board, snprintf(message, sizeof(message),
+    "{\"seq\":%" PRIu32 ",\"ts\":%" PRIu32 ",\"type\":\"stats\",\"data\":{\"fps\":%" PRIu32 ",\"resolution\":{\"width\":1280,\"height\":720}}}",
+    board.seq, now, 28 + (now % 5)));
+}
+
+void sendCamState(MockBoard& board, uint32_t now) {
+  send(board, snprintf(message, sizeof(message),
+    "{\"seq\":%" PRIu32 ",\"ts\":%" PRIu32 ",\"type\":\"cam_state\",\"data\":{\"isOpened\":true,\"isRunning\":true}}",
+    board.seq, now));
+}
+
+void sendCamStats(MockBoard& board, uint32_t now) {
+  for (uint8_t id = 0; id < NUM_CAMERAS; id++) {
+    send(board, snprintf(message, sizeof(message),
+      "{\"seq\":%" PRIu32 ",\"ts\":%" PRIu32 ",\"type\":\"cam_stats\",\"data\":{\"id\":%u,\"fps\":%" PRIu32 ",\"resolution\":{\"width\":1280,\"height\":720}}}",
+      board.seq, now, id, 28 + (now % 5)));
+  }
+}
+
+void sendMotionState(MockBoard& board, uint32_t now) {
+  send(board, snprintf(message, sizeof(message),
+    "{\"seq\":%" PRIu32 ",\"ts\":%" PRIu32 ",\"type\":\"motion_state\",\"data\":{\"motion\":%s}}",
+    board.seq, now, (now / 1000) % 2 ? "true" : "false"));
+}
+
+void setup() {
+  Serial.begin(115200);
+
+  WiFi.mode(WIFI_STA);
+  WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
+  while (WiFi.status() != WL_CONNECTED) {
+    delay(100);
+  }
+  Serial.printf("Load generator at %s\n", WiFi.localIP().toString().c_str());
+
+  uint32_t now = millis();
+  for (uint8_t idx = 0; idx < NUM_BOARDS; idx++) {
+    MockBoard& board = boards[idx];
+    board.server = new WebSocketsServer(BASE_PORT + idx);
+    board.server->begin();
+    board.seq = 0;
+    board.numSent = 0;
+    board.numLate = 0;
+    board.numThrows = 0;
+    board.step = 0;
+    board.nextDisconnect = now + DISCONNECT_INTERVAL;
+    board.state       = {STATE_INTERVAL, now};
+    board.stats       = {STATS_INTERVAL, now};
+    board.camState    = {CAM_STATE_INTERVAL, now};
+    board.camStats    = {CAM_STATS_INTERVAL, now};
+    board.motionState = {MOTION_STATE_INTERVAL, now};
+    Serial.printf("Board %u listening on port %u\n", idx, BASE_PORT + idx);
+  }
+  nextReport = now + REPORT_INTERVAL;
+}
+
+void loop() {
+  uint32_t now = millis();
+
+  for (MockBoard& board : boards) {
+    board.server->loop();
+    if (board.server->connectedClients() == 0) {
+      continue;
+    }
+
+    if (due(board, board.state, now))       sendState(board, now);
+    if (due(board, board.stats, now))       sendStats(board, now);
+    if (due(board, board.camState, now))    sendCamState(board, now);
+    if (due(board, board.camStats, now))    sendCamStats(board, now);
+    if (due(board, board.motionState, now)) sendMotionState(board, now);
+
+    if (DISCONNECT_INTERVAL > 0 && (int32_t)(now - board.nextDisconnect) >= 0) {
+      board.server->disconnect();
+      board.seq = 0;
+      board.nextDisconnect = now + DISCONNECT_INTERVAL;
+    }
+  }
+
+  if ((int32_t)(now - nextReport) >= 0) {
+    for (uint8_t idx = 0; idx < NUM_BOARDS; idx++) {
+      Serial.printf("Board %u: sent %" PRIu32 " (%" PRIu32 "/s) late %" PRIu32 " clients %u\n", idx, boards[idx].numSent,
+                    boards[idx].numSent * 1000 / REPORT_INTERVAL, boards[idx].numLate, boards[idx].server->connectedClients());
+      boards[idx].numSent = 0;
+      boards[idx].numLate = 0;
+    }
+    nextReport = now + REPORT_INTERVAL;
+  }
+}